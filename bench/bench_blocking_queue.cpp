@@ -0,0 +1,119 @@
+// Hand-off latency / throughput: previous mutex + condvar blocking_queue vs the lock-free ring
+//
+//   bench_blocking_queue [items]
+
+// *** Project Includes ***
+#include "bench_common.hpp"
+#include "blocking_queue.hpp"
+
+// *** Standard Includes ***
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace cosmos::bench;
+    using namespace std::chrono_literals;
+
+    // The blocking_queue this replaced, kept verbatim as the baseline.
+    template <class T>
+    class mutex_queue
+    {
+    public:
+        auto enqueue(T&& t) noexcept -> void
+        {
+            std::lock_guard<std::mutex> lock(m);
+            q.push(std::forward<T>(t));
+            c.notify_one();
+        }
+
+        template <class Rep, class Period>
+        [[nodiscard]] auto dequeue_wait(const std::chrono::duration<Rep, Period>& timeout) noexcept -> std::optional<T>
+        {
+            std::unique_lock<std::mutex> lock(m);
+            while (q.empty())
+            {
+                if (c.wait_for(lock, timeout) == std::cv_status::timeout)
+                    return std::nullopt;
+            }
+            T val = std::move(q.front());
+            q.pop();
+            return {val};
+        }
+
+    private:
+        std::queue<T> q{};
+        mutable std::mutex m{};
+        std::condition_variable c{};
+    };
+
+    // Producers stamp each item with its enqueue time, consumers record how long it sat in the queue.
+    template <class Queue>
+    auto measure(std::string_view name, std::size_t items, unsigned producers, unsigned consumers) -> void
+    {
+        Queue queue{};
+        std::vector<nanoseconds> samples{};
+        samples.reserve(items);
+        std::mutex samples_mutex{};
+        std::atomic_size_t remaining{items};
+        std::atomic_size_t next{0};
+
+        auto const wall_start = clock_type::now();
+        std::vector<std::thread> threads{};
+        for (unsigned c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&]
+            {
+                std::vector<nanoseconds> local{};
+                while (remaining.load(std::memory_order_relaxed) > 0)
+                {
+                    if (auto stamped = queue.dequeue_wait(1ms))
+                    {
+                        local.push_back(clock_type::now() - *stamped);
+                        remaining.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                }
+                std::lock_guard lock(samples_mutex);
+                samples.insert(samples.end(), local.begin(), local.end());
+            });
+        }
+        for (unsigned p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&]
+            {
+                while (next.fetch_add(1, std::memory_order_relaxed) < items)
+                    queue.enqueue(clock_type::now());
+            });
+        }
+        for (auto& t: threads)
+            t.join();
+        auto const wall = clock_type::now() - wall_start;
+
+        print_row(fmt::format("{} {}p/{}c", name, producers, consumers), summarize(std::move(samples)), wall);
+    }
+
+    auto compare(std::size_t items, unsigned producers, unsigned consumers) -> void
+    {
+        measure<mutex_queue<clock_type::time_point>>("mutex queue", items, producers, consumers);
+        measure<cosmos::blocking_queue<clock_type::time_point>>("lock-free ring", items, producers, consumers);
+    }
+} // namespace
+
+auto main(int argc, const char** argv) -> int
+{
+    auto const items = iterations_from(argc, argv, 1'000'000);
+    auto const threads = std::max(2U, std::thread::hardware_concurrency() / 2);
+
+    print_header();
+    compare(items, 1, 1);
+    compare(items, 2, 2);
+    compare(items, threads, threads);
+    compare(items, threads, 1);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Small helpers shared by the benchmark executables (no benchmark framework dependency)
+#pragma once
+
+// *** 3rd Party Includes ***
+#include <fmt/format.h>
+
+// *** Standard Includes ***
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+namespace cosmos::bench
+{
+    using clock_type = std::chrono::steady_clock;
+    using nanoseconds = std::chrono::nanoseconds;
+
+    struct latency_summary
+    {
+        std::size_t samples{};
+        double mean_us{};
+        double p50_us{};
+        double p99_us{};
+        double max_us{};
+    };
+
+    [[nodiscard]] inline auto summarize(std::vector<nanoseconds> samples) -> latency_summary
+    {
+        latency_summary summary{.samples = samples.size()};
+        if (samples.empty())
+            return summary;
+
+        std::ranges::sort(samples);
+        auto const to_us = [](nanoseconds ns) { return static_cast<double>(ns.count()) / 1000.0; };
+        auto const at = [&](double q) { return samples[static_cast<std::size_t>(q * static_cast<double>(samples.size() - 1))]; };
+
+        nanoseconds total{};
+        for (auto const s: samples)
+            total += s;
+
+        summary.mean_us = to_us(total) / static_cast<double>(samples.size());
+        summary.p50_us = to_us(at(0.50));
+        summary.p99_us = to_us(at(0.99));
+        summary.max_us = to_us(samples.back());
+        return summary;
+    }
+
+    inline auto print_header() -> void
+    {
+        fmt::println("{:<36} {:>9} {:>12} {:>12} {:>12} {:>12} {:>14}", "case", "samples", "mean(us)", "p50(us)",
+                     "p99(us)", "max(us)", "ops/s");
+    }
+
+    inline auto print_row(std::string_view name, latency_summary const& s, nanoseconds wall) -> void
+    {
+        auto const seconds = std::chrono::duration<double>(wall).count();
+        auto const rate = seconds > 0.0 ? static_cast<double>(s.samples) / seconds : 0.0;
+        fmt::println("{:<36} {:>9} {:>12.2f} {:>12.2f} {:>12.2f} {:>12.2f} {:>14.0f}", name, s.samples, s.mean_us,
+                     s.p50_us, s.p99_us, s.max_us, rate);
+    }
+
+    [[nodiscard]] inline auto iterations_from(int argc, const char** argv, std::size_t fallback) -> std::size_t
+    {
+        if (argc > 1)
+            if (auto const value = std::strtoull(argv[1], nullptr, 10); value > 0)
+                return static_cast<std::size_t>(value);
+        return fallback;
+    }
+} // namespace cosmos::bench
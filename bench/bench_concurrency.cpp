@@ -0,0 +1,625 @@
+// Benchmark and stress suite for the hot concurrency primitives: blocking_queue,
+// blocking_priority_queue, jx::notification_queue and jx::task_system
+//
+//   - producer/consumer throughput and enqueue-to-dequeue latency (with histograms) across thread counts
+//   - consumer fairness (share of items each consumer got, Jain's index)
+//   - timed waits: how late dequeue_wait hands out entries with a scheduled_time, and how far
+//     an empty dequeue_wait overshoots its timeout
+//   - a randomized linearizability check of the queues' histories
+//
+//   bench_concurrency [items] [linearizability rounds]
+//
+// Exits with 1 when an item is lost or duplicated, an entry is handed out before its scheduled
+// time, or a history is not linearizable, so it doubles as a stress test.
+
+// *** Project Includes ***
+#include "bench_common.hpp"
+#include "blocking_priority_queue.hpp"
+#include "blocking_queue.hpp"
+#include "task_system/task_system.hpp"
+
+// *** Standard Includes ***
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    using namespace cosmos::bench;
+    using namespace std::chrono_literals;
+
+    std::atomic_size_t failures{0};
+
+    template <class... Args>
+    auto fail(fmt::format_string<Args...> format, Args&&... args) -> void
+    {
+        failures.fetch_add(1);
+        fmt::println("FAIL: {}", fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    struct item
+    {
+        std::uint32_t producer{};
+        std::uint64_t sequence{}; // per producer
+        std::size_t index{};      // across the run
+        clock_type::time_point stamp{};
+    };
+
+    // blocking_priority_queue keeps the greatest entry on top; this makes it FIFO by stamp.
+    struct later_stamp_first
+    {
+        auto operator()(item const& lhs, item const& rhs) const noexcept -> bool { return lhs.stamp > rhs.stamp; }
+    };
+
+    // *** One face for every queue: push(item) and pop() -> std::optional<item> ***
+
+    struct blocking_queue_adapter
+    {
+        static constexpr std::string_view name = "blocking_queue";
+        cosmos::blocking_queue<item> queue{};
+
+        auto push(item i) -> void { queue.enqueue(std::move(i)); }
+        auto pop() -> std::optional<item> { return queue.dequeue_wait(1ms); }
+    };
+
+    struct priority_queue_adapter
+    {
+        static constexpr std::string_view name = "blocking_priority_queue";
+        cosmos::blocking_priority_queue<item, later_stamp_first> queue{};
+
+        auto push(item i) -> void { (void) queue.enqueue(std::move(i)); }
+        auto pop() -> std::optional<item> { return queue.dequeue_wait(1ms); }
+    };
+
+    // notification_queue only carries jobs: each job hands its item to the thread that runs it.
+    struct notification_queue_adapter
+    {
+        static constexpr std::string_view name = "notification_queue";
+        static inline thread_local item popped{};
+        jx::notification_queue queue{};
+
+        auto push(item i) -> void { queue.push([i] { popped = i; }); }
+        auto pop() -> std::optional<item>
+        {
+            jx::function_capture_t job;
+            if (not queue.pop(job))
+            {
+                std::this_thread::yield(); // it never blocks for work, consumers have to poll
+                return std::nullopt;
+            }
+            job();
+            return popped;
+        }
+    };
+
+    struct run_result
+    {
+        std::string name{};
+        latency_summary latency{};
+        nanoseconds wall{};
+        std::vector<nanoseconds> samples{};
+        std::vector<std::size_t> per_consumer{};
+    };
+
+    // Log2 buckets from 1us up, the last one open ended.
+    auto print_histogram(std::string_view name, std::vector<nanoseconds> const& samples) -> void
+    {
+        constexpr std::size_t buckets = 12;
+        std::array<std::size_t, buckets> counts{};
+        for (auto const s: samples)
+        {
+            auto const us = static_cast<std::uint64_t>(std::max<std::int64_t>(s.count() / 1000, 0));
+            auto const bucket = us == 0 ? 0 : static_cast<std::size_t>(std::bit_width(us));
+            ++counts[std::min(bucket, buckets - 1)];
+        }
+
+        std::string row;
+        for (auto const c: counts)
+            row += fmt::format(" {:>6.2f}", samples.empty() ? 0.0 : 100.0 * static_cast<double>(c) / static_cast<double>(samples.size()));
+        fmt::println("{:<36}{}", name, row);
+    }
+
+    auto print_histogram_header() -> void
+    {
+        std::string row;
+        for (std::size_t b = 0; b < 11; ++b)
+            row += fmt::format(" {:>6}", fmt::format("<{}", 1U << b));
+        row += fmt::format(" {:>6}", ">=1k");
+        fmt::println("{:<36}{}", "latency % per bucket (us)", row);
+    }
+
+    auto print_fairness(std::string_view name, std::vector<std::size_t> const& shares) -> void
+    {
+        if (shares.empty())
+            return;
+        double sum = 0.0;
+        double squares = 0.0;
+        for (auto const s: shares)
+        {
+            sum += static_cast<double>(s);
+            squares += static_cast<double>(s) * static_cast<double>(s);
+        }
+        auto const jain = squares > 0.0 ? sum * sum / (static_cast<double>(shares.size()) * squares) : 1.0;
+        auto const [min, max] = std::ranges::minmax(shares);
+        fmt::println("{:<36} {:>9} {:>12} {:>12} {:>12.3f}", name, shares.size(), min, max, jain);
+    }
+
+    // Every item must come out exactly once, and items of one producer in the order they went in
+    // (for the FIFO queues) as seen by each consumer.
+    template <class Adapter>
+    auto producer_consumer(std::size_t items, unsigned producers, unsigned consumers) -> run_result
+    {
+        Adapter adapter{};
+        std::atomic_size_t remaining{items};
+        std::mutex results_mutex{};
+        run_result result{.name = fmt::format("{} {}p/{}c", Adapter::name, producers, consumers)};
+        std::vector<std::uint8_t> seen(items, 0);
+
+        auto const wall_start = clock_type::now();
+        std::vector<std::thread> threads{};
+        for (unsigned c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&]
+            {
+                std::vector<nanoseconds> local{};
+                std::vector<std::uint64_t> last_of(producers, 0);
+                std::vector<std::size_t> got{};
+                while (remaining.load(std::memory_order_relaxed) > 0)
+                {
+                    auto popped = adapter.pop();
+                    if (not popped)
+                        continue;
+                    local.push_back(clock_type::now() - popped->stamp);
+                    if (popped->sequence + 1 <= last_of[popped->producer])
+                        fail("{}: producer {} item {} after {}", result.name, popped->producer, popped->sequence,
+                             last_of[popped->producer] - 1);
+                    last_of[popped->producer] = popped->sequence + 1;
+                    got.push_back(popped->index);
+                    remaining.fetch_sub(1, std::memory_order_relaxed);
+                }
+                std::lock_guard lock(results_mutex);
+                result.samples.insert(result.samples.end(), local.begin(), local.end());
+                result.per_consumer.push_back(local.size());
+                for (auto const index: got)
+                    if (seen[index]++ != 0)
+                        fail("{}: item {} dequeued twice", result.name, index);
+            });
+        }
+        for (unsigned p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&, p]
+            {
+                std::uint64_t sequence = 0;
+                for (std::size_t i = p; i < items; i += producers)
+                    adapter.push(item{.producer = p, .sequence = sequence++, .index = i, .stamp = clock_type::now()});
+            });
+        }
+        for (auto& t: threads)
+            t.join();
+        result.wall = clock_type::now() - wall_start;
+
+        if (auto const missing = static_cast<std::size_t>(std::ranges::count(seen, 0)); missing > 0)
+            fail("{}: {} items never dequeued", result.name, missing);
+        result.latency = summarize(result.samples);
+        return result;
+    }
+
+    // task_system has no consumers to compare, only workers: submit-to-run latency and how the jobs
+    // spread over the workers.
+    auto task_system_load(std::size_t jobs, unsigned producers, unsigned workers) -> run_result
+    {
+        run_result result{.name = fmt::format("task_system {}p/{}w", producers, workers)};
+        std::vector<nanoseconds> samples(jobs);
+        std::vector<std::thread::id> ran_on(jobs);
+        std::atomic_size_t done{0};
+
+        auto const wall_start = clock_type::now();
+        {
+            jx::task_system system{jx::task_system_options{.threads = workers}};
+            std::vector<std::thread> threads{};
+            for (unsigned p = 0; p < producers; ++p)
+            {
+                threads.emplace_back([&, p]
+                {
+                    for (std::size_t i = p; i < jobs; i += producers)
+                    {
+                        auto const submitted = clock_type::now();
+                        system.async([&, i, submitted]
+                        {
+                            samples[i] = clock_type::now() - submitted;
+                            ran_on[i] = std::this_thread::get_id();
+                            done.fetch_add(1, std::memory_order_relaxed);
+                        });
+                    }
+                });
+            }
+            for (auto& t: threads)
+                t.join();
+        }
+        result.wall = clock_type::now() - wall_start;
+
+        if (done.load() != jobs)
+            fail("{}: ran {} of {} jobs", result.name, done.load(), jobs);
+        std::unordered_map<std::thread::id, std::size_t> per_worker{};
+        for (auto const id: ran_on)
+            ++per_worker[id];
+        for (auto const& [_, count]: per_worker)
+            result.per_consumer.push_back(count);
+        result.per_consumer.resize(workers, 0);
+        result.samples = std::move(samples);
+        result.latency = summarize(result.samples);
+        return result;
+    }
+
+    // *** Timed waits ***
+
+    struct timed_item
+    {
+        clock_type::time_point scheduled_time{};
+        std::uint64_t id{};
+    };
+
+    struct earlier_first
+    {
+        auto operator()(timed_item const& lhs, timed_item const& rhs) const noexcept -> bool
+        {
+            return lhs.scheduled_time > rhs.scheduled_time;
+        }
+    };
+
+    // Entries due at random points of the next 20ms: how long after its time each is handed out.
+    auto scheduled_lateness(std::size_t items, unsigned consumers) -> void
+    {
+        cosmos::blocking_priority_queue<timed_item, earlier_first> queue{};
+        std::atomic_size_t remaining{items};
+        std::mutex samples_mutex{};
+        std::vector<nanoseconds> samples{};
+        std::mt19937_64 random{items};
+        std::uniform_int_distribution<std::int64_t> offset_us{0, 20'000};
+
+        auto const wall_start = clock_type::now();
+        std::vector<std::thread> threads{};
+        for (unsigned c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&]
+            {
+                std::vector<nanoseconds> local{};
+                while (remaining.load(std::memory_order_relaxed) > 0)
+                {
+                    auto due = queue.dequeue_wait(50ms);
+                    if (not due)
+                        continue;
+                    auto const now = clock_type::now();
+                    if (now < due->scheduled_time)
+                        fail("dequeue_wait handed out entry {} {}ns early", due->id, (due->scheduled_time - now).count());
+                    local.push_back(now - due->scheduled_time);
+                    remaining.fetch_sub(1, std::memory_order_relaxed);
+                }
+                std::lock_guard lock(samples_mutex);
+                samples.insert(samples.end(), local.begin(), local.end());
+            });
+        }
+        for (std::size_t i = 0; i < items; ++i)
+            (void) queue.enqueue(timed_item{.scheduled_time = clock_type::now() + std::chrono::microseconds{offset_us(random)}, .id = i});
+        for (auto& t: threads)
+            t.join();
+
+        print_row(fmt::format("scheduled lateness {}c", consumers), summarize(std::move(samples)), clock_type::now() - wall_start);
+    }
+
+    // dequeue_wait on an empty queue: how far past `timeout` it returns.
+    template <class Queue>
+    auto timeout_overshoot(std::string_view name, nanoseconds timeout, std::size_t waits) -> void
+    {
+        Queue queue{};
+        std::vector<nanoseconds> samples{};
+        auto const wall_start = clock_type::now();
+        for (std::size_t i = 0; i < waits; ++i)
+        {
+            auto const start = clock_type::now();
+            if (queue.dequeue_wait(timeout))
+                fail("{}: dequeue_wait returned an entry from an empty queue", name);
+            auto const waited = clock_type::now() - start;
+            if (waited < timeout)
+                fail("{}: dequeue_wait({}ns) gave up after {}ns", name, timeout.count(), waited.count());
+            samples.push_back(waited - timeout);
+        }
+        print_row(fmt::format("{} overshoot {}us", name, timeout.count() / 1000), summarize(std::move(samples)),
+                  clock_type::now() - wall_start);
+    }
+
+    // *** Linearizability ***
+    //
+    // Threads run random non-blocking enqueue/dequeue mixes against one queue; every operation is
+    // stamped from one shared counter when it is invoked and when it responds, so "a responded
+    // before b was invoked" is real-time order. With distinct values a FIFO history is linearizable
+    // exactly when none of these shows up (Henzinger et al., "Aspect-oriented linearizability
+    // proofs"): a value dequeued twice or never enqueued or before its enqueue; a value b dequeued
+    // before a although enqueue(a) finished before enqueue(b) started; an empty dequeue while some
+    // value was in the queue for its whole duration. The priority queue check replaces the order
+    // rule with: no dequeue returns b while a higher priority a was in the queue for its whole duration.
+
+    struct operation
+    {
+        bool enqueue{};
+        std::optional<std::uint64_t> value{}; // empty for a dequeue that found nothing
+        std::uint64_t invoked{};
+        std::uint64_t responded{};
+    };
+
+    using history = std::vector<operation>;
+
+    struct value_life
+    {
+        operation const* enqueued{nullptr};
+        operation const* dequeued{nullptr};
+    };
+
+    // A value still queued at the end of the round counts as dequeued at the end of time.
+    [[nodiscard]] auto present_throughout(value_life const& life, operation const& op) -> bool
+    {
+        return life.enqueued->responded < op.invoked and (not life.dequeued or life.dequeued->invoked > op.responded);
+    }
+
+    [[nodiscard]] auto lives_of(history const& ops, std::string_view name)
+        -> std::optional<std::unordered_map<std::uint64_t, value_life>>
+    {
+        std::unordered_map<std::uint64_t, value_life> lives;
+        for (auto const& op: ops)
+            if (op.enqueue)
+                lives[*op.value].enqueued = &op;
+        for (auto const& op: ops)
+        {
+            if (op.enqueue or not op.value)
+                continue;
+            auto found = lives.find(*op.value);
+            if (found == lives.end())
+            {
+                fail("{}: dequeued {} which was never enqueued", name, *op.value);
+                return std::nullopt;
+            }
+            if (found->second.dequeued)
+            {
+                fail("{}: dequeued {} twice", name, *op.value);
+                return std::nullopt;
+            }
+            if (op.responded < found->second.enqueued->invoked)
+            {
+                fail("{}: dequeued {} before it was enqueued", name, *op.value);
+                return std::nullopt;
+            }
+            found->second.dequeued = &op;
+        }
+        return lives;
+    }
+
+    auto check_empty_dequeues(history const& ops, std::unordered_map<std::uint64_t, value_life> const& lives,
+                              std::string_view name) -> bool
+    {
+        for (auto const& op: ops)
+        {
+            if (op.enqueue or op.value)
+                continue;
+            for (auto const& [value, life]: lives)
+                if (present_throughout(life, op))
+                {
+                    fail("{}: dequeue found nothing while {} was queued", name, value);
+                    return false;
+                }
+        }
+        return true;
+    }
+
+    auto check_fifo(history const& ops, std::string_view name) -> bool
+    {
+        auto const lives = lives_of(ops, name);
+        if (not lives)
+            return false;
+        for (auto const& [a, first]: *lives)
+            for (auto const& [b, second]: *lives)
+            {
+                if (not second.dequeued or first.enqueued->responded >= second.enqueued->invoked)
+                    continue;
+                if (not first.dequeued or second.dequeued->responded < first.dequeued->invoked)
+                {
+                    fail("{}: {} overtook {}", name, b, a);
+                    return false;
+                }
+            }
+        return check_empty_dequeues(ops, *lives, name);
+    }
+
+    // Smaller values have higher priority.
+    auto check_priority(history const& ops, std::string_view name) -> bool
+    {
+        auto const lives = lives_of(ops, name);
+        if (not lives)
+            return false;
+        for (auto const& op: ops)
+        {
+            if (op.enqueue or not op.value)
+                continue;
+            for (auto const& [a, life]: *lives)
+                if (a < *op.value and present_throughout(life, op))
+                {
+                    fail("{}: dequeued {} while {} was queued", name, *op.value, a);
+                    return false;
+                }
+        }
+        return check_empty_dequeues(ops, *lives, name);
+    }
+
+    struct smaller_first
+    {
+        auto operator()(std::uint64_t lhs, std::uint64_t rhs) const noexcept -> bool { return lhs > rhs; }
+    };
+
+    // try_enqueue / try_dequeue style hooks, false / std::nullopt when they had no effect.
+    struct linearizable_blocking_queue
+    {
+        static constexpr std::string_view name = "blocking_queue";
+        cosmos::blocking_queue<std::uint64_t> queue{8}; // small, so the ring wraps and fills up
+        auto try_push(std::uint64_t v) -> bool { return queue.try_enqueue(std::move(v)); }
+        auto try_pop() -> std::optional<std::uint64_t> { return queue.try_dequeue(); }
+        static auto check(history const& ops) -> bool { return check_fifo(ops, name); }
+    };
+
+    struct linearizable_priority_queue
+    {
+        static constexpr std::string_view name = "blocking_priority_queue";
+        cosmos::blocking_priority_queue<std::uint64_t, smaller_first> queue{};
+        auto try_push(std::uint64_t v) -> bool
+        {
+            (void) queue.enqueue(std::move(v));
+            return true;
+        }
+        auto try_pop() -> std::optional<std::uint64_t> { return queue.dequeue_wait(0ns); }
+        static auto check(history const& ops) -> bool { return check_priority(ops, name); }
+    };
+
+    struct linearizable_notification_queue
+    {
+        static constexpr std::string_view name = "notification_queue";
+        static inline thread_local std::uint64_t popped{};
+        jx::notification_queue queue{};
+        auto try_push(std::uint64_t v) -> bool
+        {
+            queue.push([v] { popped = v; });
+            return true;
+        }
+        auto try_pop() -> std::optional<std::uint64_t>
+        {
+            jx::function_capture_t job;
+            if (not queue.pop(job))
+                return std::nullopt;
+            job();
+            return popped;
+        }
+        static auto check(history const& ops) -> bool { return check_fifo(ops, name); }
+    };
+
+    template <class Queue>
+    auto linearizability(std::size_t rounds, unsigned threads, std::size_t ops_per_thread) -> void
+    {
+        std::size_t operations = 0;
+        std::size_t passed = 0;
+        auto const wall_start = clock_type::now();
+        for (std::size_t round = 0; round < rounds; ++round)
+        {
+            Queue queue{};
+            std::atomic_uint64_t clock{0};
+            std::vector<history> per_thread(threads);
+            std::vector<std::thread> workers{};
+            for (unsigned t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&, t]
+                {
+                    std::mt19937_64 random{round * threads + t};
+                    auto& ops = per_thread[t];
+                    ops.reserve(ops_per_thread);
+                    std::uint64_t next = 0;
+                    for (std::size_t i = 0; i < ops_per_thread; ++i)
+                    {
+                        operation op{.enqueue = random() % 2 == 0};
+                        if (op.enqueue)
+                        {
+                            // Random high bits give the priority queue something to order, the
+                            // thread and counter keep every value distinct.
+                            auto const value = ((random() % 1024) << 32) | (std::uint64_t{t} << 24) | next++;
+                            op.invoked = clock.fetch_add(1);
+                            auto const pushed = queue.try_push(value);
+                            op.responded = clock.fetch_add(1);
+                            if (not pushed)
+                                continue; // a full ring is not an operation on the history
+                            op.value = value;
+                        }
+                        else
+                        {
+                            op.invoked = clock.fetch_add(1);
+                            op.value = queue.try_pop();
+                            op.responded = clock.fetch_add(1);
+                        }
+                        ops.push_back(op);
+                    }
+                });
+            }
+            for (auto& w: workers)
+                w.join();
+
+            history merged;
+            for (auto& ops: per_thread)
+                merged.insert(merged.end(), ops.begin(), ops.end());
+            operations += merged.size();
+            if (Queue::check(merged))
+                ++passed;
+            while (queue.try_pop())
+                ;
+        }
+        auto const seconds = std::chrono::duration<double>(clock_type::now() - wall_start).count();
+        fmt::println("{:<36} {:>9} {:>12} {:>12} {:>12.2f}", Queue::name, rounds, passed, operations, seconds);
+    }
+} // namespace
+
+auto main(int argc, const char** argv) -> int
+{
+    auto const items = iterations_from(argc, argv, 200'000);
+    auto const rounds = argc > 2 ? iterations_from(argc - 1, argv + 1, 500) : std::size_t{500};
+    auto const wide = std::max(2U, std::thread::hardware_concurrency());
+    std::vector<std::pair<unsigned, unsigned>> const shapes{{1, 1}, {2, 2}, {wide, wide}, {wide, 1}, {1, wide}};
+
+    std::vector<run_result> results{};
+    for (auto const& [producers, consumers]: shapes)
+    {
+        results.push_back(producer_consumer<blocking_queue_adapter>(items, producers, consumers));
+        results.push_back(producer_consumer<priority_queue_adapter>(items, producers, consumers));
+        results.push_back(producer_consumer<notification_queue_adapter>(items, producers, consumers));
+        results.push_back(task_system_load(items, producers, consumers));
+    }
+
+    fmt::println("== throughput and enqueue-to-dequeue latency");
+    print_header();
+    for (auto const& r: results)
+        print_row(r.name, r.latency, r.wall);
+
+    fmt::println("\n== latency histograms");
+    print_histogram_header();
+    for (auto const& r: results)
+        print_histogram(r.name, r.samples);
+
+    fmt::println("\n== fairness (items per consumer / jobs per worker)");
+    fmt::println("{:<36} {:>9} {:>12} {:>12} {:>12}", "case", "consumers", "min", "max", "jain");
+    for (auto const& r: results)
+        print_fairness(r.name, r.per_consumer);
+
+    fmt::println("\n== timed waits");
+    print_header();
+    for (auto const consumers: {1U, wide})
+        scheduled_lateness(std::min<std::size_t>(items, 20'000), consumers);
+    for (auto const timeout: {nanoseconds{100us}, nanoseconds{1ms}, nanoseconds{10ms}})
+    {
+        timeout_overshoot<cosmos::blocking_queue<item>>("blocking_queue", timeout, 100);
+        timeout_overshoot<cosmos::blocking_priority_queue<timed_item, earlier_first>>("blocking_priority_queue", timeout, 100);
+    }
+
+    fmt::println("\n== linearizability");
+    fmt::println("{:<36} {:>9} {:>12} {:>12} {:>12}", "queue", "rounds", "passed", "operations", "seconds");
+    linearizability<linearizable_blocking_queue>(rounds, 4, 200);
+    linearizability<linearizable_priority_queue>(rounds, 4, 200);
+    linearizability<linearizable_notification_queue>(rounds, 4, 200);
+
+    if (auto const failed = failures.load(); failed > 0)
+    {
+        fmt::println("\n{} failures", failed);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Per-task launch latency of python tasks: a fresh interpreter per task vs the pre-forked interpreter_pool
+//
+//   bench_interpreter_pool [iterations] [module to import, default json]
+
+// *** Project Includes ***
+#include "bench_common.hpp"
+#include "interpreter_pool.hpp"
+#include "subprocess.hpp"
+
+// *** Standard Includes ***
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+    using namespace cosmos::bench;
+    namespace fs = std::filesystem;
+
+    auto measure(std::string_view name, std::size_t iterations, std::function<bool()> const& launch) -> void
+    {
+        std::vector<nanoseconds> samples{};
+        samples.reserve(iterations);
+        std::size_t failures = 0;
+
+        auto const wall_start = clock_type::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            auto const start = clock_type::now();
+            if (not launch())
+                ++failures;
+            samples.push_back(clock_type::now() - start);
+        }
+        auto const wall = clock_type::now() - wall_start;
+
+        print_row(name, summarize(std::move(samples)), wall);
+        if (failures)
+            fmt::println("  ! {} launches failed", failures);
+    }
+
+    auto succeeded(auto const& result) -> bool { return result.has_value() and result->status.success(); }
+} // namespace
+
+auto main(int argc, const char** argv) -> int
+{
+    auto const iterations = iterations_from(argc, argv, 200);
+    std::string const module = argc > 2 ? argv[2] : "json";
+
+    auto const dir = fs::temp_directory_path() / fmt::format("bench_interpreter_pool_{}", ::getpid());
+    fs::create_directories(dir);
+    auto const script = dir / "task.py";
+    std::ofstream{script} << "import " << module << "\nprint('done')\n";
+
+    print_header();
+    measure(fmt::format("python3 per task ({})", module), iterations, [&]
+    {
+        return succeeded(cosmos::run_streamed({.arguments = {"python3", script.string()}}, {}));
+    });
+
+    for (std::size_t const recycle: {std::size_t{0}, std::size_t{10}})
+    {
+        cosmos::interpreter_pool pool{{.workers = 1, .recycle_after = recycle, .preload_modules = {module}}};
+        measure(fmt::format("pool x1 recycle={}", recycle), iterations, [&]
+        {
+            return succeeded(pool.run_script(script, {}));
+        });
+    }
+
+    // Throughput with as many workers as cores, submitted from as many threads.
+    auto const threads = std::max(2U, std::thread::hardware_concurrency());
+    cosmos::interpreter_pool pool{{.workers = threads, .recycle_after = 0, .preload_modules = {module}}};
+    std::vector<nanoseconds> samples{};
+    std::mutex samples_mutex{};
+    std::atomic_size_t next{0};
+    auto const wall_start = clock_type::now();
+    std::vector<std::thread> submitters{};
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        submitters.emplace_back([&]
+        {
+            std::vector<nanoseconds> local{};
+            while (next.fetch_add(1, std::memory_order_relaxed) < iterations)
+            {
+                auto const start = clock_type::now();
+                (void) pool.run_script(script, {});
+                local.push_back(clock_type::now() - start);
+            }
+            std::lock_guard lock(samples_mutex);
+            samples.insert(samples.end(), local.begin(), local.end());
+        });
+    }
+    for (auto& s: submitters)
+        s.join();
+    print_row(fmt::format("pool x{} concurrent", threads), summarize(std::move(samples)), clock_type::now() - wall_start);
+
+    fs::remove_all(dir);
+    return 0;
+}
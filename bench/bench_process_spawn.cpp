@@ -0,0 +1,81 @@
+// Spawn latency / throughput: popen (execute_command) vs posix_spawn + pidfd (subprocess::run)
+//
+//   bench_process_spawn [iterations]
+
+// *** Project Includes ***
+#include "bench_common.hpp"
+#include "process/system_execution.hpp"
+#include "subprocess.hpp"
+
+// *** Standard Includes ***
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace cosmos::bench;
+
+    auto popen_true() -> bool { return cosmos::execute_command("/bin/true").has_value(); }
+    auto spawn_true() -> bool { return cosmos::run({.arguments = {"/bin/true"}}).has_value(); }
+
+    auto popen_output() -> bool { return cosmos::execute_command("head -c 1048576 /dev/zero").has_value(); }
+    auto spawn_output() -> bool
+    {
+        return cosmos::run({.arguments = {"/usr/bin/head", "-c", "1048576", "/dev/zero"}}).has_value();
+    }
+
+    auto measure(std::string_view name, std::size_t iterations, unsigned threads, std::function<bool()> const& launch)
+        -> void
+    {
+        std::vector<nanoseconds> samples{};
+        samples.reserve(iterations);
+        std::mutex samples_mutex{};
+        std::atomic_size_t next{0};
+        std::atomic_size_t failures{0};
+
+        auto const wall_start = clock_type::now();
+        std::vector<std::thread> workers{};
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&]
+            {
+                std::vector<nanoseconds> local{};
+                while (next.fetch_add(1, std::memory_order_relaxed) < iterations)
+                {
+                    auto const start = clock_type::now();
+                    if (not launch())
+                        failures.fetch_add(1, std::memory_order_relaxed);
+                    local.push_back(clock_type::now() - start);
+                }
+                std::lock_guard lock(samples_mutex);
+                samples.insert(samples.end(), local.begin(), local.end());
+            });
+        }
+        for (auto& w: workers)
+            w.join();
+        auto const wall = clock_type::now() - wall_start;
+
+        print_row(fmt::format("{} x{}", name, threads), summarize(std::move(samples)), wall);
+        if (auto const failed = failures.load(); failed)
+            fmt::println("  ! {} launches failed", failed);
+    }
+} // namespace
+
+auto main(int argc, const char** argv) -> int
+{
+    auto const iterations = iterations_from(argc, argv, 2000);
+    auto const threads = std::max(2U, std::thread::hardware_concurrency());
+
+    print_header();
+    measure("popen /bin/true", iterations, 1, popen_true);
+    measure("posix_spawn /bin/true", iterations, 1, spawn_true);
+    measure("popen /bin/true", iterations, threads, popen_true);
+    measure("posix_spawn /bin/true", iterations, threads, spawn_true);
+    measure("popen 1MiB stdout", iterations / 10, 1, popen_output);
+    measure("posix_spawn 1MiB stdout", iterations / 10, 1, spawn_output);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Heap allocations per submitted job: std::function + std::deque (previous jx::task_system job
+// type) vs small_function + job_ring
+//
+//   bench_task_allocations [jobs]
+
+// *** Project Includes ***
+#include "bench_common.hpp"
+#include "task_system/task_system.hpp"
+
+// *** Standard Includes ***
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <new>
+#include <thread>
+
+namespace
+{
+    std::atomic_size_t allocations{0};
+}
+
+// Counting global allocator, every operator new in the process goes through here.
+auto operator new(std::size_t size) -> void*
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void* p) noexcept -> void { std::free(p); }
+auto operator delete(void* p, std::size_t) noexcept -> void { std::free(p); }
+
+namespace
+{
+    using namespace cosmos::bench;
+
+    // A typical job capture: a couple of pointers plus some inline state, 48 bytes.
+    struct job_state
+    {
+        std::atomic_size_t* done;
+        std::array<std::size_t, 5> payload;
+    };
+
+    auto report(std::string_view name, std::size_t jobs, std::size_t counted, nanoseconds wall) -> void
+    {
+        auto const per_job_ns = static_cast<double>(wall.count()) / static_cast<double>(jobs);
+        fmt::println("{:<40} {:>10} {:>14} {:>16.3f} {:>12.1f}", name, jobs, counted,
+                     static_cast<double>(counted) / static_cast<double>(jobs), per_job_ns);
+    }
+
+    // Queue round-trip on one thread: build the job, push it, pop it, run it.
+    template <class Function, class Queue>
+    auto queue_round_trip(std::string_view name, std::size_t jobs) -> void
+    {
+        std::atomic_size_t done{0};
+        Queue queue{};
+        auto const round = [&](std::size_t i)
+        {
+            job_state state{.done = &done, .payload = {i, i, i, i, i}};
+            queue.emplace_back(Function{[state] { state.done->fetch_add(1, std::memory_order_relaxed); }});
+            auto job = std::move(queue.front());
+            queue.pop_front();
+            job();
+        };
+
+        for (std::size_t i = 0; i < 1024; ++i) // warm-up: let the containers reach their working size
+            round(i);
+
+        auto const before = allocations.load();
+        auto const start = clock_type::now();
+        for (std::size_t i = 0; i < jobs; ++i)
+            round(i);
+        report(name, jobs, allocations.load() - before, clock_type::now() - start);
+    }
+
+    // Same job through jx::task_system::async, across its worker threads.
+    auto task_system_submit(std::size_t jobs) -> void
+    {
+        std::atomic_size_t done{0};
+        jx::task_system system{48};
+        auto const submit = [&](std::size_t count)
+        {
+            auto const target = done.load() + count;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                job_state state{.done = &done, .payload = {i, i, i, i, i}};
+                system.async([state] { state.done->fetch_add(1, std::memory_order_relaxed); });
+            }
+            while (done.load() < target)
+                std::this_thread::yield();
+        };
+
+        submit(4096);
+        auto const before = allocations.load();
+        auto const start = clock_type::now();
+        submit(jobs);
+        report("task_system::async (small_function)", jobs, allocations.load() - before, clock_type::now() - start);
+    }
+
+    // std::deque exposes front/pop_front, job_ring only pop_front; give both the same face.
+    struct ring_adapter
+    {
+        jx::job_ring ring{};
+        jx::function_capture_t popped{};
+
+        auto emplace_back(jx::function_capture_t&& f) -> void { ring.emplace_back(std::move(f)); }
+        auto front() -> jx::function_capture_t&
+        {
+            popped = ring.pop_front();
+            return popped;
+        }
+        auto pop_front() -> void {}
+    };
+} // namespace
+
+auto main(int argc, const char** argv) -> int
+{
+    auto const jobs = iterations_from(argc, argv, 1'000'000);
+
+    fmt::println("{:<40} {:>10} {:>14} {:>16} {:>12}", "case", "jobs", "allocations", "allocs/job", "ns/job");
+    queue_round_trip<std::function<void()>, std::deque<std::function<void()>>>("std::function + std::deque", jobs);
+    queue_round_trip<jx::function_capture_t, ring_adapter>("small_function + job_ring", jobs);
+    task_system_submit(jobs);
+    return 0;
+}
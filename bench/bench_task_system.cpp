@@ -0,0 +1,104 @@
+// jx::task_system submit-to-start latency and throughput under low and high load, for different
+// idle strategies (park at once, spin then park) and worker placements
+//
+//   bench_task_system [jobs]
+
+// *** Project Includes ***
+#include "bench_common.hpp"
+#include "task_system/task_system.hpp"
+
+// *** Standard Includes ***
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace cosmos::bench;
+
+    // Low load: one job in flight at a time, every submission finds the workers idle (or parked).
+    auto low_load(std::string_view name, jx::task_system_options const& options, std::size_t jobs) -> void
+    {
+        jx::task_system system{options};
+        std::vector<nanoseconds> samples{};
+        samples.reserve(jobs);
+        std::atomic_bool ran{false};
+
+        auto const wall_start = clock_type::now();
+        for (std::size_t i = 0; i < jobs; ++i)
+        {
+            ran.store(false);
+            auto const submitted = clock_type::now();
+            system.async([&, submitted]
+            {
+                samples.push_back(clock_type::now() - submitted);
+                ran.store(true, std::memory_order_release);
+            });
+            while (not ran.load(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+        auto const wall = clock_type::now() - wall_start;
+        print_row(fmt::format("low  {}", name), summarize(std::move(samples)), wall);
+    }
+
+    // High load: several producers submit back to back, queues stay non-empty.
+    auto high_load(std::string_view name, jx::task_system_options const& options, std::size_t jobs) -> void
+    {
+        std::vector<nanoseconds> samples{};
+        samples.reserve(jobs);
+        std::mutex samples_mutex{};
+        auto const producers = std::max(2U, options.threads / 2);
+
+        auto const wall_start = clock_type::now();
+        {
+            jx::task_system system{options};
+            std::vector<std::thread> threads{};
+            for (unsigned p = 0; p < producers; ++p)
+            {
+                threads.emplace_back([&]
+                {
+                    for (std::size_t i = 0; i < jobs / producers; ++i)
+                    {
+                        system.async([&, submitted = clock_type::now()]
+                        {
+                            auto const latency = clock_type::now() - submitted;
+                            std::lock_guard lock(samples_mutex);
+                            samples.push_back(latency);
+                        });
+                    }
+                });
+            }
+            for (auto& t: threads)
+                t.join();
+        } // draining the queues is part of the measurement
+        auto const wall = clock_type::now() - wall_start;
+        print_row(fmt::format("high {}", name), summarize(std::move(samples)), wall);
+    }
+} // namespace
+
+auto main(int argc, const char** argv) -> int
+{
+    auto const jobs = iterations_from(argc, argv, 200'000);
+    auto const threads = std::max(2U, std::thread::hardware_concurrency());
+
+    struct configuration
+    {
+        std::string_view name;
+        jx::task_system_options options;
+    };
+    std::vector<configuration> const configurations{
+        {"park at once", {.threads = threads, .spin_rounds = 0}},
+        {"spin 64 then park", {.threads = threads, .spin_rounds = 64}},
+        {"spin 64, pinned to cores", {.threads = threads, .spin_rounds = 64, .affinity = jx::worker_affinity::cores}},
+        {"spin 64, pinned to NUMA nodes", {.threads = threads, .spin_rounds = 64, .affinity = jx::worker_affinity::numa_nodes}},
+    };
+
+    print_header();
+    for (auto const& [name, options]: configurations)
+        low_load(name, options, jobs / 20);
+    for (auto const& [name, options]: configurations)
+        high_load(name, options, jobs);
+    return 0;
+}
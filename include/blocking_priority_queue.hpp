@@ -5,13 +5,18 @@
 #ifndef BLOCKING_PRIORITY_QUEUE_HPP
 #define BLOCKING_PRIORITY_QUEUE_HPP
 
+#include "indexed_heap.hpp"
+
 #include <chrono>
 #include <condition_variable>
+#include <cstddef>
 #include <functional>
 #include <algorithm>
 #include <mutex>
+#include <iterator>
 #include <optional>
-#include <queue>
+#include <ranges>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -31,29 +36,136 @@ namespace cosmos::inline v1
             else
                 return u->scheduled_time;
         }
+
+        template <class U>
+        [[nodiscard]] constexpr auto scheduled_time_ref(U& u) noexcept -> auto&
+            requires has_scheduled_time<U>
+        {
+            if constexpr (requires(U& v) { v.scheduled_time; })
+                return u.scheduled_time;
+            else
+                return u->scheduled_time;
+        }
     } // namespace detail
 
+    /**
+     * @brief priority queue for consumers that block. Entries live in an indexed_heap, so enqueue
+     * returns a handle with which a still-queued entry can be cancelled (erase) or, for entries with a
+     * scheduled_time, moved to another time (reschedule). Handles of entries that were already
+     * dequeued are simply ignored.
+     */
     template <class T, class Compare = std::less<T>>
     class blocking_priority_queue
     {
     public:
-        constexpr auto enqueue(T&& t) noexcept -> void
+        using handle = heap_handle;
+
+        constexpr auto enqueue(T&& t) noexcept -> handle
         {
             std::lock_guard<std::mutex> lock(mutex);
-            heap.push_back(std::forward<T>(t));
-            std::push_heap(heap.begin(), heap.end(), compare);
+            auto const h = heap.push(std::forward<T>(t));
             condition.notify_one();
+            return h;
+        }
+
+        /**
+         * @brief moves every element of `range` in under one lock and one heapify, then wakes as many
+         * waiting consumers as there are new entries (not more than are waiting).
+         */
+        template <std::ranges::input_range Range>
+        auto enqueue_bulk(Range&& range) -> std::vector<handle>
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto handles = heap.push_bulk(std::forward<Range>(range));
+            for (auto wake = std::min(handles.size(), waiting); wake > 0; --wake)
+                condition.notify_one();
+            return handles;
         }
 
         [[nodiscard]] constexpr auto dequeue() noexcept -> T
         {
             std::unique_lock<std::mutex> lock(mutex);
             while (heap.empty())
-                condition.wait(lock);
-            std::pop_heap(heap.begin(), heap.end(), compare);
-            auto val = std::move(heap.back());
-            heap.pop_back();
-            return std::move(val);
+                wait(lock);
+            return heap.pop();
+        }
+
+        /**
+         * @brief waits up to `timeout` for an entry that is ready (due, for entries with a
+         * scheduled_time) and then moves up to `max` ready entries into `out` under the same lock.
+         * Returns how many were written, 0 on timeout.
+         */
+        template <std::output_iterator<T> Output, class Rep, class Period>
+        [[nodiscard]] auto dequeue_bulk(Output out, std::size_t max, const std::chrono::duration<Rep, Period>& timeout)
+            -> std::size_t
+        {
+            auto const deadline = std::chrono::steady_clock::now() + timeout;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true)
+            {
+                while (heap.empty())
+                {
+                    if (wait_until(lock, deadline) == std::cv_status::timeout)
+                        return 0;
+                }
+
+                auto const now = std::chrono::steady_clock::now();
+                std::size_t taken = 0;
+                while (taken < max and not heap.empty() and ready(heap.top(), now))
+                {
+                    *out = heap.pop();
+                    ++out;
+                    ++taken;
+                }
+                if (taken > 0 or max == 0)
+                    return taken;
+
+                auto wake = deadline;
+                if constexpr (detail::has_scheduled_time<T>)
+                    wake = std::min(deadline, detail::scheduled_time_of(heap.top()));
+                if (wait_until(lock, wake) == std::cv_status::timeout && wake == deadline)
+                    return 0;
+            }
+        }
+
+        // False when the entry was already dequeued or cancelled.
+        auto erase(handle h) noexcept -> bool
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return heap.erase(h).has_value();
+        }
+
+        [[nodiscard]] auto contains(handle h) const noexcept -> bool
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return heap.contains(h);
+        }
+
+        template <class Clock, class Duration>
+        auto reschedule(handle h, std::chrono::time_point<Clock, Duration> when) noexcept -> bool
+            requires detail::has_scheduled_time<T>
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto const moved = heap.update(h, [&](T& entry) { detail::scheduled_time_ref(entry) = when; });
+            if (moved)
+                condition.notify_all();
+            return moved;
+        }
+
+        // Scheduled time of a queued entry, std::nullopt once it left the queue.
+        [[nodiscard]] auto scheduled_time(handle h) const noexcept
+            requires detail::has_scheduled_time<T>
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            using time_type = std::remove_cvref_t<decltype(detail::scheduled_time_of(std::declval<T const&>()))>;
+            auto const* entry = heap.get(h);
+            return entry ? std::optional<time_type>{detail::scheduled_time_of(*entry)} : std::nullopt;
+        }
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return heap.size();
         }
 
         template <class Rep, class Period>
@@ -66,22 +178,17 @@ namespace cosmos::inline v1
             {
                 while (heap.empty())
                 {
-                    if (condition.wait_until(lock, deadline) == std::cv_status::timeout)
+                    if (wait_until(lock, deadline) == std::cv_status::timeout)
                         return std::nullopt;
                 }
 
                 auto const now = std::chrono::steady_clock::now();
-                auto const& next_item = heap.front();
+                auto const& next_item = heap.top();
                 if (detail::scheduled_time_of(next_item) <= now)
-                {
-                    std::pop_heap(heap.begin(), heap.end(), compare);
-                    auto val = std::move(heap.back());
-                    heap.pop_back();
-                    return {std::move(val)};
-                }
+                    return {heap.pop()};
 
                 auto const wake = std::min(deadline, detail::scheduled_time_of(next_item));
-                if (condition.wait_until(lock, wake) == std::cv_status::timeout && wake == deadline)
+                if (wait_until(lock, wake) == std::cv_status::timeout && wake == deadline)
                     return std::nullopt;
             }
         }
@@ -94,19 +201,41 @@ namespace cosmos::inline v1
             std::unique_lock<std::mutex> lock(mutex);
             while (heap.empty())
             {
-                if (condition.wait_until(lock, deadline) == std::cv_status::timeout)
+                if (wait_until(lock, deadline) == std::cv_status::timeout)
                     return std::nullopt;
             }
 
-            std::pop_heap(heap.begin(), heap.end(), compare);
-            auto val = std::move(heap.back());
-            heap.pop_back();
-            return {std::move(val)};
+            return {heap.pop()};
         }
 
     private:
-        std::vector<T> heap{};
-        [[no_unique_address]] Compare compare{};
+        [[nodiscard]] static auto ready(T const& entry, std::chrono::steady_clock::time_point now) noexcept -> bool
+        {
+            if constexpr (detail::has_scheduled_time<T>)
+                return detail::scheduled_time_of(entry) <= now;
+            else
+                return true;
+        }
+
+        // Waits that keep `waiting` current, so bulk enqueues know how many consumers to wake.
+        auto wait(std::unique_lock<std::mutex>& lock) -> void
+        {
+            ++waiting;
+            condition.wait(lock);
+            --waiting;
+        }
+
+        template <class Clock, class Duration>
+        auto wait_until(std::unique_lock<std::mutex>& lock, std::chrono::time_point<Clock, Duration> const& until) -> std::cv_status
+        {
+            ++waiting;
+            auto const status = condition.wait_until(lock, until);
+            --waiting;
+            return status;
+        }
+
+        indexed_heap<T, Compare> heap{};
+        std::size_t waiting{0};
         mutable std::mutex mutex{};
         std::condition_variable condition{};
     };
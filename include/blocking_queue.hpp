@@ -5,55 +5,195 @@
 #ifndef BLOCKING_QUEUE_HPP
 #define BLOCKING_QUEUE_HPP
 
+#include "event_count.hpp"
+#include "mpmc_queue.hpp"
+
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
+#include <cstddef>
+#include <iterator>
 #include <optional>
-#include <mutex>
-#include <queue>
+#include <ranges>
 
 namespace cosmos::inline v1
 {
+    /**
+     * @brief bounded MPMC queue: a lock-free mpmc_queue ring, with eventcounts to park consumers
+     * while it is empty and producers while it is full. Nothing is locked when there is no one to
+     * wake.
+     */
     template <class T>
     class blocking_queue
     {
     public:
+        static constexpr std::size_t default_capacity = 1024;
+
+        explicit blocking_queue(std::size_t capacity = default_capacity) : ring{capacity} {}
+
+        // Blocks while the queue is full.
         constexpr auto enqueue(T&& t) noexcept -> void
         {
-            std::lock_guard<std::mutex> lock(m);
-            q.push(std::forward<T>(t));
-            c.notify_one();
+            while (not ring.try_enqueue(std::move(t)))
+            {
+                auto const key = not_full.prepare_wait();
+                if (ring.try_enqueue(std::move(t)))
+                {
+                    not_full.cancel_wait();
+                    break;
+                }
+                not_full.commit_wait(key);
+            }
+            not_empty.notify_one();
+        }
+
+        /**
+         * @brief moves every element of `range` in, claiming runs of cells with one CAS and waking
+         * one consumer per element enqueued. Blocks while the queue is full.
+         */
+        template <std::ranges::forward_range Range>
+            requires detail::nothrow_bulk_source<T, std::ranges::iterator_t<Range>>
+        auto enqueue_bulk(Range&& range) -> void
+        {
+            auto first = std::ranges::begin(range);
+            auto remaining = static_cast<std::size_t>(std::ranges::distance(range));
+            while (remaining > 0)
+            {
+                auto taken = ring.try_enqueue_bulk(first, remaining);
+                if (taken == 0)
+                {
+                    auto const key = not_full.prepare_wait();
+                    taken = ring.try_enqueue_bulk(first, remaining);
+                    if (taken == 0)
+                    {
+                        not_full.commit_wait(key);
+                        continue;
+                    }
+                    not_full.cancel_wait();
+                }
+                std::ranges::advance(first, static_cast<std::ranges::range_difference_t<Range>>(taken));
+                remaining -= taken;
+                not_empty.notify_n(taken);
+            }
+        }
+
+        [[nodiscard]] constexpr auto try_enqueue(T&& t) noexcept -> bool
+        {
+            if (not ring.try_enqueue(std::move(t)))
+                return false;
+            not_empty.notify_one();
+            return true;
         }
 
         [[nodiscard]] constexpr auto dequeue() noexcept -> T
         {
-            std::unique_lock<std::mutex> lock(m);
-            while(q.empty()) c.wait(lock);
-            T val = std::move(q.front());
-            q.pop();
-            return val;
+            while (true)
+            {
+                if (auto val = try_dequeue())
+                    return std::move(*val);
+
+                auto const key = not_empty.prepare_wait();
+                if (auto val = try_dequeue())
+                {
+                    not_empty.cancel_wait();
+                    return std::move(*val);
+                }
+                not_empty.commit_wait(key);
+            }
         }
 
+        // Returns early (std::nullopt) once the queue is closed and drained.
         template <class Rep, class Period>
         [[nodiscard]] constexpr auto dequeue_wait(const std::chrono::duration<Rep, Period>& timeout) noexcept -> std::optional<T>
         {
-            std::unique_lock<std::mutex> lock(m);
-            while(q.empty())
+            auto const deadline = std::chrono::steady_clock::now() + timeout;
+            while (true)
             {
-                auto value = c.wait_for(lock, timeout);
-                if (value == std::cv_status::timeout)
+                if (auto val = try_dequeue())
+                    return val;
+
+                auto const key = not_empty.prepare_wait();
+                if (auto val = try_dequeue())
                 {
-                    return std::nullopt; // Timeout reached
+                    not_empty.cancel_wait();
+                    return val;
                 }
+                if (closed.load(std::memory_order_acquire))
+                {
+                    not_empty.cancel_wait();
+                    return std::nullopt;
+                }
+                if (not not_empty.commit_wait_until(key, deadline))
+                    return try_dequeue(); // Timeout reached
+            }
+        }
+
+        /**
+         * @brief waits up to `timeout` for the queue to become non-empty, then moves up to `max`
+         * elements into `out`. Returns how many were written, 0 on timeout or once closed and drained.
+         */
+        template <std::output_iterator<T> Output, class Rep, class Period>
+        [[nodiscard]] auto dequeue_bulk(Output out, std::size_t max, const std::chrono::duration<Rep, Period>& timeout)
+            noexcept(detail::nothrow_bulk_sink<T, Output>) -> std::size_t
+        {
+            auto const deadline = std::chrono::steady_clock::now() + timeout;
+            while (max > 0)
+            {
+                if (auto const taken = try_dequeue_bulk(out, max); taken > 0)
+                    return taken;
+
+                auto const key = not_empty.prepare_wait();
+                if (auto const taken = try_dequeue_bulk(out, max); taken > 0)
+                {
+                    not_empty.cancel_wait();
+                    return taken;
+                }
+                if (closed.load(std::memory_order_acquire))
+                {
+                    not_empty.cancel_wait();
+                    return 0;
+                }
+                if (not not_empty.commit_wait_until(key, deadline))
+                    return try_dequeue_bulk(out, max);
             }
-            T val = std::move(q.front());
-            q.pop();
-            return { val };
+            return 0;
         }
 
+        [[nodiscard]] constexpr auto try_dequeue() noexcept -> std::optional<T>
+        {
+            auto val = ring.try_dequeue();
+            if (val)
+                not_full.notify_one();
+            return val;
+        }
+
+        // Moves up to `max` queued elements to `out` without waiting; returns how many were taken.
+        template <std::output_iterator<T> Output>
+        [[nodiscard]] auto try_dequeue_bulk(Output out, std::size_t max) noexcept(detail::nothrow_bulk_sink<T, Output>)
+            -> std::size_t
+        {
+            auto const taken = ring.try_dequeue_bulk(out, max);
+            not_full.notify_n(taken);
+            return taken;
+        }
+
+        /**
+         * @brief wakes every waiting consumer, dequeue_wait stops waiting from now on. Elements that
+         * are still queued can be drained.
+         */
+        auto close() noexcept -> void
+        {
+            closed.store(true, std::memory_order_release);
+            not_empty.notify_all();
+        }
+
+        [[nodiscard]] auto capacity() const noexcept -> std::size_t { return ring.capacity(); }
+        [[nodiscard]] auto size_approx() const noexcept -> std::size_t { return ring.size_approx(); }
+
     private:
-        std::queue<T> q{};
-        mutable std::mutex m{};
-        std::condition_variable c{};
+        mpmc_queue<T> ring;
+        event_count not_empty{};
+        event_count not_full{};
+        std::atomic_bool closed{false};
     };
 
 } // namespace cosmos
@@ -27,6 +27,17 @@ namespace cosmos::inline v1
         unsigned max_dag_concurrency{ 2 };
         unsigned max_task_concurrency{ 4 };
         unsigned execution_idle_ms{ 500 };
+        unsigned python_workers{ 2 };
+        unsigned python_worker_recycle{ 100 };
+        std::string task_cgroup{};
+        std::uint64_t task_memory_limit_mb{ 0 };
+        double task_cpu_limit{ 0.0 };
+        unsigned catch_up_parallelism{ 0 };
+        unsigned schedule_spread_ms{ 0 };
+        double scheduled_starts_per_second{ 0.0 };
+        unsigned scheduled_start_burst{ 1 };
+        unsigned run_history_days{ 30 };
+        bool disk_scripts{ false };
         bool interactive {true};
     };
 
@@ -51,6 +62,39 @@ namespace cosmos::inline v1
         app.add_option("--execution-idle-ms", defaults.execution_idle_ms,
             fmt::format("Executioner idle shutdown milliseconds (default: {})", defaults.execution_idle_ms));
 
+        app.add_option("--python-workers", defaults.python_workers,
+            fmt::format("Pre-forked python interpreters, 0 starts a fresh one per task (default: {})", defaults.python_workers));
+
+        app.add_option("--python-worker-recycle", defaults.python_worker_recycle,
+            fmt::format("Python tasks per interpreter before it is replaced, 0 never (default: {})", defaults.python_worker_recycle));
+
+        app.add_option("--task-cgroup", defaults.task_cgroup,
+            "Delegated cgroup v2 directory to run each task in its own cgroup (default: none)");
+
+        app.add_option("--task-memory-limit-mb", defaults.task_memory_limit_mb,
+            fmt::format("Per-task memory.max in MiB with --task-cgroup, 0 unlimited (default: {})", defaults.task_memory_limit_mb));
+
+        app.add_option("--task-cpu-limit", defaults.task_cpu_limit,
+            fmt::format("Per-task CPU cores (cpu.max) with --task-cgroup, 0 unlimited (default: {})", defaults.task_cpu_limit));
+
+        app.add_option("--catch-up", defaults.catch_up_parallelism,
+            fmt::format("Backfill cron fires missed while down, this many runs per DAG at a time, 0 off (default: {})", defaults.catch_up_parallelism));
+
+        app.add_option("--schedule-spread-ms", defaults.schedule_spread_ms,
+            fmt::format("Start each scheduled DAG up to this long after its cron time, at a fixed per-DAG offset (default: {})", defaults.schedule_spread_ms));
+
+        app.add_option("--scheduled-starts-per-second", defaults.scheduled_starts_per_second,
+            fmt::format("Cap on scheduled run starts per second, 0 unlimited (default: {})", defaults.scheduled_starts_per_second));
+
+        app.add_option("--scheduled-start-burst", defaults.scheduled_start_burst,
+            fmt::format("Scheduled runs that may start back to back under the cap (default: {})", defaults.scheduled_start_burst));
+
+        app.add_option("--run-history-days", defaults.run_history_days,
+            fmt::format("Days of run history to keep, older segments are dropped hourly, 0 keeps all (default: {})", defaults.run_history_days));
+
+        app.add_flag("--disk-scripts", defaults.disk_scripts,
+            "Run task scripts from the on-disk script cache instead of sealed in-memory files");
+
         app.add_flag("-i,--interactive", defaults.interactive,
             fmt::format("Use interactive TUI (default: {})", defaults.max_task_graphs));
     }
@@ -0,0 +1,150 @@
+// Eventcount: lets lock-free structures block their consumers without a mutex on the fast path
+#pragma once
+#ifndef EVENT_COUNT_HPP
+#define EVENT_COUNT_HPP
+
+// *** Standard Includes ***
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace cosmos::inline v1
+{
+    namespace detail
+    {
+        static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+#if defined(__linux__)
+        // Blocks while `*word == expected`, until woken or `timeout` (relative, CLOCK_MONOTONIC) elapses.
+        inline auto futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected, timespec const* timeout) noexcept -> void
+        {
+            (void) ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+        }
+
+        inline auto futex_wake(std::atomic<std::uint32_t>& word, int count) noexcept -> void
+        {
+            (void) ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+        }
+#endif
+    } // namespace detail
+
+    /**
+     * @brief condition variable for lock-free code. A waiter announces itself with prepare_wait(),
+     * re-checks its condition and then either cancel_wait()s or commit_wait()s; a notifier changes
+     * the state first and then calls notify_*. Notifying costs a fence and a load while nobody waits,
+     * a futex wake otherwise.
+     *
+     *     if (auto v = q.try_pop()) return v;
+     *     auto const key = ec.prepare_wait();
+     *     if (auto v = q.try_pop()) { ec.cancel_wait(); return v; }
+     *     ec.commit_wait(key);
+     */
+    class event_count
+    {
+    public:
+        using key_type = std::uint32_t;
+
+        event_count() = default;
+        event_count(event_count const&) = delete;
+        event_count& operator=(event_count const&) = delete;
+
+        [[nodiscard]] auto prepare_wait() noexcept -> key_type
+        {
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            return epoch.load(std::memory_order_seq_cst);
+        }
+
+        auto cancel_wait() noexcept -> void
+        {
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        auto commit_wait(key_type key) noexcept -> void
+        {
+            while (epoch.load(std::memory_order_acquire) == key)
+            {
+#if defined(__linux__)
+                detail::futex_wait(epoch, key, nullptr);
+#else
+                epoch.wait(key, std::memory_order_acquire);
+#endif
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief commit_wait with a deadline, false when it passed without a notification.
+         */
+        template <class Clock, class Duration>
+        [[nodiscard]] auto commit_wait_until(key_type key, std::chrono::time_point<Clock, Duration> const& deadline) noexcept -> bool
+        {
+            auto notified = true;
+            while (epoch.load(std::memory_order_acquire) == key)
+            {
+                auto const remaining = deadline - Clock::now();
+                if (remaining <= Duration::zero())
+                {
+                    notified = false;
+                    break;
+                }
+#if defined(__linux__)
+                auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+                timespec const timeout{.tv_sec = static_cast<std::time_t>(ns / 1'000'000'000),
+                                       .tv_nsec = static_cast<long>(ns % 1'000'000'000)};
+                detail::futex_wait(epoch, key, &timeout);
+#else
+                // std::atomic::wait has no timed variant, fall back to short sleeps.
+                std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(remaining, std::chrono::microseconds{200}));
+#endif
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return notified;
+        }
+
+        auto notify_one() noexcept -> void { notify(1); }
+        auto notify_all() noexcept -> void { notify(INT_MAX); }
+        // Wakes up to `count` waiters, e.g. one per element of a bulk push.
+        auto notify_n(std::size_t count) noexcept -> void
+        {
+            if (count > 0)
+                notify(count >= INT_MAX ? INT_MAX : static_cast<int>(count));
+        }
+
+    private:
+        auto notify(int count) noexcept -> void
+        {
+            // Pairs with the seq_cst increment in prepare_wait: either the waiter sees the new state
+            // on its re-check, or we see the waiter here.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load(std::memory_order_relaxed) == 0)
+                return;
+
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+#if defined(__linux__)
+            detail::futex_wake(epoch, count);
+#else
+            if (count == 1)
+                epoch.notify_one();
+            else
+                epoch.notify_all();
+#endif
+        }
+
+        std::atomic<std::uint32_t> epoch{0};
+        std::atomic<std::uint32_t> waiters{0};
+    };
+
+} // namespace cosmos::inline v1
+
+#endif // EVENT_COUNT_HPP
@@ -17,6 +17,7 @@ namespace cosmos::inline v1
     template <typename T, typename Compare> class blocking_priority_queue;
     class fs_storage;
     class concurrent_shyguy;
+    class interpreter_pool;
     struct task_request;
     using task_request_ptr = std::shared_ptr<task_request>;
     struct task_request_ptr_compare;
@@ -26,6 +27,7 @@ namespace cosmos::inline v1
     using input_queue_t    = std::shared_ptr<blocking_queue<shyguy_request>>;
     using data_storage     = std::shared_ptr<fs_storage>;
     using concurrent_shyguy_t = std::shared_ptr<concurrent_shyguy>;
+    using interpreter_pool_t  = std::shared_ptr<interpreter_pool>;
 
     // Helper functions
     constexpr auto if_it_exists = [](auto const& entry)
@@ -122,6 +122,39 @@ namespace cosmos::inline v1
             return { iter };
         }
 
+        /**
+         * @brief inserts every (name, dependencies) pair, then validates once: no duplicates, every
+         * dependency known, no cycle. push_task re-checks the whole graph on each insert, which is
+         * quadratic when loading a large DAG. On failure the graph is left as it was.
+         */
+        template <std::ranges::input_range Tasks>
+        auto push_tasks(Tasks&& tasks) -> std::expected<std::size_t, graph_error>
+        {
+            std::vector<name_str> inserted{};
+            auto const roll_back = [&](graph_error error) -> std::expected<std::size_t, graph_error>
+            {
+                for (auto const& name : inserted)
+                    adjacency_list.erase(name);
+                return std::unexpected(error);
+            };
+
+            for (auto&& [name, depends] : tasks)
+            {
+                if (not adjacency_list.emplace(name, depends).second)
+                    return roll_back(graph_error::contains_duplicates);
+                inserted.push_back(name);
+            }
+
+            for (auto const& name : inserted)
+                for (auto const& dependency : adjacency_list.at(name))
+                    if (not contains(dependency))
+                        return roll_back(graph_error::dependencies_not_found);
+
+            if (has_cycle())
+                return roll_back(graph_error::task_creates_cycle);
+            return inserted.size();
+        }
+
         inline auto remove_task (name_str const& task_name) -> std::expected<std::monostate, graph_error>
         {
             auto const task = adjacency_list.find(task_name);
@@ -0,0 +1,276 @@
+// d-ary heap that hands out stable handles so queued entries can be erased or re-prioritized
+#pragma once
+#ifndef INDEXED_HEAP_HPP
+#define INDEXED_HEAP_HPP
+
+// *** Standard Includes ***
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief names one entry of an indexed_heap. The generation makes a handle to an entry that was
+     * popped or erased stale instead of silently pointing at whatever reuses its slot.
+     */
+    struct heap_handle
+    {
+        std::uint32_t slot{UINT32_MAX};
+        std::uint32_t generation{0};
+
+        [[nodiscard]] constexpr auto valid() const noexcept -> bool { return slot != UINT32_MAX; }
+        friend constexpr auto operator==(heap_handle, heap_handle) noexcept -> bool = default;
+    };
+
+    /**
+     * @brief priority queue with the same ordering as std::priority_queue<T, std::vector<T>, Compare>
+     * (top() is the element no other compares greater than), plus O(log n) erase(handle) and
+     * update(handle, ...). Four children per node keep it shallow and make sift-down touch one
+     * cache line of siblings per level.
+     */
+    template <class T, class Compare = std::less<T>, std::size_t Arity = 4>
+    class indexed_heap
+    {
+        static_assert(Arity >= 2);
+
+    public:
+        using handle = heap_handle;
+
+        indexed_heap() = default;
+        explicit indexed_heap(Compare compare_in) : compare{std::move(compare_in)} {}
+
+        [[nodiscard]] auto empty() const noexcept -> bool { return nodes.empty(); }
+        [[nodiscard]] auto size() const noexcept -> std::size_t { return nodes.size(); }
+
+        auto push(T value) -> handle
+        {
+            auto const slot = acquire_slot();
+            nodes.push_back(node{std::move(value), slot});
+            slots[slot].position = nodes.size() - 1;
+            sift_up(nodes.size() - 1);
+            return {slot, slots[slot].generation};
+        }
+
+        /**
+         * @brief moves every element of `range` in. A batch at least as large as the heap is heapified
+         * bottom-up in O(n) instead of sifting each element up.
+         */
+        template <std::ranges::input_range Range>
+        auto push_bulk(Range&& range) -> std::vector<handle>
+        {
+            auto const old_size = nodes.size();
+            std::vector<handle> handles{};
+            if constexpr (std::ranges::sized_range<Range>)
+            {
+                handles.reserve(std::ranges::size(range));
+                nodes.reserve(old_size + std::ranges::size(range));
+            }
+            for (auto it = std::ranges::begin(range); it != std::ranges::end(range); ++it)
+            {
+                auto const slot = acquire_slot();
+                nodes.push_back(node{std::ranges::iter_move(it), slot});
+                slots[slot].position = nodes.size() - 1;
+                handles.push_back({slot, slots[slot].generation});
+            }
+
+            auto const added = nodes.size() - old_size;
+            if (added >= old_size and nodes.size() > 1)
+            {
+                for (auto parent = (nodes.size() - 2) / Arity + 1; parent-- > 0;)
+                    sift_down(parent);
+            }
+            else
+            {
+                for (auto position = old_size; position < nodes.size(); ++position)
+                    sift_up(position);
+            }
+            return handles;
+        }
+
+        [[nodiscard]] auto top() const noexcept -> T const& { return nodes.front().value; }
+        [[nodiscard]] auto top_handle() const noexcept -> handle
+        {
+            auto const slot = nodes.front().slot;
+            return {slot, slots[slot].generation};
+        }
+
+        auto pop() -> T { return remove_at(0); }
+
+        /**
+         * @brief calls `visit` on every entry for which `keep` holds and also holds for all its
+         * ancestors, without popping anything. With a `keep` that is monotonic in the heap order
+         * (e.g. "ties with top()") that is exactly the matching prefix, found in O(matches * Arity).
+         */
+        template <class Keep, class Visit>
+        auto visit_top(Keep&& keep, Visit&& visit) const -> void
+        {
+            if (nodes.empty() or not keep(nodes.front().value))
+                return;
+            std::vector<std::size_t> pending{0};
+            while (not pending.empty())
+            {
+                auto const position = pending.back();
+                pending.pop_back();
+                visit(nodes[position].value);
+
+                auto const first = position * Arity + 1;
+                for (auto child = first; child < std::min(first + Arity, nodes.size()); ++child)
+                    if (keep(nodes[child].value))
+                        pending.push_back(child);
+            }
+        }
+
+        [[nodiscard]] auto contains(handle h) const noexcept -> bool
+        {
+            return h.slot < slots.size() and slots[h.slot].generation == h.generation and slots[h.slot].position != npos;
+        }
+
+        [[nodiscard]] auto get(handle h) const noexcept -> T const* { return contains(h) ? &nodes[slots[h.slot].position].value : nullptr; }
+
+        // std::nullopt when the entry already left the heap.
+        auto erase(handle h) -> std::optional<T>
+        {
+            if (not contains(h))
+                return std::nullopt;
+            return remove_at(slots[h.slot].position);
+        }
+
+        /**
+         * @brief lets `mutate` change the entry in place and restores the heap order around it.
+         */
+        template <class Mutate>
+        auto update(handle h, Mutate&& mutate) -> bool
+        {
+            if (not contains(h))
+                return false;
+            auto const position = slots[h.slot].position;
+            std::forward<Mutate>(mutate)(nodes[position].value);
+            restore(position);
+            return true;
+        }
+
+        auto clear() -> void
+        {
+            for (auto const& n: nodes)
+                release_slot(n.slot);
+            nodes.clear();
+        }
+
+    private:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        struct node
+        {
+            T value;
+            std::uint32_t slot;
+        };
+
+        struct slot_entry
+        {
+            std::size_t position{npos};
+            std::uint32_t generation{0};
+        };
+
+        // True when `a` belongs above `b`.
+        [[nodiscard]] auto before(T const& a, T const& b) const -> bool { return compare(b, a); }
+
+        auto acquire_slot() -> std::uint32_t
+        {
+            if (not free_slots.empty())
+            {
+                auto const slot = free_slots.back();
+                free_slots.pop_back();
+                return slot;
+            }
+            slots.emplace_back();
+            return static_cast<std::uint32_t>(slots.size() - 1);
+        }
+
+        auto release_slot(std::uint32_t slot) -> void
+        {
+            slots[slot].position = npos;
+            ++slots[slot].generation;
+            free_slots.push_back(slot);
+        }
+
+        auto place(std::size_t position, node&& n) -> void
+        {
+            slots[n.slot].position = position;
+            nodes[position] = std::move(n);
+        }
+
+        auto remove_at(std::size_t position) -> T
+        {
+            auto removed = std::move(nodes[position]);
+            release_slot(removed.slot);
+
+            auto last = std::move(nodes.back());
+            nodes.pop_back();
+            if (position < nodes.size())
+            {
+                place(position, std::move(last));
+                restore(position);
+            }
+            return std::move(removed.value);
+        }
+
+        auto restore(std::size_t position) -> void
+        {
+            if (position > 0 and before(nodes[position].value, nodes[(position - 1) / Arity].value))
+                sift_up(position);
+            else
+                sift_down(position);
+        }
+
+        auto sift_up(std::size_t position) -> void
+        {
+            auto moving = std::move(nodes[position]);
+            while (position > 0)
+            {
+                auto const parent = (position - 1) / Arity;
+                if (not before(moving.value, nodes[parent].value))
+                    break;
+                place(position, std::move(nodes[parent]));
+                position = parent;
+            }
+            place(position, std::move(moving));
+        }
+
+        auto sift_down(std::size_t position) -> void
+        {
+            auto moving = std::move(nodes[position]);
+            while (true)
+            {
+                auto const first = position * Arity + 1;
+                if (first >= nodes.size())
+                    break;
+
+                auto best = first;
+                auto const last = std::min(first + Arity, nodes.size());
+                for (auto child = first + 1; child < last; ++child)
+                    if (before(nodes[child].value, nodes[best].value))
+                        best = child;
+
+                if (not before(nodes[best].value, moving.value))
+                    break;
+                place(position, std::move(nodes[best]));
+                position = best;
+            }
+            place(position, std::move(moving));
+        }
+
+        std::vector<node> nodes{};
+        std::vector<slot_entry> slots{};
+        std::vector<std::uint32_t> free_slots{};
+        [[no_unique_address]] Compare compare{};
+    };
+
+} // namespace cosmos::inline v1
+
+#endif // INDEXED_HEAP_HPP
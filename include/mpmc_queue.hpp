@@ -0,0 +1,247 @@
+// Bounded lock-free multi-producer/multi-consumer ring (Dmitry Vyukov's sequence-number design)
+#pragma once
+#ifndef MPMC_QUEUE_HPP
+#define MPMC_QUEUE_HPP
+
+// *** Standard Includes ***
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace cosmos::inline v1
+{
+    namespace detail
+    {
+        // Kept fixed rather than std::hardware_destructive_interference_size, which varies with -mtune.
+        inline constexpr std::size_t cache_line_size = 64;
+
+        // A bulk transfer claims a run of cells before touching any element, so it may only do that
+        // when reading from the source or writing to the sink cannot throw halfway through the run.
+        template <class T, class Iterator>
+        inline constexpr bool nothrow_bulk_source =
+            noexcept(T(std::move(*std::declval<Iterator&>()))) and noexcept(++std::declval<Iterator&>());
+
+        template <class T, class Output>
+        inline constexpr bool nothrow_bulk_sink =
+            noexcept(*std::declval<Output&>() = std::declval<T&&>()) and noexcept(++std::declval<Output&>());
+    } // namespace detail
+
+    /**
+     * @brief fixed capacity ring (rounded up to a power of two). Every cell carries a sequence
+     * number that tells producers and consumers whether it is free for the current lap, so a push or
+     * pop is one CAS on the shared index plus one release store on the cell; no operation waits on
+     * another thread holding a lock. try_* return immediately when the ring is full or empty.
+     */
+    template <class T>
+    class mpmc_queue
+    {
+        static_assert(std::is_nothrow_move_constructible_v<T>, "a claimed cell must always be filled");
+
+    public:
+        explicit mpmc_queue(std::size_t capacity)
+            : mask{std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1}, cells{std::make_unique<cell[]>(mask + 1)}
+        {
+            for (std::size_t i = 0; i <= mask; ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        mpmc_queue(mpmc_queue const&) = delete;
+        mpmc_queue& operator=(mpmc_queue const&) = delete;
+
+        ~mpmc_queue()
+        {
+            while (try_dequeue())
+                ;
+        }
+
+        // Leaves `t` untouched when the ring is full.
+        [[nodiscard]] auto try_enqueue(T&& t) noexcept -> bool
+        {
+            auto position = enqueue_position.load(std::memory_order_relaxed);
+            cell* target = nullptr;
+            while (true)
+            {
+                target = &cells[position & mask];
+                auto const sequence = target->sequence.load(std::memory_order_acquire);
+                auto const lap = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+                if (lap == 0)
+                {
+                    if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (lap < 0)
+                    return false; // the consumer of the previous lap has not emptied this cell yet
+                else
+                    position = enqueue_position.load(std::memory_order_relaxed);
+            }
+
+            ::new (static_cast<void*>(target->storage)) T(std::move(t));
+            target->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] auto try_dequeue() noexcept -> std::optional<T>
+        {
+            auto position = dequeue_position.load(std::memory_order_relaxed);
+            cell* source = nullptr;
+            while (true)
+            {
+                source = &cells[position & mask];
+                auto const sequence = source->sequence.load(std::memory_order_acquire);
+                auto const lap = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+                if (lap == 0)
+                {
+                    if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (lap < 0)
+                    return std::nullopt; // nothing published in this cell yet
+                else
+                    position = dequeue_position.load(std::memory_order_relaxed);
+            }
+
+            auto* value = std::launder(reinterpret_cast<T*>(source->storage));
+            std::optional<T> result{std::move(*value)};
+            value->~T();
+            // Hand the cell to the producer of the next lap.
+            source->sequence.store(position + mask + 1, std::memory_order_release);
+            return result;
+        }
+
+        /**
+         * @brief moves up to `count` elements from `first` into consecutive cells claimed with a
+         * single CAS. Returns how many were taken (a prefix of the input, 0 when full). The source
+         * must not throw, since a claimed cell cannot be handed back.
+         */
+        template <std::input_iterator Iterator>
+            requires detail::nothrow_bulk_source<T, Iterator>
+        [[nodiscard]] auto try_enqueue_bulk(Iterator first, std::size_t count) noexcept -> std::size_t
+        {
+            auto position = enqueue_position.load(std::memory_order_relaxed);
+            std::size_t claimed = 0;
+            while (true)
+            {
+                // Cells stay free for this lap until somebody moves enqueue_position past them.
+                claimed = 0;
+                while (claimed < count and claimed <= mask)
+                {
+                    auto const sequence = cells[(position + claimed) & mask].sequence.load(std::memory_order_acquire);
+                    if (sequence != position + claimed)
+                        break;
+                    ++claimed;
+                }
+                if (claimed == 0)
+                {
+                    auto const sequence = cells[position & mask].sequence.load(std::memory_order_acquire);
+                    if (static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position) < 0)
+                        return 0;
+                    position = enqueue_position.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (enqueue_position.compare_exchange_weak(position, position + claimed, std::memory_order_relaxed))
+                    break;
+            }
+
+            for (std::size_t i = 0; i < claimed; ++i, ++first)
+            {
+                auto &target = cells[(position + i) & mask];
+                ::new (static_cast<void*>(target.storage)) T(std::move(*first));
+                target.sequence.store(position + i + 1, std::memory_order_release);
+            }
+            return claimed;
+        }
+
+        /**
+         * @brief moves up to `max` published elements into `out`, claiming them with a single CAS. An
+         * output iterator that may throw is fed one element at a time instead.
+         */
+        template <std::output_iterator<T> Output>
+        [[nodiscard]] auto try_dequeue_bulk(Output out, std::size_t max) noexcept(detail::nothrow_bulk_sink<T, Output>)
+            -> std::size_t
+        {
+            if constexpr (not detail::nothrow_bulk_sink<T, Output>)
+            {
+                std::size_t taken = 0;
+                for (; taken < max; ++taken)
+                {
+                    auto value = try_dequeue();
+                    if (not value)
+                        break;
+                    *out = std::move(*value);
+                    ++out;
+                }
+                return taken;
+            }
+
+            auto position = dequeue_position.load(std::memory_order_relaxed);
+            std::size_t claimed = 0;
+            while (true)
+            {
+                claimed = 0;
+                while (claimed < max and claimed <= mask)
+                {
+                    auto const sequence = cells[(position + claimed) & mask].sequence.load(std::memory_order_acquire);
+                    if (sequence != position + claimed + 1)
+                        break;
+                    ++claimed;
+                }
+                if (claimed == 0)
+                {
+                    auto const sequence = cells[position & mask].sequence.load(std::memory_order_acquire);
+                    if (static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1) < 0)
+                        return 0;
+                    position = dequeue_position.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (dequeue_position.compare_exchange_weak(position, position + claimed, std::memory_order_relaxed))
+                    break;
+            }
+
+            for (std::size_t i = 0; i < claimed; ++i)
+            {
+                auto &source = cells[(position + i) & mask];
+                auto* value = std::launder(reinterpret_cast<T*>(source.storage));
+                *out = std::move(*value);
+                ++out;
+                value->~T();
+                source.sequence.store(position + i + mask + 1, std::memory_order_release);
+            }
+            return claimed;
+        }
+
+        [[nodiscard]] auto capacity() const noexcept -> std::size_t { return mask + 1; }
+
+        // Only a snapshot, other threads may change it before the caller looks at it.
+        [[nodiscard]] auto size_approx() const noexcept -> std::size_t
+        {
+            auto const tail = dequeue_position.load(std::memory_order_relaxed);
+            auto const head = enqueue_position.load(std::memory_order_relaxed);
+            return head > tail ? head - tail : 0;
+        }
+
+        [[nodiscard]] auto empty_approx() const noexcept -> bool { return size_approx() == 0; }
+
+    private:
+        struct cell
+        {
+            std::atomic<std::size_t> sequence{};
+            alignas(T) std::byte storage[sizeof(T)];
+        };
+
+        std::size_t const mask;
+        std::unique_ptr<cell[]> const cells;
+        // Producers and consumers each hammer their own index, keep them off each other's cache line.
+        alignas(detail::cache_line_size) std::atomic<std::size_t> enqueue_position{0};
+        alignas(detail::cache_line_size) std::atomic<std::size_t> dequeue_position{0};
+    };
+
+} // namespace cosmos::inline v1
+
+#endif // MPMC_QUEUE_HPP
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "small_function.hpp"
+
 #include <expected>
 #include <functional>
 #include <nlohmann/json.hpp>
@@ -204,6 +206,8 @@ namespace cosmos::inline v1
         }
 
         command_enum command{};
+        // Retries of one execute carry the same key and get the run the first one queued.
+        std::optional<std::string> idempotency_key{};
     };
 
     inline command_enum to_command_enum(std::string const &str)
@@ -279,11 +283,13 @@ namespace cosmos::inline v1
     public:
         std::chrono::steady_clock::time_point start;
         std::chrono::steady_clock::time_point end;
-        std::function<auto()->void> task_function;
+        // Move-only: task closures own per-run state (launch options, log paths) and are never copied.
+        small_function<auto()->void> task_function;
         command_result_type result;
         std::string name{};
-        std::string contents{};
         std::size_t index{};
+        // Cost model estimate (smoothed wall time of earlier runs), 0 when the task never ran.
+        std::chrono::microseconds expected_cost{};
     };
 
     template<class T>
@@ -333,11 +339,15 @@ namespace nlohmann
             j["type"] = cosmos::to_string_view(request_enum);
             j["command"] = cosmos::to_string_view(request.command);
             std::visit([&](auto const &value) { j["value"] = value; }, request.data);
+            if (request.idempotency_key)
+                j["idempotency_key"] = *request.idempotency_key;
         }
 
         static void from_json(json const &j, cosmos::shyguy_request &request)
         {
             request.command = cosmos::to_command_enum(j.value("command", "not-set"));
+            if (auto const key = j.find("idempotency_key"); key != j.end() and key->is_string())
+                request.idempotency_key = key->get<std::string>();
             
             if (j.is_null())
             {
@@ -0,0 +1,164 @@
+// Move-only type-erased callable with a fixed, guaranteed inline buffer
+#pragma once
+#ifndef SMALL_FUNCTION_HPP
+#define SMALL_FUNCTION_HPP
+
+// *** Standard Includes ***
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cosmos::inline v1
+{
+    inline constexpr std::size_t default_small_function_capacity = 64;
+
+    template <class Signature, std::size_t Capacity = default_small_function_capacity>
+    class small_function;
+
+    /**
+     * @brief like std::move_only_function, but every callable of at most `Capacity` bytes (with
+     * fundamental alignment and a noexcept move) is guaranteed to live inside the object, so building,
+     * moving and queueing it never allocates. Larger callables still work and cost one allocation.
+     * Invoking an empty small_function is undefined, test it first.
+     */
+    template <class R, class... Args, std::size_t Capacity>
+    class small_function<R(Args...), Capacity>
+    {
+        static_assert(Capacity >= sizeof(void*), "the buffer must at least hold the out-of-line pointer");
+
+    public:
+        template <class F>
+        static constexpr bool stored_inline = sizeof(F) <= Capacity and alignof(F) <= alignof(std::max_align_t)
+                                              and std::is_nothrow_move_constructible_v<F>;
+
+        small_function() noexcept = default;
+        small_function(std::nullptr_t) noexcept {}
+
+        template <class F>
+            requires (not std::is_same_v<std::remove_cvref_t<F>, small_function>)
+                     and std::is_invocable_r_v<R, std::decay_t<F>&, Args...>
+        small_function(F&& f) // NOLINT(google-explicit-constructor): drop-in for std::function
+        {
+            using callable = std::decay_t<F>;
+            if constexpr (std::is_pointer_v<callable> or std::is_member_pointer_v<callable>)
+            {
+                if (f == nullptr)
+                    return;
+            }
+
+            if constexpr (stored_inline<callable>)
+                ::new (static_cast<void*>(buffer)) callable(std::forward<F>(f));
+            else
+                ::new (static_cast<void*>(buffer)) callable*(new callable(std::forward<F>(f)));
+            operations = &operations_for<callable>;
+        }
+
+        small_function(small_function&& other) noexcept : operations{std::exchange(other.operations, nullptr)}
+        {
+            if (operations)
+                operations->relocate(buffer, other.buffer);
+        }
+
+        small_function& operator=(small_function&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                operations = std::exchange(other.operations, nullptr);
+                if (operations)
+                    operations->relocate(buffer, other.buffer);
+            }
+            return *this;
+        }
+
+        small_function& operator=(std::nullptr_t) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        template <class F>
+            requires (not std::is_same_v<std::remove_cvref_t<F>, small_function>)
+                     and std::is_invocable_r_v<R, std::decay_t<F>&, Args...>
+        small_function& operator=(F&& f)
+        {
+            return *this = small_function{std::forward<F>(f)};
+        }
+
+        small_function(small_function const&) = delete;
+        small_function& operator=(small_function const&) = delete;
+
+        ~small_function() { reset(); }
+
+        explicit operator bool() const noexcept { return operations != nullptr; }
+
+        // False for empty functions and for callables that did not fit the buffer.
+        [[nodiscard]] auto is_inline() const noexcept -> bool { return operations and operations->inline_storage; }
+
+        auto operator()(Args... args) -> R
+        {
+            return operations->invoke(buffer, std::forward<Args>(args)...);
+        }
+
+    private:
+        struct operation_table
+        {
+            R (*invoke)(std::byte*, Args&&...);
+            // Move-constructs into `destination` and destroys `source`.
+            void (*relocate)(std::byte* destination, std::byte* source) noexcept;
+            void (*destroy)(std::byte*) noexcept;
+            bool inline_storage;
+        };
+
+        template <class F>
+        [[nodiscard]] static auto target(std::byte* storage) noexcept -> F&
+        {
+            if constexpr (stored_inline<F>)
+                return *std::launder(reinterpret_cast<F*>(storage));
+            else
+                return **std::launder(reinterpret_cast<F**>(storage));
+        }
+
+        template <class F>
+        static constexpr operation_table operations_for{
+            .invoke = [](std::byte* storage, Args&&... args) -> R
+            {
+                return std::invoke_r<R>(target<F>(storage), std::forward<Args>(args)...);
+            },
+            .relocate = [](std::byte* destination, std::byte* source) noexcept
+            {
+                if constexpr (stored_inline<F>)
+                {
+                    auto& from = target<F>(source);
+                    ::new (static_cast<void*>(destination)) F(std::move(from));
+                    from.~F();
+                }
+                else
+                    ::new (static_cast<void*>(destination)) F*(*std::launder(reinterpret_cast<F**>(source)));
+            },
+            .destroy = [](std::byte* storage) noexcept
+            {
+                if constexpr (stored_inline<F>)
+                    target<F>(storage).~F();
+                else
+                    delete &target<F>(storage);
+            },
+            .inline_storage = stored_inline<F>,
+        };
+
+        auto reset() noexcept -> void
+        {
+            if (operations)
+                std::exchange(operations, nullptr)->destroy(buffer);
+        }
+
+        operation_table const* operations{nullptr};
+        alignas(std::max_align_t) std::byte buffer[Capacity];
+    };
+
+} // namespace cosmos::inline v1
+
+#endif // SMALL_FUNCTION_HPP
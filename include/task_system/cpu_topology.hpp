@@ -0,0 +1,141 @@
+#pragma once
+
+// *** CPU / NUMA topology for worker placement ***
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace jx
+{
+
+// How task_system workers are placed on the machine.
+enum class worker_affinity
+{
+	none,       // let the kernel schedule them
+	cores,      // worker n is pinned to the n-th online CPU (round robin)
+	numa_nodes, // worker n may run on any CPU of the (n mod nodes)-th NUMA node
+};
+
+struct cpu_topology
+{
+	std::vector<unsigned>              cpus{};  // online CPUs
+	std::vector<std::vector<unsigned>> nodes{}; // online CPUs per NUMA node, empty without NUMA info
+};
+
+// Parses the kernel's cpulist format, e.g. "0-3,8,10-11".
+[[nodiscard]] inline auto parse_cpu_list(std::string_view list) -> std::vector<unsigned>
+{
+	std::vector<unsigned> cpus;
+	while (not list.empty())
+    {
+		auto const comma = list.find(',');
+		auto item        = list.substr(0, comma);
+		list             = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+		while (not item.empty() and (item.back() == '\n' or item.back() == ' '))
+            item.remove_suffix(1);
+		if (item.empty())
+            continue;
+
+		auto const dash = item.find('-');
+		unsigned first{ 0 };
+		unsigned last{ 0 };
+		auto const first_text = item.substr(0, dash);
+		if (std::from_chars(first_text.data(), first_text.data() + first_text.size(), first).ec != std::errc{})
+            return {};
+		last = first;
+		if (dash != std::string_view::npos)
+        {
+			auto const last_text = item.substr(dash + 1);
+			if (std::from_chars(last_text.data(), last_text.data() + last_text.size(), last).ec != std::errc{})
+                return {};
+		}
+
+		for (auto cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+	}
+	return cpus;
+}
+
+// Reads /sys/devices/system/{cpu,node}; falls back to 0..hardware_concurrency-1 elsewhere.
+[[nodiscard]] inline auto read_cpu_topology(std::filesystem::path const& sysfs = "/sys/devices/system") -> cpu_topology
+{
+	auto const read_list = [](std::filesystem::path const& path) -> std::optional<std::vector<unsigned>>
+    {
+		std::ifstream is{ path };
+		std::string line;
+		if (not is or not std::getline(is, line))
+            return std::nullopt;
+		return parse_cpu_list(line);
+	};
+
+	cpu_topology topology;
+	if (auto online = read_list(sysfs / "cpu" / "online"); online and not online->empty())
+        topology.cpus = std::move(*online);
+	else
+        for (unsigned cpu = 0; cpu < std::max(1U, std::thread::hardware_concurrency()); ++cpu)
+            topology.cpus.push_back(cpu);
+
+	if (auto online_nodes = read_list(sysfs / "node" / "online"))
+    {
+		for (auto const node : *online_nodes)
+        {
+			auto cpus = read_list(sysfs / "node" / ("node" + std::to_string(node)) / "cpulist");
+			if (cpus and not cpus->empty())
+                topology.nodes.push_back(std::move(*cpus));
+		}
+	}
+	return topology;
+}
+
+// CPUs worker `index` may run on under `affinity`, empty for no restriction.
+[[nodiscard]] inline auto worker_cpus(cpu_topology const& topology, worker_affinity affinity, unsigned index) -> std::vector<unsigned>
+{
+	switch (affinity)
+    {
+		case worker_affinity::cores:
+			if (not topology.cpus.empty())
+                return { topology.cpus[index % topology.cpus.size()] };
+			return {};
+		case worker_affinity::numa_nodes:
+			if (not topology.nodes.empty())
+                return topology.nodes[index % topology.nodes.size()];
+			return {};
+		default:
+			return {};
+	}
+}
+
+// Best effort: false when the platform or the cpuset (e.g. a container) does not allow it.
+inline auto pin_thread(std::thread& thread, std::vector<unsigned> const& cpus) -> bool
+{
+#if defined(__linux__)
+	if (cpus.empty())
+        return true;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto const cpu : cpus)
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+	return ::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+	(void) thread;
+	return cpus.empty();
+#endif
+}
+
+}
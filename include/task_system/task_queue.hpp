@@ -1,40 +1,34 @@
 #pragma once
 
+#include "blocking_queue.hpp"
+
+#include <condition_variable>
 #include <queue>
 #include <mutex>
 #include <optional>
+#include <utility>
 
 namespace jx { 
 
     inline namespace v1 { 
 
+        // Kept for existing jx users, now a thin wrapper over the lock-free cosmos::blocking_queue.
         template <class T> 
         class blocking_queue {
         public:
-          // Add an element to the queue.
+          // Add an element to the queue, waiting while it is full.
           void enqueue(T t) {
-            std::lock_guard<std::mutex> lock(m);
-            q.push(t);
-            c.notify_one();
+            q.enqueue(std::move(t));
           }
 
           // Get the "front"-element.
           // If the queue is empty, wait till a element is avaiable.
           T dequeue(void) {
-            std::unique_lock<std::mutex> lock(m);
-            while (q.empty()) {
-              // release lock as long as the wait and reaquire it afterwards.
-              c.wait(lock);
-            }
-            T val = q.front();
-            q.pop();
-            return val;
+            return q.dequeue();
           }
 
         private:
-          std::queue<T> q;
-          mutable std::mutex m;
-          std::condition_variable c;
+          cosmos::blocking_queue<T> q;
         };
 
 
@@ -45,7 +39,7 @@ namespace jx {
             // Add an element to the queue.
             void enqueue(T t) {
                 std::lock_guard<std::mutex> lock(m);
-                q.push(t);
+                q.push(std::move(t));
             }
 
             // Get the "front"-element.
@@ -56,7 +50,7 @@ namespace jx {
                 }
                 T val = std::move(q.front());
                 q.pop();
-                return std::optional<T> { std::in_place_t{}, val };
+                return std::optional<T> { std::in_place_t{}, std::move(val) };
             }
 
         private:
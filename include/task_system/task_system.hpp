@@ -1,13 +1,17 @@
 #pragma once 
 
 // *** Task Stealing System ***
+#include "event_count.hpp"
+#include "small_function.hpp"
+#include "cpu_topology.hpp"
+
+#include <algorithm>
 #include <atomic>
-#include <deque>
+#include <cstddef>
 #include <vector>
 #include <thread>
 #include <mutex>
-#include <condition_variable>
-#include <functional>
+#include <utility>
 
 namespace jx 
 {
@@ -15,21 +19,60 @@ namespace jx
 // From Sean Parent (https://youtu.be/zULU6Hhp42w?si=VgR3ZLi5AJuaQ8kR)
 
 // *** Common type vocabulary *** //
+// Jobs whose captures fit in this many bytes are queued without touching the heap.
+inline constexpr std::size_t job_inline_capacity = 64;
+
 using function_signiture_t = auto (void) -> void;
-using function_capture_t   = std::function<function_signiture_t>;
+using function_capture_t   = cosmos::small_function<function_signiture_t, job_inline_capacity>;
+
+// FIFO over a power-of-two ring that only ever grows, so a queue that has reached its working size
+// stops allocating (std::deque allocates and frees a block every few jobs).
+class job_ring
+{
+	std::vector<function_capture_t> slots = std::vector<function_capture_t>(16);
+	std::size_t                     head{ 0 };
+	std::size_t                     count{ 0 };
+
+	auto grow() -> void
+	{
+		std::vector<function_capture_t> larger(slots.size() * 2);
+		for (std::size_t n = 0; n != count; ++n)
+			larger[n] = std::move(slots[(head + n) & (slots.size() - 1)]);
+		slots = std::move(larger);
+		head  = 0;
+	}
+
+public:
+	[[nodiscard]] auto empty() const noexcept -> bool { return count == 0; }
+	[[nodiscard]] auto size() const noexcept -> std::size_t { return count; }
+
+	template<class Function>
+	auto emplace_back(Function&& func) -> void
+	{
+		if (count == slots.size())
+			grow();
+		slots[(head + count) & (slots.size() - 1)] = std::forward<Function>(func);
+		++count;
+	}
+
+	[[nodiscard]] auto pop_front() noexcept -> function_capture_t
+	{
+		auto func = std::move(slots[head]);
+		head = (head + 1) & (slots.size() - 1);
+		--count;
+		return func;
+	}
+};
 
 class notification_queue
 {
 	// *** notification_queue type vocabulary *** //
-	using queue_t              = std::deque<function_capture_t>;
+	using queue_t              = job_ring;
 	using mutex_t              = std::mutex;
 	using lock_t			   = std::unique_lock<mutex_t>;
-	using cond_var_t           = std::condition_variable;
 	
-	cond_var_t      ready;
 	queue_t         queue;
 	mutex_t         mutex;
-	bool            finished{ false };
 
 public: 
 
@@ -44,9 +87,7 @@ public:
 		if (not lock or queue.empty()) 
             return false;
 
-		func = std::move(queue.front());
-
-		queue.pop_front();
+		func = queue.pop_front();
 
 		return true;
 	}
@@ -55,41 +96,24 @@ public:
 	template<class Function>
 	[[nodiscard]] auto try_push(Function && func) -> bool
     {	
-        { 
-			lock_t lock{ mutex, std::try_to_lock };
+		lock_t lock{ mutex, std::try_to_lock };
 			
-            if (not lock) 
-                return false;
-
-			queue.emplace_back(std::forward<Function>(func));
-		}
+		if (not lock) 
+			return false;
 
-		ready.notify_one();
+		queue.emplace_back(std::forward<Function>(func));
 		return true;
 	}
 
-	auto done() -> void
-    {
-		{
-			lock_t lock{ mutex };
-			finished = true;
-		}
-		ready.notify_all();
-	}
-
-	auto pop(function_capture_t& func) -> bool
+	// Waits for the lock (never for work): false only when the queue is empty.
+	[[nodiscard]] auto pop(function_capture_t& func) -> bool
     {
 		lock_t lock { mutex };
 
-		while (queue.empty() and not finished)
-            ready.wait(lock);
-
 		if (queue.empty())
             return false;
 
-		func = std::move(queue.front());
-
-		queue.pop_front();
+		func = queue.pop_front();
 
 		return true;
 	}
@@ -102,6 +126,16 @@ public:
 	}
 };
 
+struct task_system_options
+{
+	unsigned        threads{ std::max(1U, std::thread::hardware_concurrency()) };
+	// Rounds of try_push over the queues before async falls back to a blocking push.
+	unsigned        k_bound{ 48 };
+	// Sweeps over all queues an idle worker makes (yielding in between) before it parks.
+	unsigned        spin_rounds{ 64 };
+	worker_affinity affinity{ worker_affinity::none };
+};
+
 class task_system 
 {
 	// *** task_system type vocabulary *** //
@@ -109,11 +143,33 @@ class task_system
 	using notifications_t    = std::vector<notification_queue>;
 	using atomic_index_t     = std::atomic<unsigned>;
 
-	const unsigned int		count{ std::thread::hardware_concurrency() };
+	const task_system_options options;
+	const unsigned int		count{ std::max(1U, options.threads) };
 	thread_container_t		threads{ };
 	notifications_t		    notifications{ count };
 	atomic_index_t			index{ 0 };
-	unsigned int            k_bound{ 48 };
+	// Jobs submitted but not popped yet, across all queues. It is raised before the push and parking
+	// re-checks it after prepare_wait, so a submitted job is either seen by a worker about to park or
+	// wakes one that already did: no lost wake-ups.
+	std::atomic_size_t      queued{ 0 };
+	std::atomic_bool        finished{ false };
+	cosmos::event_count     parked{ };
+	unsigned                pinned{ 0 };
+
+	[[nodiscard]] auto find_work(unsigned i, function_capture_t& func) -> bool
+    {
+		for (unsigned n = 0; n != count; ++n) 
+			if (notifications[(i + n) % count].try_pop(func)) 
+                return true;
+
+		// try_pop gives up on contended locks, so take them before concluding there is nothing.
+		if (queued.load(std::memory_order_acquire) == 0)
+            return false;
+		for (unsigned n = 0; n != count; ++n) 
+			if (notifications[(i + n) % count].pop(func)) 
+                return true;
+		return false;
+	}
 
 	auto run(unsigned i) -> void
     {
@@ -121,46 +177,81 @@ class task_system
         {
 			function_capture_t func;
 
-			for (unsigned n = 0; n != count; ++n) 
-				if (notifications[(i + n) % count].try_pop(func)) 
+			for (unsigned spin = 0; not func and spin <= options.spin_rounds; ++spin)
+            {
+				if (find_work(i, func))
                     break;
-
-			if (not func and not notifications[i].pop(func))
-                break;
-
+				if (finished.load(std::memory_order_acquire))
+                    return;
+				std::this_thread::yield();
+			}
+
+			if (not func)
+            {
+				auto const key = parked.prepare_wait();
+				if (queued.load(std::memory_order_seq_cst) > 0 or finished.load(std::memory_order_seq_cst))
+                {
+					parked.cancel_wait();
+					continue;
+				}
+				parked.commit_wait(key);
+				continue;
+			}
+
+			queued.fetch_sub(1, std::memory_order_relaxed);
 			func();
 		}
 	} 
 
-
 public:
-	task_system() = default;
+	task_system() : task_system(task_system_options{}) {}
 	
-	explicit task_system (unsigned k = 48)
-		: k_bound{ k } 
+	explicit task_system (unsigned k)
+		: task_system(task_system_options{ .k_bound = k }) {}
+
+	explicit task_system (task_system_options const& opts)
+		: options{ opts }
     {
+		auto const topology = options.affinity == worker_affinity::none ? cpu_topology{} : read_cpu_topology();
 		for (unsigned n = 0; n != count; ++n) 
+        {
 			threads.emplace_back([&, n]{ run(n); });
+			if (options.affinity != worker_affinity::none and pin_thread(threads.back(), worker_cpus(topology, options.affinity, n)))
+                ++pinned;
+		}
 	}
 
+	task_system(task_system const&) = delete;
+
+	// Runs what is still queued, then joins the workers.
 	~task_system()
     {
-		for (auto& ns : notifications) ns.done();
+		finished.store(true, std::memory_order_seq_cst);
+		parked.notify_all();
 		for (auto& ts : threads)       ts.join();
 	}
+
+	[[nodiscard]] auto worker_count() const noexcept -> unsigned { return count; }
+	// Workers that actually got the requested affinity (containers may refuse it).
+	[[nodiscard]] auto pinned_workers() const noexcept -> unsigned { return pinned; }
 	
 	template<class Function>
 	auto async(Function&& work) -> void
     {	
         auto i = index++;
+		queued.fetch_add(1, std::memory_order_seq_cst);
 
-		for (unsigned n = 0; n != count * k_bound; ++n) 
+		for (unsigned n = 0; n != count * options.k_bound; ++n) 
         {
 			if(notifications[(i + n) % count].try_push(std::forward<Function>(work)))
+            {
+				parked.notify_one();
                 return;
+			}
 		}
 
 		notifications[i % count].push(std::forward<Function>(work));
+		parked.notify_one();
 	}
 };
 
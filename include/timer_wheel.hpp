@@ -0,0 +1,266 @@
+// Hierarchical timing wheel: O(1) insert and cancel for any number of timers
+#pragma once
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+// *** Standard Includes ***
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief names one timer of a timer_wheel. As with heap_handle, the generation makes a handle to
+     * a timer that fired or was cancelled stale instead of pointing at whatever reuses its node.
+     */
+    struct timer_handle
+    {
+        std::uint32_t node{UINT32_MAX};
+        std::uint32_t generation{0};
+
+        [[nodiscard]] constexpr auto valid() const noexcept -> bool { return node != UINT32_MAX; }
+        friend constexpr auto operator==(timer_handle, timer_handle) noexcept -> bool = default;
+    };
+
+    /**
+     * @brief timers keyed by an integer deadline (ticks of whatever clock the owner picks). Six levels
+     * of 64 slots: level l holds the timers whose deadline first differs from now() in bits
+     * [6l, 6l + 6), so a timer is placed and unlinked in O(1), and moves down at most once per level
+     * as time passes. A bitmask of occupied slots per level lets advance() and next_deadline() jump
+     * straight to the next slot with work, so a wheel idle for a month costs nothing to catch up.
+     * Deadlines past the top level's reach (about 2^36 ticks) wait in the furthest top-level slot
+     * and are placed again when it comes round. Not synchronized.
+     */
+    template <class T>
+    class timer_wheel
+    {
+    public:
+        using handle = timer_handle;
+
+        static constexpr unsigned level_bits = 6;
+        static constexpr unsigned levels = 6;
+        static constexpr std::size_t slots_per_level = std::size_t{1} << level_bits;
+
+        explicit timer_wheel(std::uint64_t now = 0) noexcept : current{now}
+        {
+            heads.fill(none);
+            tails.fill(none);
+        }
+
+        [[nodiscard]] auto now() const noexcept -> std::uint64_t { return current; }
+        [[nodiscard]] auto size() const noexcept -> std::size_t { return count; }
+        [[nodiscard]] auto empty() const noexcept -> bool { return count == 0; }
+
+        // A deadline at or before now() is expired right away.
+        auto insert(std::uint64_t deadline, T value) -> handle
+        {
+            std::uint32_t index{};
+            if (free_head != none)
+            {
+                index = free_head;
+                free_head = nodes[index].next;
+            }
+            else
+            {
+                index = static_cast<std::uint32_t>(nodes.size());
+                nodes.emplace_back();
+            }
+            auto &entry = nodes[index];
+            entry.value.emplace(std::move(value));
+            entry.deadline = deadline;
+            ++count;
+            place(index);
+            return {index, entry.generation};
+        }
+
+        // The timer's value, or nullopt when the handle is stale (it fired, was popped or cancelled).
+        auto cancel(handle h) -> std::optional<T>
+        {
+            if (not live(h))
+                return std::nullopt;
+            unlink(h.node);
+            return release(h.node);
+        }
+
+        [[nodiscard]] auto contains(handle h) const noexcept -> bool { return live(h); }
+
+        /**
+         * @brief moves now() forward to `target` (never back). Timers whose deadline is at or before
+         * it become expired, ready for pop_expired(); the rest cascade to the levels below as their
+         * slots come round. Returns how many expired.
+         */
+        auto advance(std::uint64_t target) -> std::size_t
+        {
+            std::size_t expired{0};
+            while (auto const next = next_slot())
+            {
+                if (next->tick > target)
+                    break;
+                current = next->tick;
+
+                // Detach the whole slot, then place each of its timers again relative to the new now().
+                auto const list = list_of(next->level, next->slot);
+                auto index = heads[list];
+                heads[list] = tails[list] = none;
+                occupied[next->level] &= ~(std::uint64_t{1} << next->slot);
+                while (index != none)
+                {
+                    auto const following = nodes[index].next;
+                    expired += place(index) ? 1 : 0;
+                    index = following;
+                }
+            }
+            current = std::max(current, target);
+            return expired;
+        }
+
+        // Expired timers in the order they expired.
+        auto pop_expired() -> std::optional<std::pair<handle, T>>
+        {
+            auto const index = heads[expired_list];
+            if (index == none)
+                return std::nullopt;
+            handle const h{index, nodes[index].generation};
+            unlink(index);
+            return std::pair{h, *release(index)};
+        }
+
+        [[nodiscard]] auto has_expired() const noexcept -> bool { return heads[expired_list] != none; }
+
+        /**
+         * @brief the tick at which advance() next has something to do: now() while timers are expired,
+         * the exact deadline for the level-0 timers, the start of the slot for the levels above (when
+         * their timers move down). nullopt when the wheel is empty.
+         */
+        [[nodiscard]] auto next_deadline() const noexcept -> std::optional<std::uint64_t>
+        {
+            if (has_expired())
+                return current;
+            if (auto const next = next_slot())
+                return next->tick;
+            return std::nullopt;
+        }
+
+    private:
+        static constexpr std::uint32_t none = UINT32_MAX;
+        static constexpr std::size_t expired_list = levels * slots_per_level;
+        static constexpr std::size_t list_count = expired_list + 1;
+        // A deadline is placed no further out than this, so it never lands in the top slot now() is in.
+        static constexpr std::uint64_t max_reach = (std::uint64_t{1} << (level_bits * levels))
+                                                   - (std::uint64_t{1} << (level_bits * (levels - 1))) - 1;
+
+        struct node
+        {
+            std::optional<T> value{};
+            std::uint64_t deadline{0};
+            std::uint32_t prev{none};
+            std::uint32_t next{none};
+            std::uint32_t generation{0};
+            std::uint32_t list{0};
+        };
+
+        struct slot_position
+        {
+            std::uint64_t tick;
+            unsigned level;
+            unsigned slot;
+        };
+
+        [[nodiscard]] static constexpr auto list_of(unsigned level, unsigned slot) noexcept -> std::size_t
+        {
+            return level * slots_per_level + slot;
+        }
+
+        [[nodiscard]] auto live(handle h) const noexcept -> bool
+        {
+            return h.node < nodes.size() and nodes[h.node].generation == h.generation and nodes[h.node].value;
+        }
+
+        // First occupied slot after now(): the lowest occupied level always holds the earliest timers.
+        [[nodiscard]] auto next_slot() const noexcept -> std::optional<slot_position>
+        {
+            for (unsigned level = 0; level < levels; ++level)
+            {
+                if (occupied[level] == 0)
+                    continue;
+                auto const shift = level * level_bits;
+                auto const here = static_cast<unsigned>((current >> shift) & (slots_per_level - 1));
+                // Rotated so bit 0 is the slot after `here`; the top level may wrap round.
+                auto const ahead = static_cast<unsigned>(
+                        std::countr_zero(std::rotr(occupied[level], static_cast<int>((here + 1) % slots_per_level)))) + 1;
+                auto const tick = ((current >> shift) + ahead) << shift;
+                return slot_position{tick, level, static_cast<unsigned>((here + ahead) % slots_per_level)};
+            }
+            return std::nullopt;
+        }
+
+        // Links the node into the list its deadline belongs to; true when that is the expired list.
+        auto place(std::uint32_t index) -> bool
+        {
+            auto const deadline = nodes[index].deadline;
+            if (deadline <= current)
+            {
+                push_back(expired_list, index);
+                return true;
+            }
+
+            auto const capped = std::min(deadline - current, max_reach) + current;
+            auto const level = std::min<unsigned>(static_cast<unsigned>(std::bit_width(capped ^ current) - 1) / level_bits, levels - 1);
+            auto const slot = static_cast<unsigned>((capped >> (level * level_bits)) & (slots_per_level - 1));
+            push_back(list_of(level, slot), index);
+            occupied[level] |= std::uint64_t{1} << slot;
+            return false;
+        }
+
+        auto push_back(std::size_t list, std::uint32_t index) -> void
+        {
+            auto &entry = nodes[index];
+            entry.list = static_cast<std::uint32_t>(list);
+            entry.prev = tails[list];
+            entry.next = none;
+            if (tails[list] != none)
+                nodes[tails[list]].next = index;
+            else
+                heads[list] = index;
+            tails[list] = index;
+        }
+
+        auto unlink(std::uint32_t index) -> void
+        {
+            auto &entry = nodes[index];
+            auto const list = entry.list;
+            (entry.prev != none ? nodes[entry.prev].next : heads[list]) = entry.next;
+            (entry.next != none ? nodes[entry.next].prev : tails[list]) = entry.prev;
+            if (heads[list] == none and list != expired_list)
+                occupied[list / slots_per_level] &= ~(std::uint64_t{1} << (list % slots_per_level));
+        }
+
+        auto release(std::uint32_t index) -> std::optional<T>
+        {
+            auto &entry = nodes[index];
+            auto value = std::move(entry.value);
+            entry.value.reset();
+            ++entry.generation;
+            entry.next = free_head;
+            free_head = index;
+            --count;
+            return value;
+        }
+
+        std::uint64_t current{0};
+        std::vector<node> nodes{};
+        std::uint32_t free_head{none};
+        std::size_t count{0};
+        std::array<std::uint32_t, list_count> heads{};
+        std::array<std::uint32_t, list_count> tails{};
+        std::array<std::uint64_t, levels> occupied{};
+    };
+} // namespace cosmos::inline v1
+
+#endif // TIMER_WHEEL_HPP
@@ -1,5 +1,7 @@
 #include <sstream>
 #include <iterator>
+#include <bit>
+#include <algorithm>
 #include "cron_expression.hpp"
 #include "cron_field.hpp"
 #include "minute_field.hpp"
@@ -30,54 +32,146 @@ cron_expression::cron_expression(const std::string &expression) {
     if (!day_of_month_field().validate(_values[cron_field_pos::day_of_month])) throw std::invalid_argument("invalid day of month field");
     if (!month_field().validate(_values[cron_field_pos::month])) throw std::invalid_argument("invalid month field");
     if (!day_of_week_field().validate(_values[cron_field_pos::day_of_week])) throw std::invalid_argument("invalid day of week field");
-}
 
-system_clock::time_point cron_expression::calc_next(const system_clock::time_point &timePoint) const {
-    date_time nextTime(timePoint);
-    month_field month;
-    day_of_month_field day;
+    _minutes = minute_field().compile(_values[cron_field_pos::minute]);
+    _hours = static_cast<uint32_t>(hour_field().compile(_values[cron_field_pos::hour]));
+    _months = static_cast<uint16_t>(month_field().compile(_values[cron_field_pos::month]));
+
+    const std::string &dayOfMonth = _values[cron_field_pos::day_of_month];
+    const size_t nearest = dayOfMonth.find_first_of("W");
+    _daysOfMonth = 0;
+    if (dayOfMonth == "?") _daysOfMonth = static_cast<uint32_t>(day_of_month_field().compile("*"));
+    else if (dayOfMonth == "L") _floatingDays.push_back({ floating_day::last_day, 0, 0 });
+    else if (nearest != std::string::npos) _floatingDays.push_back({ floating_day::nearest_weekday, std::stoi(dayOfMonth.substr(0, nearest)), 0 });
+    else _daysOfMonth = static_cast<uint32_t>(day_of_month_field().compile(dayOfMonth));
+
     day_of_week_field dow;
-    hour_field hour;
-    minute_field minute;
-    // this order is required to test cron parts
-    const cron_field *fields[5] = { &month, &day, &dow, &hour, &minute };
-    // run max 1000 iterations
-    for (int i = 0; i < 1000; i++) {
-        bool startOver = false;
-
-        for (const cron_field *f : fields) {
-
-            const std::string &value = _values[f->pos()];
-            if (value == "*") continue;
-            bool matched = false;
-
-            if (f->has_list(value)) {
-                for (const std::string &v : f->split_list(value)) {
-                    if (f->match(v, nextTime)) {
-                        matched = true;
+    const std::string &dayOfWeek = _values[cron_field_pos::day_of_week];
+    _daysOfWeek = 0;
+    if (dayOfWeek == "?") _daysOfWeek = static_cast<uint8_t>(dow.compile("*"));
+    else for (const std::string &v : dow.split_list(dayOfWeek)) {
+        const size_t last = v.find_first_of("L");
+        const size_t nth = v.find_first_of("#");
+        if (last != std::string::npos) _floatingDays.push_back({ floating_day::last_weekday, std::stoi(v.substr(0, last)), 0 });
+        else if (nth != std::string::npos) _floatingDays.push_back({ floating_day::nth_weekday, std::stoi(v.substr(0, nth)), std::stoi(v.substr(nth + 1)) });
+        else _daysOfWeek |= static_cast<uint8_t>(dow.compile(v));
+    }
+}
+
+namespace {
+
+// the Gregorian calendar repeats every 400 years, nothing found by then never matches
+const int max_months = 12 * 400;
+
+// bits first..end - 1
+uint64_t bits(unsigned first, unsigned end) {
+    return ((uint64_t(1) << end) - 1) & ~((uint64_t(1) << first) - 1);
+}
+
+} // namespace
+
+// bit d set for every day d of the month matching both day of month and day of week
+uint32_t cron_expression::days_of(int year, unsigned month, unsigned lastDay) const {
+    const unsigned first = weekday(sys_days(std::chrono::year(year) / std::chrono::month(month) / 1)).c_encoding();
+    const auto weekday_of = [first](int d) { return static_cast<int>((first + d - 1) % 7); };
+    const auto is_weekend = [&weekday_of](int d) { return weekday_of(d) == 0 || weekday_of(d) == 6; };
+
+    // the days of week rotated to start on the weekday of day 1, repeated over the month
+    const uint64_t week = ((_daysOfWeek >> first) | (_daysOfWeek << (7 - first))) & 0x7F;
+    uint64_t daysOfWeek = week << 1 | week << 8 | week << 15 | week << 22 | week << 29;
+    uint64_t daysOfMonth = _daysOfMonth;
+
+    for (const floating_day &special : _floatingDays) {
+        switch (special.kind) {
+        case floating_day::last_day:
+            daysOfMonth |= uint64_t(1) << lastDay;
+            break;
+        case floating_day::nearest_weekday: {
+            const int target = std::min(special.day, static_cast<int>(lastDay));
+            int d = target;
+            if (is_weekend(target)) {
+                for (const int &offset : { -1,1,-2,2 }) {
+                    const int dayOffset = target + offset;
+                    if (dayOffset > 0 && dayOffset <= static_cast<int>(lastDay) && !is_weekend(dayOffset)) {
+                        d = dayOffset;
                         break;
                     }
                 }
             }
-            else {
-                if (f->match(value, nextTime)) matched = true;
-            }
-            if (!matched) {
-                // increment time and start over
-                nextTime = f->increment(value, nextTime);
-                startOver = true;
-                break;
-            }
+            daysOfMonth |= uint64_t(1) << d;
+            break;
+        }
+        case floating_day::last_weekday:
+            daysOfWeek |= uint64_t(1) << (lastDay - (weekday_of(lastDay) - special.day + 7) % 7);
+            break;
+        case floating_day::nth_weekday: {
+            // the count goes on into the next month when this one is short of it, as it always did
+            unsigned d = 1 + (special.day - static_cast<int>(first) + 7) % 7 + 7 * (special.count - 1);
+            if (d > lastDay) d -= lastDay;
+            if (weekday_of(d) == special.day) daysOfWeek |= uint64_t(1) << d;
+            break;
+        }
         }
-        if (startOver) continue;
+    }
+    return static_cast<uint32_t>(daysOfMonth & daysOfWeek & bits(1, lastDay + 1));
+}
 
-        if ((system_clock::time_point)nextTime == timePoint) {
-            // increment minute
-            const std::string& value = _values[cron_field_pos::minute];
-            nextTime = minute.increment(value, nextTime);
+// first fire time of a matching day at or after minuteOfDay, in minutes since midnight, or -1
+int cron_expression::first_minute_from(int minuteOfDay) const {
+    const int hour = minuteOfDay / 60;
+    const uint64_t minutesLeft = _minutes >> (minuteOfDay % 60);
+    if ((_hours >> hour & 1) && minutesLeft) return minuteOfDay + std::countr_zero(minutesLeft);
+    const uint32_t hoursLeft = _hours >> (hour + 1);
+    if (!hoursLeft) return -1;
+    return (hour + 1 + std::countr_zero(hoursLeft)) * 60 + std::countr_zero(_minutes);
+}
+
+// The next matching minute, carrying the seconds of timePoint unless a month or (listed) day of month
+// that did not match was passed on the way, as the field by field walk this replaced did; a timePoint
+// with a fraction of a second inside a matching minute is its own answer. Unlike that walk, a listed
+// or stepped day of month past the end of a short month (*/10 after Feb 28) does not overshoot the
+// first matching day of the next month.
+system_clock::time_point cron_expression::calc_next(const system_clock::time_point &timePoint) const {
+    const auto whole = time_point_cast<seconds>(timePoint);
+    auto minute = floor<minutes>(whole);
+    const seconds second = whole - minute;
+    if (whole == timePoint) minute += minutes(1);
+    bool keepSeconds = true;
+
+    sys_days day = floor<days>(minute);
+    int minuteOfDay = static_cast<int>((minute - day) / minutes(1));
+    for (int scanned = 0; scanned < max_months; scanned++) {
+        const year_month_day date(day);
+        const unsigned month = static_cast<unsigned>(date.month());
+        if (!(_months >> month & 1)) {
+            // jump to the next listed month
+            const unsigned monthsLeft = static_cast<unsigned>(_months) >> (month + 1);
+            day = monthsLeft ?
+                sys_days(date.year() / std::chrono::month(month + 1 + std::countr_zero(monthsLeft)) / 1) :
+                sys_days((date.year() + years(1)) / std::chrono::month(std::countr_zero(_months)) / 1);
+            minuteOfDay = 0;
+            keepSeconds = false;
             continue;
         }
-        return nextTime;
+
+        const unsigned lastDay = static_cast<unsigned>((date.year() / date.month() / last).day());
+        const uint64_t matching = days_of(static_cast<int>(date.year()), month, lastDay);
+        unsigned from = static_cast<unsigned>(date.day());
+        for (uint64_t ahead = matching >> from << from; ahead; ahead = matching >> from << from) {
+            const unsigned next = std::countr_zero(ahead);
+            if (next != from) minuteOfDay = 0;
+            // a plain day of month skipped on the way; L and W days never reset the walk
+            if (_daysOfMonth && (bits(from, next) & ~uint64_t(_daysOfMonth))) keepSeconds = false;
+            const int found = first_minute_from(minuteOfDay);
+            if (found >= 0) {
+                return sys_days(date.year() / date.month() / next) + minutes(found) + (keepSeconds ? second : seconds(0));
+            }
+            from = next + 1;
+            minuteOfDay = 0;
+        }
+        if (_daysOfMonth && (bits(from, lastDay + 1) & ~uint64_t(_daysOfMonth))) keepSeconds = false;
+        day = sys_days(date.year() / date.month() / lastDay) + days(1);
+        minuteOfDay = 0;
     }
     return system_clock::time_point();
 }
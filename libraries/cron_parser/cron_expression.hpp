@@ -1,19 +1,40 @@
 #pragma once
 #include <string>
 #include <chrono>
+#include <cstdint>
+#include <vector>
 
 namespace geheb {
 
 using namespace std::chrono;
 
+// Compiled once into one bitmask per field (bit n set when value n matches), so calc_next jumps
+// from one candidate to the next with a bit scan and never allocates.
 class cron_expression final {
 public:
     cron_expression(const std::string &expression);
     system_clock::time_point calc_next(const system_clock::time_point &timePoint) const;
+    // raw definition of one field, indexed by cron_field_pos
+    const std::string &value(int pos) const { return _values[pos]; }
 
 private:
-    std::string _values[5];
+    // L, nW (day of month) and nL, n#k (day of week) pick a different day every month
+    struct floating_day {
+        enum kind_type { last_day, nearest_weekday, last_weekday, nth_weekday } kind;
+        int day;
+        int count;
+    };
+    uint32_t days_of(int year, unsigned month, unsigned lastDay) const;
+    int first_minute_from(int minuteOfDay) const;
 
+    std::string _values[5];
+    uint64_t _minutes;
+    uint32_t _hours;
+    // bits 1..31, none when the day of month is L or nW
+    uint32_t _daysOfMonth;
+    uint16_t _months;
+    uint8_t _daysOfWeek;
+    std::vector<floating_day> _floatingDays;
 };
 
 } // namespace geheb
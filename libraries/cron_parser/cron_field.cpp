@@ -108,6 +108,21 @@ std::vector<int> cron_field::create_list(const std::string &value) const {
     return result;
 }
 
+unsigned long long cron_field::compile(const std::string &value) const {
+    unsigned long long mask = 0;
+    if (value == "*") {
+        for (int i = range_start(); i <= range_end(); i++) mask |= 1ULL << i;
+        return mask;
+    }
+    std::vector<int> values;
+    if (has_list(value) || has_range(value) || has_step(value)) values = create_list(value);
+    else values.push_back(from_literal(value));
+    for (int v : values) {
+        if (v >= 0 && v < 64) mask |= 1ULL << v;
+    }
+    return mask;
+}
+
 int cron_field::from_literal(const std::string &value) const {
     if (!_literals.empty())    {
         auto it = _literals.find(value);
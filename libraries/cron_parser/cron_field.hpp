@@ -42,6 +42,8 @@ public:
     std::vector<std::string> split_list(const std::string &value) const    {
         return split(value, _listChar);
     }
+    // bit n set for every n a plain value (no L, W, # or ?) matches, "*" sets the whole range
+    unsigned long long compile(const std::string &value) const;
 
 private:
     const char _stepChar = '/';
@@ -0,0 +1,16 @@
+#include "cron_iterator.hpp"
+
+namespace geheb {
+
+cron_iterator::cron_iterator(const cron_expression &expression, const system_clock::time_point &after)
+    : _expression(expression), _after(after) {
+}
+
+system_clock::time_point cron_iterator::next() {
+    // from a whole minute calc_next moves past it and stays on whole minutes
+    const system_clock::time_point fire = _expression.calc_next(floor<minutes>(_after));
+    if (fire != system_clock::time_point()) _after = fire;
+    return fire;
+}
+
+} // namespace geheb
@@ -0,0 +1,22 @@
+#pragma once
+#include <chrono>
+#include "cron_expression.hpp"
+
+namespace geheb {
+
+using namespace std::chrono;
+
+// Walks the fire times of a cron expression in ascending order, one bit-scan calc_next per fire.
+class cron_iterator final {
+public:
+    // Starts at the first fire time strictly after `after`; fire times are on whole minutes (UTC).
+    cron_iterator(const cron_expression &expression, const system_clock::time_point &after);
+    // Next fire time, or system_clock::time_point() when the expression never matches again.
+    system_clock::time_point next();
+
+private:
+    cron_expression _expression;
+    system_clock::time_point _after;
+};
+
+} // namespace geheb
@@ -2,10 +2,14 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
+#include <ranges>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 namespace fs = std::filesystem;
@@ -160,6 +164,54 @@ namespace cosmos::inline v1
         return dag_run_status::none;
     }
 
+    auto updated_cost(std::optional<task_cost> const& previous, task_usage const& usage) noexcept -> task_cost
+    {
+        auto const wall = static_cast<double>(usage.wall_us);
+        auto const cpu = static_cast<double>(usage.user_cpu_us + usage.system_cpu_us);
+        auto const rss = static_cast<double>(usage.max_rss_bytes);
+        if (not previous or previous->runs == 0)
+            return task_cost{.last = usage, .mean_wall_us = wall, .mean_cpu_us = cpu, .mean_max_rss_bytes = rss, .runs = 1};
+
+        auto blend = [](double mean, double sample) { return mean + task_cost_smoothing * (sample - mean); };
+        return task_cost{
+            .last = usage,
+            .mean_wall_us = blend(previous->mean_wall_us, wall),
+            .mean_cpu_us = blend(previous->mean_cpu_us, cpu),
+            .mean_max_rss_bytes = blend(previous->mean_max_rss_bytes, rss),
+            .runs = previous->runs + 1,
+        };
+    }
+
+    [[nodiscard]] static auto usage_to_json(task_usage const& usage) -> nlohmann::json
+    {
+        return {
+            {"wall_us", usage.wall_us},
+            {"user_cpu_us", usage.user_cpu_us},
+            {"system_cpu_us", usage.system_cpu_us},
+            {"max_rss_bytes", usage.max_rss_bytes},
+            {"read_bytes", usage.read_bytes},
+            {"write_bytes", usage.write_bytes},
+            {"voluntary_switches", usage.voluntary_switches},
+            {"involuntary_switches", usage.involuntary_switches}
+        };
+    }
+
+    [[nodiscard]] static auto usage_from_json(nlohmann::json const& json) -> task_usage
+    {
+        if (not json.is_object())
+            return {};
+        return task_usage{
+            .wall_us = json.value("wall_us", uint64_t{0}),
+            .user_cpu_us = json.value("user_cpu_us", uint64_t{0}),
+            .system_cpu_us = json.value("system_cpu_us", uint64_t{0}),
+            .max_rss_bytes = json.value("max_rss_bytes", uint64_t{0}),
+            .read_bytes = json.value("read_bytes", uint64_t{0}),
+            .write_bytes = json.value("write_bytes", uint64_t{0}),
+            .voluntary_switches = json.value("voluntary_switches", uint64_t{0}),
+            .involuntary_switches = json.value("involuntary_switches", uint64_t{0})
+        };
+    }
+
     [[nodiscard]] static auto metadata_to_json(task_metadata const& metadata) -> nlohmann::json
     {
         nlohmann::json meta;
@@ -171,6 +223,16 @@ namespace cosmos::inline v1
             {"previous", to_string(metadata.statuses.previous)},
             {"current", to_string(metadata.statuses.current)}
         };
+        if (metadata.cost)
+        {
+            meta["cost"] = {
+                {"last", usage_to_json(metadata.cost->last)},
+                {"mean_wall_us", metadata.cost->mean_wall_us},
+                {"mean_cpu_us", metadata.cost->mean_cpu_us},
+                {"mean_max_rss_bytes", metadata.cost->mean_max_rss_bytes},
+                {"runs", metadata.cost->runs}
+            };
+        }
         return meta;
     }
 
@@ -196,6 +258,19 @@ namespace cosmos::inline v1
             has_data = true;
         }
 
+        if (auto const it = json.find("cost"); it != json.end() and it->is_object())
+        {
+            task_cost cost{};
+            if (auto const last = it->find("last"); last != it->end())
+                cost.last = usage_from_json(*last);
+            cost.mean_wall_us = it->value("mean_wall_us", 0.0);
+            cost.mean_cpu_us = it->value("mean_cpu_us", 0.0);
+            cost.mean_max_rss_bytes = it->value("mean_max_rss_bytes", 0.0);
+            cost.runs = it->value("runs", uint64_t{0});
+            metadata.cost = cost;
+            has_data = true;
+        }
+
         if (not has_data)
             return std::nullopt;
 
@@ -216,6 +291,48 @@ namespace cosmos::inline v1
         return oss.str();
     }
 
+    // Writes to a temp name unique per writer next to `target`, then renames it in: concurrent writers
+    // of the same content race on the rename only, and readers never see a partial file.
+    static auto write_bytes_atomic(fs::path const &target, const std::span<const std::byte> bytes,
+                                   std::optional<fs::perms> perms = std::nullopt) -> std::expected<void, storage_error>
+    {
+        static std::atomic_uint64_t counter{0};
+        auto tmp = target;
+        tmp += ".tmp." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + "." +
+               std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+        std::error_code ec;
+        {
+            std::ofstream os(tmp, std::ios::binary);
+            if (not os)
+                return std::unexpected(storage_error::io);
+            os.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (not os)
+            {
+                os.close();
+                fs::remove(tmp, ec);
+                return std::unexpected(storage_error::io);
+            }
+        }
+
+        if (perms)
+        {
+            fs::permissions(tmp, *perms, ec);
+            if (ec)
+            {
+                fs::remove(tmp, ec);
+                return std::unexpected(storage_error::permission);
+            }
+        }
+
+        fs::rename(tmp, target, ec);
+        if (ec)
+        {
+            fs::remove(tmp, ec);
+            return std::unexpected(storage_error::io);
+        }
+        return {};
+    }
+
     // ---------- fs_blob_store ----------
     fs_blob_store::fs_blob_store(fs::path root) :
         root_{std::move(root)}, blobs_dir_{root_ / "blobs"}
@@ -224,19 +341,21 @@ namespace cosmos::inline v1
         fs::create_directories(blobs_dir_, ec);
     }
 
+    auto fs_blob_store::id_of(const std::span<const std::byte> bytes) -> std::string
+    {
+        return fnv1a_hex(bytes);
+    }
+
     auto fs_blob_store::put_blob(const std::span<const std::byte> bytes) const -> std::expected<std::string, storage_error>
     {
         auto id = fnv1a_hex(bytes);
         const fs::path p = blobs_dir_ / (id + ".bin");
-        if (std::error_code ec; not fs::exists(p, ec))
-        {
-            std::ofstream os(p, std::ios::binary);
-            if (not os)
-                return std::unexpected(storage_error::io);
-            os.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
-            if (not os)
-                return std::unexpected(storage_error::io);
-        }
+        // Readers may open the blob at any time: it only ever appears complete, by rename. A file of
+        // another size is not this content (or was cut short before blobs were renamed in) and is replaced.
+        if (std::error_code ec; fs::file_size(p, ec) == bytes.size() and not ec)
+            return id;
+        if (auto written = write_bytes_atomic(p, bytes); not written)
+            return std::unexpected(written.error());
         return id;
     }
 
@@ -261,21 +380,36 @@ namespace cosmos::inline v1
         return fs::exists(p, ec);
     }
 
+    auto fs_blob_store::blob_path(const std::string_view id) const -> fs::path
+    {
+        return blobs_dir_ / (std::string{id} + ".bin");
+    }
+
     // Helpers for metadata IO
+    // Slurps the file and parses the buffer: much cheaper than parsing from the stream.
     static auto read_json(fs::path const &p) -> std::expected<nlohmann::json, storage_error>
     {
-        std::ifstream is(p);
+        std::ifstream is(p, std::ios::binary | std::ios::ate);
         if (not is)
             return std::unexpected(storage_error::not_found);
+        std::string text(static_cast<std::size_t>(is.tellg()), '\0');
+        is.seekg(0);
+        if (not is.read(text.data(), static_cast<std::streamsize>(text.size())))
+            return std::unexpected(storage_error::io);
         try
         {
-            nlohmann::json j;
-            is >> j;
-            return j;
+            return nlohmann::json::parse(text);
         }
         catch (...) { return std::unexpected(storage_error::corrupt); }
     }
 
+    // Record files only, never the temp file of a write in progress.
+    static auto is_record(fs::directory_entry const &entry) -> bool
+    {
+        std::error_code ec;
+        return entry.is_regular_file(ec) and entry.path().extension() == ".json";
+    }
+
     static auto write_json_atomic(fs::path const &p, nlohmann::json const &j) -> std::expected<void, storage_error>
     {
         std::error_code ec;
@@ -333,9 +467,9 @@ namespace cosmos::inline v1
         return new_version;
     }
 
+    // Readers take no lock: records are only ever replaced whole (write_json_atomic).
     auto fs_dag_store::get_dag(const std::string_view name) const -> std::expected<dag_entry, storage_error>
     {
-        std::scoped_lock lk(mtx_);
         const fs::path p = dag_dir_ / std::string{name} / "dag.json";
         auto j = read_json(p);
         if (not j)
@@ -346,9 +480,25 @@ namespace cosmos::inline v1
         return e;
     }
 
+    auto fs_dag_store::list_dag_names() const -> std::expected<std::vector<std::string>, storage_error>
+    {
+        std::vector<std::string> out;
+        std::error_code ec;
+        if (not fs::exists(dag_dir_, ec))
+            return out;
+
+        for (auto it = fs::directory_iterator(dag_dir_, ec); not ec and it != fs::directory_iterator{}; it.increment(ec))
+        {
+            if (it->is_directory(ec) and fs::exists(it->path() / "dag.json", ec))
+                out.push_back(it->path().filename().string());
+        }
+        if (ec)
+            return std::unexpected(storage_error::io);
+        return out;
+    }
+
     auto fs_dag_store::list_dags() const -> std::expected<std::vector<dag_entry>, storage_error>
     {
-        std::scoped_lock lk(mtx_);
         std::vector<dag_entry> out;
         if (std::error_code ec; not fs::exists(dag_dir_, ec))
             return out;
@@ -436,7 +586,12 @@ namespace cosmos::inline v1
         if (blob_id)
             j["blob_id"] = *blob_id;
         if (metadata)
+        {
             j["metadata"] = metadata_to_json(*metadata);
+            // Re-creating a task keeps the measured cost unless the caller supplies one.
+            if (not metadata->cost and existing_metadata and existing_metadata->contains("cost"))
+                j["metadata"]["cost"] = existing_metadata->at("cost");
+        }
         else if (existing_metadata)
             j["metadata"] = *existing_metadata;
         if (auto w = write_json_atomic(p, j); not w)
@@ -447,7 +602,6 @@ namespace cosmos::inline v1
 
     auto fs_task_store::get_task(const std::string_view dag, const std::string_view name) const -> std::expected<task_entry, storage_error>
     {
-        std::scoped_lock lk(mtx_);
         const fs::path p = task_dir_ / std::string{dag} / (std::string{name} + ".json");
         auto j = read_json(p);
         if (not j)
@@ -464,14 +618,13 @@ namespace cosmos::inline v1
 
     auto fs_task_store::list_tasks(const std::string_view dag) const -> std::expected<std::vector<task_entry>, storage_error>
     {
-        std::scoped_lock lk(mtx_);
         const fs::path dir = task_dir_ / std::string{dag};
         std::vector<task_entry> out;
         if (std::error_code ec; not fs::exists(dir, ec))
             return out;
         for (auto const &f: fs::directory_iterator(dir))
         {
-            if (not f.is_regular_file())
+            if (not is_record(f))
                 continue;
             auto j = read_json(f.path());
             if (not j)
@@ -511,9 +664,325 @@ namespace cosmos::inline v1
         return {};
     }
 
+    auto fs_task_store::record_run(
+    const std::string_view dag,
+    const std::string_view name,
+    task_usage const &usage,
+    const bool succeeded) const -> std::expected<task_metadata, storage_error>
+    {
+        std::scoped_lock lk(mtx_);
+        const fs::path p = task_dir_ / std::string{dag} / (std::string{name} + ".json");
+        auto j = read_json(p);
+        if (not j)
+            return std::unexpected(j.error());
+
+        task_metadata metadata{};
+        if (j->contains("metadata"))
+            metadata = metadata_from_json(j->at("metadata")).value_or(task_metadata{});
+
+        metadata.statuses.previous = metadata.statuses.current;
+        metadata.statuses.current = succeeded ? dag_run_status::success : dag_run_status::failed;
+        metadata.cost = updated_cost(metadata.cost, usage);
+
+        (*j)["metadata"] = metadata_to_json(metadata);
+        if (auto w = write_json_atomic(p, *j); not w)
+            return std::unexpected(w.error());
+        return metadata;
+    }
+
+    // ---------- fs_run_log ----------
+    fs_run_log::fs_run_log(fs::path root, std::chrono::seconds segment_span, std::size_t runs_per_dag) :
+        runs_dir_{std::move(root) / "history" / "runs"},
+        segment_span_{std::max(segment_span, std::chrono::seconds{1})},
+        runs_per_dag_{std::max<std::size_t>(runs_per_dag, 1)}
+    {
+        std::error_code ec;
+        fs::create_directories(runs_dir_, ec);
+        load();
+    }
+
+    auto fs_run_log::segment_of(int64_t const finished_us) const -> int64_t
+    {
+        auto const span_us = std::chrono::duration_cast<std::chrono::microseconds>(segment_span_).count();
+        auto const start_us = finished_us - (((finished_us % span_us) + span_us) % span_us);
+        return start_us / 1'000'000;
+    }
+
+    auto fs_run_log::load() -> void
+    {
+        std::error_code ec;
+        auto const names_path = runs_dir_ / "names";
+        {
+            std::ifstream in(names_path, std::ios::binary);
+            std::string text{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+            // A name whose newline never made it to disk was never referenced by a record.
+            auto const complete = text.rfind('\n');
+            auto const kept = complete == std::string::npos ? 0 : complete + 1;
+            if (kept != text.size())
+                fs::resize_file(names_path, kept, ec);
+            for (std::size_t begin = 0; begin < kept;)
+            {
+                auto const end = text.find('\n', begin);
+                names_.push_back(text.substr(begin, end - begin));
+                ids_.emplace(names_.back(), static_cast<uint32_t>(names_.size()));
+                begin = end + 1;
+            }
+        }
+        names_out_.open(names_path, std::ios::binary | std::ios::app);
+
+        std::vector<std::pair<int64_t, fs::path>> segments;
+        for (auto it = fs::directory_iterator(runs_dir_, ec); not ec and it != fs::directory_iterator{}; it.increment(ec))
+        {
+            auto const &path = it->path();
+            if (path.extension() != ".runs")
+                continue;
+            try
+            {
+                segments.emplace_back(std::stoll(path.stem().string()), path);
+            }
+            catch (std::exception const &)
+            {
+            }
+        }
+        std::ranges::sort(segments);
+
+        for (auto const &[_, path]: segments)
+        {
+            auto size = fs::file_size(path, ec);
+            if (ec)
+                continue;
+            if (auto const torn = size % sizeof(packed_run); torn != 0)
+                fs::resize_file(path, size -= torn, ec);
+
+            std::vector<packed_run> records(size / sizeof(packed_run));
+            std::ifstream in(path, std::ios::binary);
+            in.read(reinterpret_cast<char *>(records.data()), static_cast<std::streamsize>(size));
+            for (auto const &record: records)
+                if (record.dag_id != 0 and record.dag_id <= names_.size() and record.task_id <= names_.size())
+                    index(record);
+        }
+    }
+
+    auto fs_run_log::intern(std::string const &name) const -> std::expected<uint32_t, storage_error>
+    {
+        if (auto const found = ids_.find(name); found != ids_.end())
+            return found->second;
+        if (name.empty() or name.find('\n') != std::string::npos)
+            return std::unexpected(storage_error::unsupported);
+
+        // Written (and flushed) before any record can refer to it.
+        names_out_ << name << '\n';
+        names_out_.flush();
+        if (not names_out_)
+            return std::unexpected(storage_error::io);
+        names_.push_back(name);
+        return ids_.emplace(name, static_cast<uint32_t>(names_.size())).first->second;
+    }
+
+    auto fs_run_log::index(packed_run const &record) const -> void
+    {
+        highest_run_id_ = std::max(highest_run_id_.value_or(0), record.run_id);
+        auto &runs = recent_[record.dag_id];
+        // Tasks of one run finish close together, so its entry is found within the last few.
+        auto const found = std::ranges::find(runs | std::views::reverse, record.run_id, &indexed_run::run_id);
+        if (found != runs.rend())
+        {
+            found->tasks.push_back(record);
+            return;
+        }
+        runs.push_back(indexed_run{.run_id = record.run_id, .tasks = {record}});
+        if (runs.size() > runs_per_dag_)
+            runs.pop_front();
+    }
+
+    auto fs_run_log::append(run_record const &record) const -> std::expected<void, storage_error>
+    {
+        auto const micros = [](std::chrono::system_clock::time_point tp)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch()).count();
+        };
+
+        std::lock_guard lock(mtx_);
+        auto const dag_id = intern(record.dag);
+        if (not dag_id)
+            return std::unexpected(dag_id.error());
+        auto const task_id = intern(record.task);
+        if (not task_id)
+            return std::unexpected(task_id.error());
+
+        packed_run const packed{
+            .run_id = record.run_id,
+            .started_us = micros(record.started),
+            .finished_us = micros(record.finished),
+            .logical_us = micros(record.logical_time),
+            .dag_id = dag_id.value(),
+            .task_id = task_id.value(),
+            .exit_code = record.exit_code,
+            .status = static_cast<uint8_t>(record.status),
+        };
+
+        if (auto const segment = segment_of(packed.finished_us); segment != open_segment_ or not segment_out_.is_open())
+        {
+            segment_out_.close();
+            segment_out_.clear();
+            segment_out_.open(runs_dir_ / (std::to_string(segment) + ".runs"), std::ios::binary | std::ios::app);
+            open_segment_ = segment;
+        }
+        segment_out_.write(reinterpret_cast<char const *>(&packed), sizeof(packed));
+        segment_out_.flush();
+        if (not segment_out_)
+        {
+            // Cut a partial record off so the records appended after it stay aligned.
+            segment_out_.close();
+            auto const path = runs_dir_ / (std::to_string(open_segment_) + ".runs");
+            std::error_code ec;
+            if (auto const size = fs::file_size(path, ec); not ec)
+                fs::resize_file(path, size - size % sizeof(packed_run), ec);
+            return std::unexpected(storage_error::io);
+        }
+
+        index(packed);
+        return {};
+    }
+
+    auto fs_run_log::last_runs(std::string_view dag, std::size_t count) const -> std::vector<run_summary>
+    {
+        auto const from_micros = [](int64_t us)
+        {
+            return std::chrono::system_clock::time_point{std::chrono::microseconds{us}};
+        };
+
+        std::vector<run_summary> out;
+        std::lock_guard lock(mtx_);
+        auto const id = ids_.find(std::string{dag});
+        if (id == ids_.end())
+            return out;
+        auto const found = recent_.find(id->second);
+        if (found == recent_.end())
+            return out;
+
+        auto const &runs = found->second;
+        auto const first = runs.size() - std::min(count, runs.size());
+        out.reserve(runs.size() - first);
+        for (auto const &run: runs | std::views::drop(first))
+        {
+            run_summary summary{.run_id = run.run_id, .status = dag_run_status::success,
+                                .logical_time = from_micros(run.tasks.front().logical_us)};
+            summary.started = from_micros(run.tasks.front().started_us);
+            summary.finished = from_micros(run.tasks.front().finished_us);
+            for (auto const &task: run.tasks)
+            {
+                auto const status = static_cast<dag_run_status>(task.status);
+                if (status == dag_run_status::failed)
+                    summary.status = dag_run_status::failed;
+                summary.started = std::min(summary.started, from_micros(task.started_us));
+                summary.finished = std::max(summary.finished, from_micros(task.finished_us));
+                summary.tasks.push_back(run_record{
+                    .run_id = task.run_id,
+                    .dag = names_[task.dag_id - 1],
+                    .task = task.task_id == 0 ? std::string{} : names_[task.task_id - 1],
+                    .status = status,
+                    .started = from_micros(task.started_us),
+                    .finished = from_micros(task.finished_us),
+                    .exit_code = task.exit_code,
+                    .logical_time = from_micros(task.logical_us),
+                });
+            }
+            out.push_back(std::move(summary));
+        }
+        return out;
+    }
+
+    auto fs_run_log::highest_run_id() const -> std::optional<uint64_t>
+    {
+        std::lock_guard lock(mtx_);
+        return highest_run_id_;
+    }
+
+    auto fs_run_log::drop_before(std::chrono::system_clock::time_point cutoff) const
+        -> std::expected<std::size_t, storage_error>
+    {
+        auto const cutoff_us = std::chrono::duration_cast<std::chrono::microseconds>(cutoff.time_since_epoch()).count();
+        auto const span_s = segment_span_.count();
+
+        std::lock_guard lock(mtx_);
+        std::size_t dropped{0};
+        std::error_code ec;
+        for (auto it = fs::directory_iterator(runs_dir_, ec); not ec and it != fs::directory_iterator{}; it.increment(ec))
+        {
+            auto const &path = it->path();
+            if (path.extension() != ".runs")
+                continue;
+            int64_t start{0};
+            try
+            {
+                start = std::stoll(path.stem().string());
+            }
+            catch (std::exception const &)
+            {
+                continue;
+            }
+            if ((start + span_s) * 1'000'000 > cutoff_us)
+                continue;
+            if (start == open_segment_)
+                segment_out_.close();
+            std::error_code remove_ec;
+            if (not fs::remove(path, remove_ec) or remove_ec)
+                return std::unexpected(storage_error::io);
+            ++dropped;
+        }
+        if (ec)
+            return std::unexpected(storage_error::io);
+
+        // What is left on disk finished in the cutoff's segment or later; the index keeps the same.
+        auto const kept_from_us = segment_of(cutoff_us) * 1'000'000;
+        for (auto &runs: recent_ | std::views::values)
+            std::erase_if(runs, [kept_from_us](indexed_run const &run)
+            {
+                return std::ranges::all_of(run.tasks, [kept_from_us](packed_run const &task)
+                {
+                    return task.finished_us < kept_from_us;
+                });
+            });
+        return dropped;
+    }
+
+    // ---------- fs_script_cache ----------
+    fs_script_cache::fs_script_cache(fs::path root) :
+        root_{std::move(root)}, scripts_dir_{root_ / "cache" / "scripts"}
+    {
+        std::error_code ec;
+        fs::create_directories(scripts_dir_, ec);
+    }
+
+    auto fs_script_cache::path_of(const std::string_view blob_id) const -> fs::path
+    {
+        return scripts_dir_ / std::string{blob_id};
+    }
+
+    auto fs_script_cache::contains(const std::string_view blob_id) const -> bool
+    {
+        std::error_code ec;
+        return fs::exists(path_of(blob_id), ec);
+    }
+
+    auto fs_script_cache::materialize(const std::string_view blob_id, const std::span<const std::byte> bytes) const
+        -> std::expected<fs::path, storage_error>
+    {
+        auto target = path_of(blob_id);
+        if (contains(blob_id))
+            return target;
+
+        auto const executable = fs::perms::owner_all | fs::perms::group_read | fs::perms::group_exec |
+                                fs::perms::others_read | fs::perms::others_exec;
+        if (auto written = write_bytes_atomic(target, bytes, executable); not written)
+            return std::unexpected(written.error());
+        return target;
+    }
+
     // ---------- fs_storage ----------
     fs_storage::fs_storage(const fs::path& root) :
-        root_{root}, blobs_{root}, dags_{root}, tasks_{root}
+        root_{root}, blobs_{root}, dags_{root}, tasks_{root}, scripts_{root}, runs_{root}
     {
     }
 
@@ -1,8 +1,11 @@
 // Filesystem-backed storage (MVP)
 #pragma once
 
+#include <deque>
 #include <filesystem>
+#include <fstream>
 #include <mutex>
+#include <unordered_map>
 
 #include "storage.hpp"
 
@@ -13,8 +16,12 @@ class fs_blob_store
 public:
   explicit fs_blob_store(std::filesystem::path root);
   [[nodiscard]] auto put_blob(std::span<const std::byte> bytes) const -> std::expected<std::string, storage_error>;
+  // The id put_blob stores `bytes` under, computed without touching the disk.
+  [[nodiscard]] static auto id_of(std::span<const std::byte> bytes) -> std::string;
   [[nodiscard]] auto get_blob(std::string_view id) const -> std::expected<std::vector<std::byte>, storage_error>;
   [[nodiscard]] auto has_blob(std::string_view id) const -> std::expected<bool, storage_error>;
+  // Where the blob's bytes live, for readers that copy it inside the kernel (sendfile, memfd).
+  [[nodiscard]] auto blob_path(std::string_view id) const -> std::filesystem::path;
 
 private:
   std::filesystem::path root_;
@@ -35,6 +42,9 @@ public:
 
   [[nodiscard]] auto list_dags() const -> std::expected<std::vector<dag_entry>, storage_error>;
 
+  // Names only, from the directory listing: lets callers read the DAGs themselves (e.g. in parallel).
+  [[nodiscard]] auto list_dag_names() const -> std::expected<std::vector<std::string>, storage_error>;
+
   [[nodiscard]] auto erase_dag(
     std::string_view name,
     std::optional<uint64_t> if_version = std::nullopt
@@ -72,27 +82,128 @@ public:
     std::optional<uint64_t> if_version = std::nullopt
   ) const -> std::expected<void, storage_error>;
 
+  // Folds one execution into the task's metadata: statuses shift (current -> previous) and the
+  // usage updates the cost averages. The task version is left alone, runs are not edits.
+  [[nodiscard]] auto record_run(
+    std::string_view dag,
+    std::string_view name,
+    task_usage const& usage,
+    bool succeeded
+  ) const -> std::expected<task_metadata, storage_error>;
+
 private:
   std::filesystem::path root_;
   std::filesystem::path task_dir_;
   mutable std::mutex mtx_;
 };
 
+// Append-only run history: fixed-size binary records in one segment file per `segment_span` of
+// finish times, with DAG and task names interned in a side file. The newest `runs_per_dag` runs of
+// every DAG stay indexed in memory, so last_runs() never reads a file; opening the log rebuilds
+// that index from the segments (dropping a torn record at the end of one).
+class fs_run_log
+{
+public:
+  explicit fs_run_log(
+    std::filesystem::path root,
+    std::chrono::seconds segment_span = std::chrono::hours{24},
+    std::size_t runs_per_dag = 64);
+
+  [[nodiscard]] auto append(run_record const& record) const -> std::expected<void, storage_error>;
+
+  // Up to `count` (at most runs_per_dag) of the DAG's latest runs, oldest first.
+  [[nodiscard]] auto last_runs(std::string_view dag, std::size_t count) const -> std::vector<run_summary>;
+
+  // Highest run id ever recorded (kept when its segment is dropped), none on a fresh log.
+  [[nodiscard]] auto highest_run_id() const -> std::optional<uint64_t>;
+
+  // Deletes the segments that end before `cutoff` and forgets the runs they held.
+  [[nodiscard]] auto drop_before(
+    std::chrono::system_clock::time_point cutoff
+  ) const -> std::expected<std::size_t, storage_error>;
+
+private:
+  // On-disk record: 48 bytes in host byte order; ids index the names file (0 = none).
+  struct packed_run
+  {
+    uint64_t run_id{0};
+    int64_t started_us{0};
+    int64_t finished_us{0};
+    int64_t logical_us{0};
+    uint32_t dag_id{0};
+    uint32_t task_id{0};
+    int32_t exit_code{0};
+    uint8_t status{0};
+    std::array<uint8_t, 3> reserved{};
+  };
+  static_assert(sizeof(packed_run) == 48);
+
+  struct indexed_run
+  {
+    uint64_t run_id{0};
+    std::vector<packed_run> tasks{};
+  };
+
+  auto load() -> void;
+  auto intern(std::string const& name) const -> std::expected<uint32_t, storage_error>;
+  auto index(packed_run const& record) const -> void;
+  auto segment_of(int64_t finished_us) const -> int64_t;
+
+  std::filesystem::path runs_dir_;
+  std::chrono::seconds segment_span_;
+  std::size_t runs_per_dag_;
+
+  mutable std::mutex mtx_;
+  mutable std::vector<std::string> names_;
+  mutable std::unordered_map<std::string, uint32_t> ids_;
+  mutable std::unordered_map<uint32_t, std::deque<indexed_run>> recent_;
+  mutable std::ofstream names_out_;
+  mutable std::ofstream segment_out_;
+  mutable int64_t open_segment_{-1};
+  mutable std::optional<uint64_t> highest_run_id_;
+};
+
+// Content-addressed cache of executable task scripts: one file per blob id, written once and
+// shared by every run (and every concurrent launch) of tasks with that content.
+class fs_script_cache
+{
+public:
+  explicit fs_script_cache(std::filesystem::path root);
+
+  [[nodiscard]] auto path_of(std::string_view blob_id) const -> std::filesystem::path;
+  [[nodiscard]] auto contains(std::string_view blob_id) const -> bool;
+
+  // Writes the script (temp file + rename, mode 0755) unless it is already cached.
+  [[nodiscard]] auto materialize(
+    std::string_view blob_id,
+    std::span<const std::byte> bytes
+  ) const -> std::expected<std::filesystem::path, storage_error>;
+
+private:
+  std::filesystem::path root_;
+  std::filesystem::path scripts_dir_;
+};
+
 class fs_storage {
 
 
 
 public:
   explicit fs_storage(const std::filesystem::path& root);
+  [[nodiscard]] std::filesystem::path const& root() const { return root_; }
   [[nodiscard]] fs_blob_store const& blobs() const { return blobs_; }
   [[nodiscard]] fs_dag_store const& dags() const { return dags_; }
   [[nodiscard]] fs_task_store const& tasks() const { return tasks_; }
+  [[nodiscard]] fs_script_cache const& scripts() const { return scripts_; }
+  [[nodiscard]] fs_run_log const& runs() const { return runs_; }
 
 private:
   std::filesystem::path root_;
   fs_blob_store blobs_;
   fs_dag_store dags_;
   fs_task_store tasks_;
+  fs_script_cache scripts_;
+  fs_run_log runs_;
 };
 
 static_assert(is_storageable_v<fs_storage>, "Must implement storage interface");
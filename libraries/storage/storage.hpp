@@ -2,6 +2,8 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <expected>
 #include <optional>
 #include <span>
@@ -67,9 +69,59 @@ struct task_status_pair {
   dag_run_status current{dag_run_status::none};
 };
 
+// Resources one execution of a task used (microseconds / bytes / counts).
+struct task_usage {
+  uint64_t wall_us{0};
+  uint64_t user_cpu_us{0};
+  uint64_t system_cpu_us{0};
+  uint64_t max_rss_bytes{0};
+  uint64_t read_bytes{0};
+  uint64_t write_bytes{0};
+  uint64_t voluntary_switches{0};
+  uint64_t involuntary_switches{0};
+};
+
+// Input of the scheduler's cost model: the last run plus exponentially weighted averages.
+struct task_cost {
+  task_usage last{};
+  double mean_wall_us{0.0};
+  double mean_cpu_us{0.0};
+  double mean_max_rss_bytes{0.0};
+  uint64_t runs{0};
+};
+
+// Weight of the newest run in the task_cost averages.
+inline constexpr double task_cost_smoothing = 0.3;
+
+[[nodiscard]] auto updated_cost(std::optional<task_cost> const& previous, task_usage const& usage) noexcept -> task_cost;
+
 struct task_metadata {
   schedule_metadata schedule{};
   task_status_pair statuses{};
+  std::optional<task_cost> cost{};
+};
+
+// One task's outcome in one run of its DAG, as kept by the run history.
+struct run_record {
+  uint64_t run_id{0};
+  std::string dag{};
+  std::string task{};
+  dag_run_status status{dag_run_status::none};
+  std::chrono::system_clock::time_point started{};
+  std::chrono::system_clock::time_point finished{};
+  int32_t exit_code{0};
+  // The cron fire (or request time) the run stands for, however late it started.
+  std::chrono::system_clock::time_point logical_time{};
+};
+
+// The recorded tasks of one run; failed if any of them failed.
+struct run_summary {
+  uint64_t run_id{0};
+  dag_run_status status{dag_run_status::none};
+  std::chrono::system_clock::time_point started{};
+  std::chrono::system_clock::time_point finished{};
+  std::chrono::system_clock::time_point logical_time{};
+  std::vector<run_record> tasks{};
 };
 
 struct task_entry {
@@ -104,12 +156,20 @@ concept task_storeable = requires(task_store t, shyguy_task const& task, std::st
   { t.erase_task(dag, name, std::optional<uint64_t>{}) } -> std::same_as<std::expected<void, storage_error>>;
 };
 
+template<class run_store>
+concept run_storeable = requires(run_store r, run_record const& record, std::string_view dag, std::size_t count)
+{
+  { r.append(record) } -> std::same_as<std::expected<void, storage_error>>;
+  { r.last_runs(dag, count) } -> std::same_as<std::vector<run_summary>>;
+};
+
 template<class storage>
 concept storageable = requires(storage s)
 {
   { s.blobs() } -> blob_storeable;
   { s.dags() }  -> dag_storeable;
   { s.tasks() } -> task_storeable;
+  { s.runs() }  -> run_storeable;
 };
 
 template<class storage>
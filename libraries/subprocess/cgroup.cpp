@@ -0,0 +1,179 @@
+#include "cgroup.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace cosmos::inline v1
+{
+    namespace
+    {
+        constexpr std::uint64_t block_size = 512;
+        constexpr std::uint64_t cpu_period_us = 100'000;
+
+        [[nodiscard]] auto write_file(std::filesystem::path const &path, std::string_view value) noexcept -> bool
+        {
+            std::ofstream os(path);
+            os << value;
+            os.flush();
+            return static_cast<bool>(os);
+        }
+
+        [[nodiscard]] auto read_file(std::filesystem::path const &path) -> std::optional<std::string>
+        {
+            std::ifstream is(path);
+            if (not is)
+                return std::nullopt;
+            std::ostringstream content;
+            content << is.rdbuf();
+            return content.str();
+        }
+
+        [[nodiscard]] auto to_microseconds(timeval const &value) noexcept -> std::chrono::microseconds
+        {
+            return std::chrono::seconds{value.tv_sec} + std::chrono::microseconds{value.tv_usec};
+        }
+    } // namespace
+
+    auto to_resource_usage(struct rusage const &usage) noexcept -> resource_usage
+    {
+        return resource_usage{
+            .wall = {},
+            .user_cpu = to_microseconds(usage.ru_utime),
+            .system_cpu = to_microseconds(usage.ru_stime),
+            .max_rss_bytes = static_cast<std::uint64_t>(usage.ru_maxrss) * 1024U,
+            .read_bytes = static_cast<std::uint64_t>(usage.ru_inblock) * block_size,
+            .write_bytes = static_cast<std::uint64_t>(usage.ru_oublock) * block_size,
+            .voluntary_switches = static_cast<std::uint64_t>(usage.ru_nvcsw),
+            .involuntary_switches = static_cast<std::uint64_t>(usage.ru_nivcsw),
+        };
+    }
+
+    // ---------- task_cgroup ----------
+    task_cgroup::task_cgroup(task_cgroup &&other) noexcept : path_{std::exchange(other.path_, {})} {}
+
+    task_cgroup &task_cgroup::operator=(task_cgroup &&other) noexcept
+    {
+        if (this != &other)
+        {
+            remove();
+            path_ = std::exchange(other.path_, {});
+        }
+        return *this;
+    }
+
+    task_cgroup::~task_cgroup()
+    {
+        remove();
+    }
+
+    auto task_cgroup::create(cgroup_options const &options) -> std::expected<task_cgroup, int>
+    {
+        static std::atomic_uint64_t sequence{0};
+
+        if (options.parent.empty())
+            return std::unexpected(EINVAL);
+
+        // Best effort: the controllers may already be enabled, or be owned by whoever delegated the parent.
+        if (options.limited())
+            (void) write_file(options.parent / "cgroup.subtree_control", "+memory +cpu +io");
+
+        auto path = options.parent / ("task-" + std::to_string(::getpid()) + "-" +
+                                      std::to_string(sequence.fetch_add(1, std::memory_order_relaxed)));
+        std::error_code ec;
+        if (not std::filesystem::create_directory(path, ec))
+            return std::unexpected(ec ? ec.value() : EEXIST);
+
+        task_cgroup group{std::move(path)};
+        if (options.memory_max_bytes)
+        {
+            if (not write_file(group.path_ / "memory.max", std::to_string(*options.memory_max_bytes)))
+                return std::unexpected(EIO);
+            // An OOM kills the whole task, not a random process inside it.
+            (void) write_file(group.path_ / "memory.oom.group", "1");
+        }
+        if (options.cpu_max_cores)
+        {
+            auto const quota = static_cast<std::uint64_t>(std::llround(*options.cpu_max_cores * static_cast<double>(cpu_period_us)));
+            if (not write_file(group.path_ / "cpu.max",
+                               std::to_string(std::max<std::uint64_t>(quota, 1000)) + " " + std::to_string(cpu_period_us)))
+                return std::unexpected(EIO);
+        }
+        return group;
+    }
+
+    auto task_cgroup::attach(pid_t pid) const noexcept -> bool
+    {
+        return valid() and write_file(procs_file(), std::to_string(pid));
+    }
+
+    auto task_cgroup::collect(resource_usage &usage) const -> void
+    {
+        if (not valid())
+            return;
+
+        if (auto const cpu = read_file(path_ / "cpu.stat"))
+        {
+            std::istringstream lines{*cpu};
+            std::string key{};
+            std::uint64_t value{};
+            while (lines >> key >> value)
+            {
+                if (key == "user_usec")
+                    usage.user_cpu = std::chrono::microseconds{value};
+                else if (key == "system_usec")
+                    usage.system_cpu = std::chrono::microseconds{value};
+            }
+            usage.from_cgroup = true;
+        }
+
+        if (auto const io = read_file(path_ / "io.stat"))
+        {
+            // "<major>:<minor> rbytes=N wbytes=N rios=N ..." per device
+            std::uint64_t read_total{};
+            std::uint64_t write_total{};
+            std::istringstream fields{*io};
+            std::string field{};
+            while (fields >> field)
+            {
+                if (field.starts_with("rbytes="))
+                    read_total += std::strtoull(field.c_str() + 7, nullptr, 10);
+                else if (field.starts_with("wbytes="))
+                    write_total += std::strtoull(field.c_str() + 7, nullptr, 10);
+            }
+            usage.read_bytes = read_total;
+            usage.write_bytes = write_total;
+        }
+
+        if (auto const peak = read_file(path_ / "memory.peak"))
+            usage.memory_peak_bytes = std::strtoull(peak->c_str(), nullptr, 10);
+    }
+
+    auto task_cgroup::remove() noexcept -> void
+    {
+        if (not valid())
+            return;
+
+        // Leftover background processes would keep the group busy, so take them down first (5.14+).
+        (void) write_file(path_ / "cgroup.kill", "1");
+        for (int attempt = 0; attempt < 50; ++attempt)
+        {
+            if (::rmdir(path_.c_str()) == 0 or errno != EBUSY)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        path_.clear();
+    }
+
+} // namespace cosmos::inline v1
@@ -0,0 +1,91 @@
+// Per-task resource accounting: rusage figures and optional cgroup v2 limits/statistics
+#pragma once
+
+// *** Standard Includes ***
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+
+#include <sys/types.h>
+
+struct rusage;
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief what one task execution cost. CPU, RSS and context switches come from wait4(2); when
+     * the task ran in its own cgroup, CPU and I/O are replaced by the cgroup's totals, which also
+     * cover processes the task left behind.
+     */
+    struct resource_usage
+    {
+        std::chrono::microseconds wall{};
+        std::chrono::microseconds user_cpu{};
+        std::chrono::microseconds system_cpu{};
+        std::uint64_t max_rss_bytes{};
+        // Block I/O, exact with a cgroup (io.stat), estimated from ru_inblock/ru_oublock otherwise.
+        std::uint64_t read_bytes{};
+        std::uint64_t write_bytes{};
+        std::uint64_t voluntary_switches{};
+        std::uint64_t involuntary_switches{};
+        // memory.peak of the task's cgroup (includes page cache), 0 without a cgroup.
+        std::uint64_t memory_peak_bytes{};
+        bool from_cgroup{false};
+    };
+
+    [[nodiscard]] auto to_resource_usage(struct rusage const& usage) noexcept -> resource_usage;
+
+    struct cgroup_options
+    {
+        // Delegated cgroup v2 directory the per-task groups are created in. It must not hold
+        // processes itself once controllers are enabled for its children.
+        std::filesystem::path parent{};
+        std::optional<std::uint64_t> memory_max_bytes{};
+        // CPU bandwidth in cores, e.g. 0.5 or 2.0.
+        std::optional<double> cpu_max_cores{};
+
+        // Limits were asked for: a task must not run outside its cgroup, only accounting is optional.
+        [[nodiscard]] auto limited() const noexcept -> bool { return memory_max_bytes or cpu_max_cores; }
+    };
+
+    /**
+     * @brief a cgroup owned by a single task run. Removing it kills whatever is still inside
+     * (cgroup.kill) before the directory is deleted.
+     */
+    class task_cgroup
+    {
+    public:
+        task_cgroup() = default;
+        task_cgroup(task_cgroup const&) = delete;
+        task_cgroup& operator=(task_cgroup const&) = delete;
+        task_cgroup(task_cgroup&& other) noexcept;
+        task_cgroup& operator=(task_cgroup&& other) noexcept;
+        ~task_cgroup();
+
+        /**
+         * @brief creates `<parent>/task-<pid>-<n>` and applies the limits. Fails with an errno
+         * value, typically EACCES/EROFS when the daemon was not given a delegated hierarchy.
+         */
+        [[nodiscard]] static auto create(cgroup_options const& options) -> std::expected<task_cgroup, int>;
+
+        [[nodiscard]] auto valid() const noexcept -> bool { return not path_.empty(); }
+        [[nodiscard]] auto path() const noexcept -> std::filesystem::path const& { return path_; }
+        [[nodiscard]] auto procs_file() const -> std::filesystem::path { return path_ / "cgroup.procs"; }
+
+        auto attach(pid_t pid) const noexcept -> bool;
+
+        /**
+         * @brief overlays the cgroup's cpu.stat, io.stat and memory.peak onto `usage`.
+         */
+        auto collect(resource_usage& usage) const -> void;
+
+    private:
+        explicit task_cgroup(std::filesystem::path path) noexcept : path_{std::move(path)} {}
+        auto remove() noexcept -> void;
+
+        std::filesystem::path path_{};
+    };
+
+} // namespace cosmos::inline v1
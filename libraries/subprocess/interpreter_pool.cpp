@@ -0,0 +1,380 @@
+#include "interpreter_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace cosmos::inline v1
+{
+    namespace
+    {
+        // Worker main loop. Reads `path\0cgroup.procs[\0required]` + fds (task stdout, task stderr and optionally
+        // a memfd holding the script, which then replaces `path`) from fd 3, forks, runs the script in the child
+        // and answers with worker_reply (wait status + wait4 rusage). EOF on fd 3 ends it.
+        constexpr auto bootstrap = R"PY(
+import os, runpy, socket, struct, sys, traceback
+channel = socket.socket(fileno=3)
+for name in sys.argv[1:]:
+    try:
+        __import__(name)
+    except Exception:
+        pass
+while True:
+    message, fds, _, _ = socket.recv_fds(channel, 4096, 3)
+    if not message:
+        break
+    if len(fds) not in (2, 3):
+        for fd in fds:
+            os.close(fd)
+        channel.send(struct.pack("=ii7q", 0, 127 << 8, 0, 0, 0, 0, 0, 0, 0))
+        continue
+    path, _, cgroup = message.decode().partition("\0")
+    cgroup, _, required = cgroup.partition("\0")
+    pid = os.fork()
+    if pid == 0:
+        channel.close()
+        os.dup2(fds[0], 1)
+        os.dup2(fds[1], 2)
+        os.close(fds[0])
+        os.close(fds[1])
+        if cgroup:
+            try:
+                with open(cgroup, "w") as procs:
+                    procs.write("0")
+            except OSError as error:
+                if required:
+                    print("cannot join %s: %s" % (cgroup, error), file=sys.stderr, flush=True)
+                    os._exit(126)
+        in_memory = len(fds) == 3
+        if in_memory:
+            path = "/proc/self/fd/%d" % fds[2]
+        code = 0
+        try:
+            sys.argv = [path]
+            sys.path[0] = os.getcwd() if in_memory else os.path.dirname(path)
+            runpy.run_path(path, run_name="__main__")
+        except SystemExit as exit:
+            if isinstance(exit.code, int):
+                code = exit.code
+            elif exit.code is not None:
+                print(exit.code, file=sys.stderr)
+                code = 1
+        except BaseException:
+            traceback.print_exc()
+            code = 1
+        try:
+            sys.stdout.flush()
+            sys.stderr.flush()
+        except BaseException:
+            pass
+        os._exit(code & 0xff)
+    for fd in fds:
+        os.close(fd)
+    _, status, usage = os.wait4(pid, 0)
+    channel.send(struct.pack("=ii7q", pid, status, int(usage.ru_utime * 1e6), int(usage.ru_stime * 1e6),
+                             usage.ru_maxrss, usage.ru_inblock, usage.ru_oublock, usage.ru_nvcsw, usage.ru_nivcsw))
+)PY";
+
+        constexpr int worker_channel_fd = 3;
+
+        struct worker_reply
+        {
+            std::int32_t pid{};
+            std::int32_t wait_status{};
+            std::int64_t user_us{};
+            std::int64_t system_us{};
+            std::int64_t max_rss_kib{};
+            std::int64_t in_blocks{};
+            std::int64_t out_blocks{};
+            std::int64_t voluntary_switches{};
+            std::int64_t involuntary_switches{};
+        };
+        static_assert(sizeof(worker_reply) == 64, "must match the bootstrap's struct.pack(\"=ii7q\")");
+
+        [[nodiscard]] auto to_resource_usage(worker_reply const &reply) noexcept -> resource_usage
+        {
+            struct rusage usage{};
+            usage.ru_utime = {.tv_sec = reply.user_us / 1'000'000, .tv_usec = reply.user_us % 1'000'000};
+            usage.ru_stime = {.tv_sec = reply.system_us / 1'000'000, .tv_usec = reply.system_us % 1'000'000};
+            usage.ru_maxrss = reply.max_rss_kib;
+            usage.ru_inblock = reply.in_blocks;
+            usage.ru_oublock = reply.out_blocks;
+            usage.ru_nvcsw = reply.voluntary_switches;
+            usage.ru_nivcsw = reply.involuntary_switches;
+            return cosmos::to_resource_usage(usage);
+        }
+
+        auto close_fd(int &fd) noexcept -> void
+        {
+            if (fd >= 0)
+                ::close(fd);
+            fd = -1;
+        }
+
+        struct task_pipes
+        {
+            std::array<int, 2> out{-1, -1};
+            std::array<int, 2> err{-1, -1};
+
+            [[nodiscard]] auto open() noexcept -> bool
+            {
+                return ::pipe2(out.data(), O_CLOEXEC) == 0 and ::pipe2(err.data(), O_CLOEXEC) == 0;
+            }
+
+            auto close_write_ends() noexcept -> void
+            {
+                close_fd(out[1]);
+                close_fd(err[1]);
+            }
+
+            ~task_pipes()
+            {
+                for (auto *fd: {&out[0], &out[1], &err[0], &err[1]})
+                    close_fd(*fd);
+            }
+        };
+
+        [[nodiscard]] auto send_script(int channel, std::string const &request, std::span<const int> fds) noexcept -> bool
+        {
+            constexpr std::size_t max_fds = 3;
+            if (fds.size() > max_fds)
+                return false;
+            alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int) * max_fds)> control{};
+
+            iovec payload{.iov_base = const_cast<char *>(request.data()), .iov_len = request.size()};
+            msghdr message{};
+            message.msg_iov = &payload;
+            message.msg_iovlen = 1;
+            message.msg_control = control.data();
+            message.msg_controllen = CMSG_SPACE(fds.size_bytes());
+
+            auto *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(fds.size_bytes());
+            std::memcpy(CMSG_DATA(header), fds.data(), fds.size_bytes());
+
+            while (true)
+            {
+                auto const sent = ::sendmsg(channel, &message, MSG_NOSIGNAL);
+                if (sent >= 0)
+                    return static_cast<std::size_t>(sent) == request.size();
+                if (errno != EINTR)
+                    return false;
+            }
+        }
+
+        [[nodiscard]] auto receive_reply(int channel) noexcept -> std::expected<worker_reply, spawn_error>
+        {
+            worker_reply reply{};
+            while (true)
+            {
+                auto const got = ::recv(channel, &reply, sizeof(reply), 0);
+                if (got == static_cast<ssize_t>(sizeof(reply)))
+                    return reply;
+                if (got < 0 and errno == EINTR)
+                    continue;
+                return std::unexpected(spawn_error::worker_failed);
+            }
+        }
+
+        // `script_fd` (a sealed memfd) takes precedence over `script` when it is set.
+        [[nodiscard]] auto run_on_worker(int channel, std::filesystem::path const &script, int script_fd,
+                                         stream_options const &streams, std::optional<cgroup_options> const &cgroup_settings)
+            -> std::expected<stream_result, spawn_error>
+        {
+            task_pipes pipes{};
+            if (not pipes.open())
+                return std::unexpected(spawn_error::pipe_failed);
+
+            // The forked task joins its cgroup itself, before the script runs, and exits (126) when it
+            // cannot join one that limits it.
+            task_cgroup cgroup{};
+            if (cgroup_settings)
+            {
+                if (auto created = task_cgroup::create(*cgroup_settings); created)
+                    cgroup = std::move(created.value());
+                else if (cgroup_settings->limited())
+                    return std::unexpected(spawn_error::cgroup_failed);
+            }
+
+            auto request = std::filesystem::absolute(script).string();
+            if (cgroup.valid())
+            {
+                request += '\0' + cgroup.procs_file().string();
+                if (cgroup_settings->limited())
+                    request += std::string{'\0'} + "required";
+            }
+
+            auto const started = std::chrono::steady_clock::now();
+            std::array const fds{pipes.out[1], pipes.err[1], script_fd};
+            if (not send_script(channel, request, std::span{fds}.first(script_fd >= 0 ? 3 : 2)))
+                return std::unexpected(spawn_error::worker_failed);
+
+            // The task holds the only write ends now, so EOF follows its exit.
+            pipes.close_write_ends();
+            for (int fd: {pipes.out[0], pipes.err[0]})
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+            // The reply arriving on the channel plays the role of the pidfd.
+            auto streamed = stream_pipes(channel, pipes.out[0], pipes.err[0], streams);
+            if (not streamed)
+                return std::unexpected(streamed.error());
+
+            auto reply = receive_reply(channel);
+            if (not reply)
+                return std::unexpected(reply.error());
+
+            streamed->status = to_exit_status(reply->wait_status);
+            streamed->usage = to_resource_usage(reply.value());
+            streamed->usage.wall = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started);
+            cgroup.collect(streamed->usage);
+            return streamed;
+        }
+    } // namespace
+
+    struct interpreter_pool::worker
+    {
+        child_process process{};
+        int channel{-1};
+        std::size_t served{0};
+
+        // Closing the channel makes the interpreter leave its loop; child_process kills and reaps it.
+        ~worker() { close_fd(channel); }
+    };
+
+    interpreter_pool::interpreter_pool(interpreter_pool_options options) : options_{std::move(options)}
+    {
+        options_.workers = std::max<std::size_t>(options_.workers, 1);
+        for (std::size_t i = 0; i < options_.workers; ++i)
+        {
+            if (auto started = start_worker(); started)
+                idle_.push_back(std::move(started.value()));
+        }
+        live_ = idle_.size();
+    }
+
+    interpreter_pool::~interpreter_pool()
+    {
+        std::lock_guard lock(mutex_);
+        idle_.clear();
+    }
+
+    auto interpreter_pool::idle_workers() const -> std::size_t
+    {
+        std::lock_guard lock(mutex_);
+        return idle_.size();
+    }
+
+    auto interpreter_pool::start_worker() const -> std::expected<worker_ptr, spawn_error>
+    {
+        std::array<int, 2> channel{-1, -1};
+        if (::socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, channel.data()) != 0)
+            return std::unexpected(spawn_error::pipe_failed);
+
+        auto arguments = options_.interpreter;
+        arguments.emplace_back("-c");
+        arguments.emplace_back(bootstrap);
+        arguments.insert(arguments.end(), options_.preload_modules.begin(), options_.preload_modules.end());
+
+        auto child = spawn({.arguments = std::move(arguments), .inherited_fds = {{channel[1], worker_channel_fd}}});
+        close_fd(channel[1]);
+        if (not child)
+        {
+            close_fd(channel[0]);
+            return std::unexpected(child.error());
+        }
+
+        auto started = std::make_unique<worker>();
+        started->process = std::move(child.value());
+        started->channel = channel[0];
+        return started;
+    }
+
+    auto interpreter_pool::acquire() -> std::expected<worker_ptr, spawn_error>
+    {
+        std::unique_lock lock(mutex_);
+        available_.wait(lock, [this] { return not idle_.empty() or live_ < options_.workers; });
+        if (not idle_.empty())
+        {
+            auto leased = std::move(idle_.back());
+            idle_.pop_back();
+            return leased;
+        }
+
+        // A worker was lost earlier, start its replacement outside the lock.
+        ++live_;
+        lock.unlock();
+        auto started = start_worker();
+        if (not started)
+        {
+            lock.lock();
+            --live_;
+            available_.notify_one();
+        }
+        return started;
+    }
+
+    auto interpreter_pool::release(worker_ptr leased, bool healthy) -> void
+    {
+        auto const worn_out = options_.recycle_after != 0 and leased->served >= options_.recycle_after;
+        if (healthy and not worn_out)
+        {
+            std::lock_guard lock(mutex_);
+            idle_.push_back(std::move(leased));
+            available_.notify_one();
+            return;
+        }
+
+        leased.reset();
+        auto replacement = start_worker();
+
+        std::lock_guard lock(mutex_);
+        if (replacement)
+            idle_.push_back(std::move(replacement.value()));
+        else
+            --live_;
+        available_.notify_one();
+    }
+
+    auto interpreter_pool::run_script(std::filesystem::path const &script, stream_options const &streams,
+                                      std::optional<cgroup_options> const &cgroup)
+        -> std::expected<stream_result, spawn_error>
+    {
+        return run_on_next_worker(script, -1, streams, cgroup);
+    }
+
+    auto interpreter_pool::run_script(memory_file const &script, stream_options const &streams,
+                                      std::optional<cgroup_options> const &cgroup)
+        -> std::expected<stream_result, spawn_error>
+    {
+        if (not script.valid())
+            return std::unexpected(spawn_error::memfd_failed);
+        return run_on_next_worker(memory_file::child_path(), script.fd(), streams, cgroup);
+    }
+
+    auto interpreter_pool::run_on_next_worker(std::filesystem::path const &script, int script_fd,
+                                              stream_options const &streams, std::optional<cgroup_options> const &cgroup)
+        -> std::expected<stream_result, spawn_error>
+    {
+        auto leased = acquire();
+        if (not leased)
+            return std::unexpected(leased.error());
+
+        auto &current = *leased.value();
+        auto result = run_on_worker(current.channel, script, script_fd, streams, cgroup);
+        ++current.served;
+        release(std::move(leased.value()), result.has_value());
+        return result;
+    }
+
+} // namespace cosmos::inline v1
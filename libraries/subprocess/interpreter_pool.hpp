@@ -0,0 +1,83 @@
+// Forkserver style pool of pre-warmed python interpreters for python tasks
+#pragma once
+
+// *** Project Includes ***
+#include "memory_file.hpp"
+#include "subprocess.hpp"
+
+// *** Standard Includes ***
+#include <condition_variable>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cosmos::inline v1
+{
+    struct interpreter_pool_options
+    {
+        std::size_t workers{2};
+        // Scripts a worker serves before it is replaced by a fresh interpreter, 0 keeps it forever.
+        std::size_t recycle_after{100};
+        // Interpreter command line, the bootstrap is appended as `-c <bootstrap>`.
+        std::vector<std::string> interpreter{"python3"};
+        // Imported once per worker so every forked task starts with them loaded.
+        std::vector<std::string> preload_modules{};
+    };
+
+    /**
+     * @brief keeps `workers` python interpreters running, each with a control socket on fd 3. A
+     * script is handed to an idle worker together with the write ends of its stdout/stderr pipes
+     * (SCM_RIGHTS); the worker forks, runs the script with runpy in the child and replies with the
+     * wait status. Only the fork is paid per task, not interpreter startup and imports.
+     */
+    class interpreter_pool
+    {
+    public:
+        explicit interpreter_pool(interpreter_pool_options options);
+        interpreter_pool(interpreter_pool const&) = delete;
+        interpreter_pool& operator=(interpreter_pool const&) = delete;
+        ~interpreter_pool();
+
+        /**
+         * @brief runs `script` on the next idle worker, blocking while all of them are busy. Output
+         * is streamed exactly like run_streamed; usage comes from the worker's wait4 on the task and,
+         * with `cgroup`, from the task's own cgroup.
+         */
+        [[nodiscard]] auto run_script(std::filesystem::path const& script, stream_options const& streams,
+                                      std::optional<cgroup_options> const& cgroup = {})
+            -> std::expected<stream_result, spawn_error>;
+
+        /**
+         * @brief same, with the script handed over as a sealed memfd (SCM_RIGHTS) instead of a path.
+         */
+        [[nodiscard]] auto run_script(memory_file const& script, stream_options const& streams,
+                                      std::optional<cgroup_options> const& cgroup = {})
+            -> std::expected<stream_result, spawn_error>;
+
+        [[nodiscard]] auto options() const noexcept -> interpreter_pool_options const& { return options_; }
+        [[nodiscard]] auto idle_workers() const -> std::size_t;
+
+    private:
+        struct worker;
+        using worker_ptr = std::unique_ptr<worker>;
+
+        [[nodiscard]] auto start_worker() const -> std::expected<worker_ptr, spawn_error>;
+        [[nodiscard]] auto acquire() -> std::expected<worker_ptr, spawn_error>;
+        auto release(worker_ptr leased, bool healthy) -> void;
+        [[nodiscard]] auto run_on_next_worker(std::filesystem::path const& script, int script_fd,
+                                              stream_options const& streams, std::optional<cgroup_options> const& cgroup)
+            -> std::expected<stream_result, spawn_error>;
+
+        interpreter_pool_options options_;
+        mutable std::mutex mutex_{};
+        std::condition_variable available_{};
+        std::vector<worker_ptr> idle_{};
+        std::size_t live_{0};
+    };
+
+} // namespace cosmos::inline v1
@@ -0,0 +1,120 @@
+#include "memory_file.hpp"
+
+#include <cerrno>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cosmos::inline v1
+{
+    memory_file::memory_file(memory_file &&other) noexcept
+        : fd_{std::exchange(other.fd_, -1)}, size_{std::exchange(other.size_, 0)}
+    {
+    }
+
+    memory_file &memory_file::operator=(memory_file &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (fd_ >= 0)
+                ::close(fd_);
+            fd_ = std::exchange(other.fd_, -1);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    memory_file::~memory_file()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    auto memory_file::create(std::string_view name) -> int
+    {
+        return ::memfd_create(std::string{name}.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    }
+
+    auto memory_file::seal() noexcept -> bool
+    {
+        return ::fcntl(fd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == 0;
+    }
+
+    auto memory_file::child_path() -> std::string
+    {
+        return "/proc/self/fd/" + std::to_string(child_fd);
+    }
+
+    auto memory_file::from_bytes(std::string_view name, std::span<const std::byte> bytes)
+        -> std::expected<memory_file, spawn_error>
+    {
+        memory_file file{create(name), bytes.size()};
+        if (not file.valid())
+            return std::unexpected(spawn_error::memfd_failed);
+
+        auto const *data = reinterpret_cast<char const *>(bytes.data());
+        auto remaining = bytes.size();
+        while (remaining > 0)
+        {
+            auto const written = ::write(file.fd_, data, remaining);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return std::unexpected(spawn_error::memfd_failed);
+            }
+            data += written;
+            remaining -= static_cast<std::size_t>(written);
+        }
+
+        if (not file.seal())
+            return std::unexpected(spawn_error::memfd_failed);
+        return file;
+    }
+
+    auto memory_file::from_file(std::string_view name, std::filesystem::path const &source)
+        -> std::expected<memory_file, spawn_error>
+    {
+        int const input = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+        if (input < 0)
+            return std::unexpected(spawn_error::memfd_failed);
+
+        struct input_guard
+        {
+            int fd;
+            ~input_guard() { ::close(fd); }
+        } guard{input};
+
+        struct stat info{};
+        if (::fstat(input, &info) != 0)
+            return std::unexpected(spawn_error::memfd_failed);
+
+        auto const size = static_cast<std::size_t>(info.st_size);
+        memory_file file{create(name), size};
+        if (not file.valid())
+            return std::unexpected(spawn_error::memfd_failed);
+
+        std::size_t copied = 0;
+        while (copied < size)
+        {
+            auto moved = ::copy_file_range(input, nullptr, file.fd_, nullptr, size - copied, 0);
+            if (moved < 0 and (errno == EXDEV or errno == EINVAL or errno == ENOSYS or errno == EOPNOTSUPP))
+                moved = ::sendfile(file.fd_, input, nullptr, size - copied);
+            if (moved < 0 and errno == EINTR)
+                continue;
+            if (moved <= 0)
+                return std::unexpected(spawn_error::memfd_failed);
+            copied += static_cast<std::size_t>(moved);
+        }
+
+        if (not file.seal())
+            return std::unexpected(spawn_error::memfd_failed);
+        return file;
+    }
+
+} // namespace cosmos::inline v1
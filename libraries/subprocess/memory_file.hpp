@@ -0,0 +1,65 @@
+// Sealed in-memory files (memfd) for launching task scripts without touching the filesystem
+#pragma once
+
+// *** Project Includes ***
+#include "subprocess.hpp"
+
+// *** Standard Includes ***
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief an anonymous memfd holding a task script, sealed against any further change so one
+     * instance can back any number of concurrent launches. A child receives it as an inherited fd
+     * and runs it through `/proc/self/fd/<n>`, either directly (fexecve style, shebang or ELF) or
+     * as the interpreter's script argument.
+     */
+    class memory_file
+    {
+    public:
+        // Descriptor number children see the script on.
+        static constexpr int child_fd = 3;
+
+        memory_file() = default;
+        memory_file(memory_file const&) = delete;
+        memory_file& operator=(memory_file const&) = delete;
+        memory_file(memory_file&& other) noexcept;
+        memory_file& operator=(memory_file&& other) noexcept;
+        ~memory_file();
+
+        [[nodiscard]] static auto from_bytes(std::string_view name, std::span<const std::byte> bytes)
+            -> std::expected<memory_file, spawn_error>;
+
+        /**
+         * @brief fills the memfd from `source` inside the kernel (copy_file_range/sendfile), the
+         * bytes never pass through user space.
+         */
+        [[nodiscard]] static auto from_file(std::string_view name, std::filesystem::path const& source)
+            -> std::expected<memory_file, spawn_error>;
+
+        [[nodiscard]] auto valid() const noexcept -> bool { return fd_ >= 0; }
+        [[nodiscard]] auto fd() const noexcept -> int { return fd_; }
+        [[nodiscard]] auto size() const noexcept -> std::size_t { return size_; }
+
+        // Path of the script inside a child that inherited it on child_fd.
+        [[nodiscard]] static auto child_path() -> std::string;
+
+        // {fd, child_fd}, ready for spawn_options::inherited_fds.
+        [[nodiscard]] auto inherit() const noexcept -> std::pair<int, int> { return {fd_, child_fd}; }
+
+    private:
+        memory_file(int fd, std::size_t size) noexcept : fd_{fd}, size_{size} {}
+        [[nodiscard]] static auto create(std::string_view name) -> int;
+        [[nodiscard]] auto seal() noexcept -> bool;
+
+        int fd_{-1};
+        std::size_t size_{0};
+    };
+
+} // namespace cosmos::inline v1
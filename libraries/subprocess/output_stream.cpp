@@ -0,0 +1,281 @@
+#include "output_stream.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace cosmos::inline v1
+{
+    namespace
+    {
+        constexpr std::size_t chunk_size = 64 * 1024;
+
+        auto close_fd(int &fd) noexcept -> void
+        {
+            if (fd >= 0)
+                ::close(fd);
+            fd = -1;
+        }
+
+        // Full write to a regular file, retrying short writes.
+        [[nodiscard]] auto write_all(int fd, char const *data, std::size_t size) noexcept -> std::expected<void, int>
+        {
+            while (size > 0)
+            {
+                auto const count = ::write(fd, data, size);
+                if (count < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return std::unexpected(errno);
+                }
+                data += count;
+                size -= static_cast<std::size_t>(count);
+            }
+            return {};
+        }
+    } // namespace
+
+    // ---------- tail_buffer ----------
+    auto tail_buffer::append(std::span<const char> bytes) noexcept -> void
+    {
+        auto const cap = ring.size();
+        if (cap == 0 or bytes.empty())
+        {
+            total += bytes.size();
+            return;
+        }
+
+        if (bytes.size() >= cap)
+        {
+            std::ranges::copy(bytes.last(cap), ring.begin());
+            head = 0;
+        }
+        else
+        {
+            auto const first = std::min(bytes.size(), cap - head);
+            std::ranges::copy(bytes.first(first), ring.begin() + static_cast<std::ptrdiff_t>(head));
+            std::ranges::copy(bytes.subspan(first), ring.begin());
+            head = (head + bytes.size()) % cap;
+        }
+        total += bytes.size();
+    }
+
+    auto tail_buffer::str() const -> std::string
+    {
+        if (total < ring.size())
+            return {ring.data(), total};
+
+        std::string out{};
+        out.reserve(ring.size());
+        out.append(ring.data() + head, ring.size() - head);
+        out.append(ring.data(), head);
+        return out;
+    }
+
+    // ---------- segmented_log ----------
+    segmented_log::segmented_log(std::filesystem::path dir, std::string name, std::size_t segment_size) noexcept
+        : directory{std::move(dir)}, stem{std::move(name)}, segment_bytes{std::max<std::size_t>(segment_size, 1)}
+    {
+        if (::pipe2(scratch, O_CLOEXEC | O_NONBLOCK) != 0)
+            splice_supported = false;
+        null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    }
+
+    segmented_log::~segmented_log()
+    {
+        close_fd(segment_fd);
+        close_fd(scratch[0]);
+        close_fd(scratch[1]);
+        close_fd(null_fd);
+    }
+
+    auto segmented_log::segment_path(std::size_t index) const -> std::filesystem::path
+    {
+        std::array<char, 16> suffix{};
+        std::snprintf(suffix.data(), suffix.size(), ".%03zu.log", index);
+        return directory / (stem + suffix.data());
+    }
+
+    auto segmented_log::open_next_segment() -> std::expected<void, int>
+    {
+        close_fd(segment_fd);
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        segment_fd = ::open(segment_path(segment_index).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (segment_fd < 0)
+            return std::unexpected(errno);
+
+        ++segment_index;
+        segment_used = 0;
+        return {};
+    }
+
+    auto segmented_log::pump(int pipe_fd, tail_buffer &tail) -> std::expected<bool, int>
+    {
+        return splice_supported ? pump_spliced(pipe_fd, tail) : pump_copied(pipe_fd, tail);
+    }
+
+    auto segmented_log::pump_spliced(int pipe_fd, tail_buffer &tail) -> std::expected<bool, int>
+    {
+        while (true)
+        {
+            if (segment_fd < 0 or segment_used >= segment_bytes)
+                if (auto opened = open_next_segment(); not opened)
+                    return std::unexpected(opened.error());
+
+            auto const want = std::min(chunk_size, segment_bytes - segment_used);
+            auto const copied = ::tee(pipe_fd, scratch[1], want, SPLICE_F_NONBLOCK);
+            if (copied == 0)
+                return false;
+            if (copied < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN)
+                    return true;
+                if (errno == EINVAL)
+                {
+                    splice_supported = false;
+                    return pump_copied(pipe_fd, tail);
+                }
+                return std::unexpected(errno);
+            }
+
+            auto const count = static_cast<std::size_t>(copied);
+            std::size_t moved = 0;
+            while (moved < count)
+            {
+                auto const spliced = ::splice(pipe_fd, nullptr, segment_fd, nullptr, count - moved, SPLICE_F_MOVE);
+                if (spliced > 0)
+                {
+                    moved += static_cast<std::size_t>(spliced);
+                    continue;
+                }
+                if (spliced < 0 and errno == EINTR)
+                    continue;
+                if (spliced < 0 and errno != EINVAL)
+                    return std::unexpected(errno);
+
+                // The log's filesystem refuses splice: copy the bytes already tee'd through user space
+                // and stay on the copying path from now on.
+                std::array<char, chunk_size> buffer{};
+                while (moved < count)
+                {
+                    auto const got = ::read(pipe_fd, buffer.data(), count - moved);
+                    if (got <= 0)
+                    {
+                        if (got < 0 and errno == EINTR)
+                            continue;
+                        return std::unexpected(got < 0 ? errno : EIO);
+                    }
+                    if (auto w = write_all(segment_fd, buffer.data(), static_cast<std::size_t>(got)); not w)
+                        return std::unexpected(w.error());
+                    moved += static_cast<std::size_t>(got);
+                }
+                splice_supported = false;
+            }
+
+            segment_used += count;
+            written += count;
+            if (auto fed = feed_tail_from_scratch(count, tail); not fed)
+                return std::unexpected(fed.error());
+
+            if (not splice_supported)
+                return pump_copied(pipe_fd, tail);
+        }
+    }
+
+    auto segmented_log::feed_tail_from_scratch(std::size_t count, tail_buffer &tail) -> std::expected<void, int>
+    {
+        // Only the last tail.capacity() bytes can survive in the tail, drop the rest inside the kernel.
+        auto discard = count > tail.capacity() ? count - tail.capacity() : 0;
+        while (discard > 0 and null_fd >= 0)
+        {
+            auto const dropped = ::splice(scratch[0], nullptr, null_fd, nullptr, discard, SPLICE_F_MOVE);
+            if (dropped < 0 and errno == EINTR)
+                continue;
+            if (dropped <= 0)
+                break;
+            discard -= static_cast<std::size_t>(dropped);
+            count -= static_cast<std::size_t>(dropped);
+        }
+
+        std::array<char, chunk_size> buffer{};
+        while (count > 0)
+        {
+            auto const got = ::read(scratch[0], buffer.data(), std::min(count, buffer.size()));
+            if (got < 0 and errno == EINTR)
+                continue;
+            if (got <= 0)
+                return std::unexpected(got < 0 ? errno : EIO);
+            tail.append({buffer.data(), static_cast<std::size_t>(got)});
+            count -= static_cast<std::size_t>(got);
+        }
+        return {};
+    }
+
+    auto segmented_log::pump_copied(int pipe_fd, tail_buffer &tail) -> std::expected<bool, int>
+    {
+        std::array<char, chunk_size> buffer{};
+        while (true)
+        {
+            auto const got = ::read(pipe_fd, buffer.data(), buffer.size());
+            if (got == 0)
+                return false;
+            if (got < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN or errno == EWOULDBLOCK)
+                    return true;
+                return std::unexpected(errno);
+            }
+
+            auto const count = static_cast<std::size_t>(got);
+            std::size_t offset = 0;
+            while (offset < count)
+            {
+                if (segment_fd < 0 or segment_used >= segment_bytes)
+                    if (auto opened = open_next_segment(); not opened)
+                        return std::unexpected(opened.error());
+
+                auto const part = std::min(count - offset, segment_bytes - segment_used);
+                if (auto w = write_all(segment_fd, buffer.data() + offset, part); not w)
+                    return std::unexpected(w.error());
+                offset += part;
+                segment_used += part;
+            }
+
+            written += count;
+            tail.append({buffer.data(), count});
+        }
+    }
+
+    auto pump_to_tail(int pipe_fd, tail_buffer &tail) -> std::expected<bool, int>
+    {
+        std::array<char, chunk_size> buffer{};
+        while (true)
+        {
+            auto const got = ::read(pipe_fd, buffer.data(), buffer.size());
+            if (got == 0)
+                return false;
+            if (got < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN or errno == EWOULDBLOCK)
+                    return true;
+                return std::unexpected(errno);
+            }
+            tail.append({buffer.data(), static_cast<std::size_t>(got)});
+        }
+    }
+
+} // namespace cosmos::inline v1
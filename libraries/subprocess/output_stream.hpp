@@ -0,0 +1,86 @@
+// Bounded sinks for child output: segmented log files fed with splice/tee and an in-memory tail
+#pragma once
+
+// *** Standard Includes ***
+#include <algorithm>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief fixed capacity ring that keeps the last `capacity` bytes written to it.
+     */
+    class tail_buffer
+    {
+    public:
+        explicit tail_buffer(std::size_t capacity) : ring(capacity) {}
+
+        auto append(std::span<const char> bytes) noexcept -> void;
+        [[nodiscard]] auto str() const -> std::string;
+        [[nodiscard]] auto capacity() const noexcept -> std::size_t { return ring.size(); }
+        [[nodiscard]] auto size() const noexcept -> std::size_t { return std::min(total, ring.size()); }
+        [[nodiscard]] auto bytes_seen() const noexcept -> std::uint64_t { return total; }
+
+    private:
+        std::vector<char> ring;
+        std::size_t head{0};   // next write position
+        std::size_t total{0};  // bytes ever appended
+    };
+
+    /**
+     * @brief appends a stream to `<directory>/<stem>.<NNN>.log`, starting a new segment every
+     * `segment_bytes`. Data coming from a pipe is moved into the file with splice(2) and copied
+     * into the tail with tee(2), so the bulk of the output never passes through user space.
+     */
+    class segmented_log
+    {
+    public:
+        segmented_log(std::filesystem::path directory, std::string stem, std::size_t segment_bytes) noexcept;
+        segmented_log(segmented_log const&) = delete;
+        segmented_log& operator=(segmented_log const&) = delete;
+        ~segmented_log();
+
+        /**
+         * @brief moves whatever is available on the non-blocking pipe `pipe_fd` into the log and
+         * the tail. Returns false once the pipe reached EOF.
+         */
+        [[nodiscard]] auto pump(int pipe_fd, tail_buffer& tail) -> std::expected<bool, int>;
+
+        [[nodiscard]] auto bytes_written() const noexcept -> std::uint64_t { return written; }
+        [[nodiscard]] auto segment_count() const noexcept -> std::size_t { return segment_index; }
+        [[nodiscard]] auto segment_path(std::size_t index) const -> std::filesystem::path;
+
+    private:
+        auto open_next_segment() -> std::expected<void, int>;
+        auto pump_spliced(int pipe_fd, tail_buffer& tail) -> std::expected<bool, int>;
+        auto pump_copied(int pipe_fd, tail_buffer& tail) -> std::expected<bool, int>;
+        auto feed_tail_from_scratch(std::size_t count, tail_buffer& tail) -> std::expected<void, int>;
+
+        std::filesystem::path directory;
+        std::string stem;
+        std::size_t segment_bytes;
+
+        int segment_fd{-1};
+        std::size_t segment_index{0};
+        std::size_t segment_used{0};
+        std::uint64_t written{0};
+
+        // tee() target that holds the copy destined for the tail, and /dev/null to discard
+        // the part of that copy which would be overwritten in the tail anyway.
+        int scratch[2]{-1, -1};
+        int null_fd{-1};
+        bool splice_supported{true};
+    };
+
+    /**
+     * @brief reads a non-blocking pipe straight into a tail, used when no log directory is set.
+     * Returns false once the pipe reached EOF.
+     */
+    [[nodiscard]] auto pump_to_tail(int pipe_fd, tail_buffer& tail) -> std::expected<bool, int>;
+
+} // namespace cosmos::inline v1
@@ -0,0 +1,535 @@
+#include "subprocess.hpp"
+#include "output_stream.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <span>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace cosmos::inline v1
+{
+    namespace
+    {
+        using namespace std::string_view_literals;
+
+        constexpr std::array spawn_error_names{
+            "no arguments"sv, "pipe failed"sv, "spawn failed"sv, "pidfd failed"sv,
+            "epoll failed"sv, "read failed"sv, "wait failed"sv, "log failed"sv, "worker failed"sv,
+            "memfd failed"sv, "cgroup failed"sv
+        };
+
+        constexpr std::size_t read_chunk_size = 64 * 1024;
+
+        auto close_fd(int &fd) noexcept -> void
+        {
+            if (fd >= 0)
+                ::close(fd);
+            fd = -1;
+        }
+
+        // RAII for the pipe pair so every early return in spawn() cleans up
+        struct pipe_pair
+        {
+            std::array<int, 2> fds{-1, -1};
+
+            [[nodiscard]] auto open() noexcept -> bool { return ::pipe2(fds.data(), O_CLOEXEC) == 0; }
+            [[nodiscard]] auto read_end() noexcept -> int& { return fds[0]; }
+            [[nodiscard]] auto write_end() noexcept -> int& { return fds[1]; }
+
+            ~pipe_pair()
+            {
+                close_fd(fds[0]);
+                close_fd(fds[1]);
+            }
+        };
+
+        [[nodiscard]] auto open_pidfd(pid_t pid) noexcept -> int
+        {
+#ifdef SYS_pidfd_open
+            return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#else
+            (void) pid;
+            errno = ENOSYS;
+            return -1;
+#endif
+        }
+
+        [[nodiscard]] auto build_environment(spawn_options const &options) -> std::vector<std::string>
+        {
+            std::vector<std::string> env{};
+            if (options.inherit_environment and environ)
+            {
+                for (auto entry = environ; *entry; ++entry)
+                {
+                    std::string_view const value{*entry};
+                    auto const key = value.substr(0, value.find('='));
+                    auto const overridden = std::ranges::any_of(options.environment,
+                        [&](auto const &pair) { return pair.first == key; });
+                    if (not overridden)
+                        env.emplace_back(value);
+                }
+            }
+
+            for (auto const &[key, value]: options.environment)
+                env.push_back(key + '=' + value);
+
+            return env;
+        }
+
+        [[nodiscard]] auto to_pointers(std::vector<std::string> &strings) -> std::vector<char *>
+        {
+            std::vector<char *> pointers{};
+            pointers.reserve(strings.size() + 1);
+            for (auto &s: strings)
+                pointers.push_back(s.data());
+            pointers.push_back(nullptr);
+            return pointers;
+        }
+
+        // Reads everything currently available; returns false once the pipe hit EOF.
+        [[nodiscard]] auto drain(int fd, std::string &into) noexcept -> std::expected<bool, spawn_error>
+        {
+            std::array<char, read_chunk_size> buffer{};
+            while (true)
+            {
+                auto const count = ::read(fd, buffer.data(), buffer.size());
+                if (count > 0)
+                {
+                    into.append(buffer.data(), static_cast<std::size_t>(count));
+                    continue;
+                }
+                if (count == 0)
+                    return false;
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN or errno == EWOULDBLOCK)
+                    return true;
+                return std::unexpected(spawn_error::read_failed);
+            }
+        }
+
+        // Runs the epoll loop over both pipes and the pidfd. `consume(fd)` takes whatever is available on
+        // one pipe and returns false at EOF. Returns once the child exited and its pipes are drained.
+        template <class Consume>
+        [[nodiscard]] auto pump_until_exit(int pidfd, int stdout_fd, int stderr_fd, Consume &&consume)
+            -> std::expected<void, spawn_error>
+        {
+            int const epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd < 0)
+                return std::unexpected(spawn_error::epoll_failed);
+
+            struct epoll_guard
+            {
+                int fd;
+                ~epoll_guard() { ::close(fd); }
+            } guard{epoll_fd};
+
+            auto watch = [epoll_fd](int fd) noexcept -> bool
+            {
+                if (fd < 0)
+                    return true;
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.fd = fd;
+                return ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+            };
+
+            if (not watch(stdout_fd) or not watch(stderr_fd) or not watch(pidfd))
+                return std::unexpected(spawn_error::epoll_failed);
+
+            bool stdout_open = stdout_fd >= 0;
+            bool stderr_open = stderr_fd >= 0;
+            // Without a pidfd (pre 5.3 kernels) we fall back to EOF on both pipes followed by a blocking wait.
+            bool exited = pidfd < 0;
+
+            auto read_from = [&](int fd, bool &open) -> std::expected<void, spawn_error>
+            {
+                auto consumed = consume(fd);
+                if (not consumed)
+                    return std::unexpected(consumed.error());
+                if (not consumed.value())
+                {
+                    (void) ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                    open = false;
+                }
+                return {};
+            };
+
+            std::array<epoll_event, 3> events{};
+            while (stdout_open or stderr_open)
+            {
+                if (exited and pidfd >= 0)
+                {
+                    // Child is gone: whatever it wrote is already in the pipe, so drain and stop. A grandchild
+                    // that inherited the pipes must not keep the task alive.
+                    if (stdout_open)
+                        if (auto r = read_from(stdout_fd, stdout_open); not r)
+                            return r;
+                    if (stderr_open)
+                        if (auto r = read_from(stderr_fd, stderr_open); not r)
+                            return r;
+                    break;
+                }
+
+                auto const ready = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+                if (ready < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return std::unexpected(spawn_error::epoll_failed);
+                }
+
+                for (auto const &event: std::span{events.data(), static_cast<std::size_t>(ready)})
+                {
+                    if (event.data.fd == pidfd)
+                        exited = true;
+                    else if (event.data.fd == stdout_fd and stdout_open)
+                    {
+                        if (auto r = read_from(stdout_fd, stdout_open); not r)
+                            return r;
+                    }
+                    else if (event.data.fd == stderr_fd and stderr_open)
+                    {
+                        if (auto r = read_from(stderr_fd, stderr_open); not r)
+                            return r;
+                    }
+                }
+            }
+            return {};
+        }
+    } // namespace
+
+    auto to_string_view(spawn_error error) noexcept -> std::string_view
+    {
+        auto const index = static_cast<std::size_t>(error);
+        return index < spawn_error_names.size() ? spawn_error_names[index] : "unknown"sv;
+    }
+
+    auto to_exit_status(int wait_status) noexcept -> exit_status
+    {
+        exit_status result{};
+        if (WIFEXITED(wait_status))
+        {
+            result.code = WEXITSTATUS(wait_status);
+        }
+        else if (WIFSIGNALED(wait_status))
+        {
+            result.signal = WTERMSIG(wait_status);
+            result.code = 128 + result.signal;
+#ifdef WCOREDUMP
+            result.core_dumped = WCOREDUMP(wait_status);
+#endif
+        }
+        return result;
+    }
+
+    auto to_string(exit_status const &status) -> std::string
+    {
+        if (status.exited())
+            return "exited with code " + std::to_string(status.code);
+
+        std::string description = "killed by signal " + std::to_string(status.signal);
+        if (auto const name = ::sigabbrev_np(status.signal))
+            description += std::string{" (SIG"} + name + ")";
+        if (status.core_dumped)
+            description += ", core dumped";
+        return description;
+    }
+
+    // ---------- child_process ----------
+    child_process::child_process(child_process &&other) noexcept
+        : pid_{std::exchange(other.pid_, -1)},
+          pidfd_{std::exchange(other.pidfd_, -1)},
+          stdout_fd_{std::exchange(other.stdout_fd_, -1)},
+          stderr_fd_{std::exchange(other.stderr_fd_, -1)},
+          cgroup_{std::move(other.cgroup_)},
+          started_{other.started_},
+          usage_{other.usage_}
+    {
+    }
+
+    child_process &child_process::operator=(child_process &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            pid_ = std::exchange(other.pid_, -1);
+            pidfd_ = std::exchange(other.pidfd_, -1);
+            stdout_fd_ = std::exchange(other.stdout_fd_, -1);
+            stderr_fd_ = std::exchange(other.stderr_fd_, -1);
+            cgroup_ = std::move(other.cgroup_);
+            started_ = other.started_;
+            usage_ = other.usage_;
+        }
+        return *this;
+    }
+
+    child_process::~child_process()
+    {
+        release();
+    }
+
+    auto child_process::release() noexcept -> void
+    {
+        if (pid_ > 0)
+        {
+            (void) kill(SIGKILL);
+            (void) reap();
+        }
+        close_fds();
+    }
+
+    auto child_process::kill(int signal) const noexcept -> bool
+    {
+        if (pid_ <= 0)
+            return false;
+#ifdef SYS_pidfd_send_signal
+        if (pidfd_ >= 0)
+            return ::syscall(SYS_pidfd_send_signal, pidfd_, signal, nullptr, 0) == 0;
+#endif
+        return ::kill(pid_, signal) == 0;
+    }
+
+    auto child_process::close_fds() noexcept -> void
+    {
+        close_fd(pidfd_);
+        close_fd(stdout_fd_);
+        close_fd(stderr_fd_);
+    }
+
+    auto child_process::reap() noexcept -> std::expected<exit_status, spawn_error>
+    {
+        int status = 0;
+        struct rusage usage{};
+        while (::wait4(pid_, &status, 0, &usage) < 0)
+        {
+            if (errno != EINTR)
+            {
+                pid_ = -1;
+                return std::unexpected(spawn_error::wait_failed);
+            }
+        }
+        pid_ = -1;
+        usage_ = to_resource_usage(usage);
+        usage_.wall = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started_);
+        cgroup_.collect(usage_);
+        cgroup_ = {};
+        return to_exit_status(status);
+    }
+
+    auto child_process::wait() -> std::expected<process_output, spawn_error>
+    {
+        process_output output{};
+        auto pumped = pump_until_exit(pidfd_, stdout_fd_, stderr_fd_, [&](int fd)
+        {
+            return drain(fd, fd == stdout_fd_ ? output.standard_output : output.standard_error);
+        });
+
+        auto status = reap();
+        close_fds();
+        if (not pumped)
+            return std::unexpected(pumped.error());
+        if (not status)
+            return std::unexpected(status.error());
+
+        output.status = status.value();
+        output.usage = usage_;
+        return output;
+    }
+
+    auto child_process::stream(stream_options const &options) -> std::expected<stream_result, spawn_error>
+    {
+        auto streamed = stream_pipes(pidfd_, stdout_fd_, stderr_fd_, options);
+
+        auto status = reap();
+        close_fds();
+        if (not streamed)
+            return std::unexpected(streamed.error());
+        if (not status)
+            return std::unexpected(status.error());
+
+        streamed->status = status.value();
+        streamed->usage = usage_;
+        return streamed;
+    }
+
+    // ---------- free functions ----------
+    auto spawn(spawn_options const &options) -> std::expected<child_process, spawn_error>
+    {
+        if (options.arguments.empty() or options.arguments.front().empty())
+            return std::unexpected(spawn_error::no_arguments);
+
+        pipe_pair out{};
+        pipe_pair err{};
+        if (not out.open() or not err.open())
+            return std::unexpected(spawn_error::pipe_failed);
+
+        posix_spawn_file_actions_t actions{};
+        posix_spawnattr_t attributes{};
+        ::posix_spawn_file_actions_init(&actions);
+        ::posix_spawnattr_init(&attributes);
+
+        struct spawn_guard
+        {
+            posix_spawn_file_actions_t *actions;
+            posix_spawnattr_t *attributes;
+            ~spawn_guard()
+            {
+                ::posix_spawn_file_actions_destroy(actions);
+                ::posix_spawnattr_destroy(attributes);
+            }
+        } guard{&actions, &attributes};
+
+        // The pipes are O_CLOEXEC, dup2 clears the flag on the child's copies only.
+        ::posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+        ::posix_spawn_file_actions_adddup2(&actions, out.write_end(), STDOUT_FILENO);
+        ::posix_spawn_file_actions_adddup2(&actions, err.write_end(), STDERR_FILENO);
+        if (options.working_directory)
+            ::posix_spawn_file_actions_addchdir_np(&actions, options.working_directory->c_str());
+
+        // Move every inherited descriptor above the target range first, so a mapping like {3 -> 4, 4 -> 3}
+        // cannot clobber itself and dup2 never sees equal fds (which would leave FD_CLOEXEC set).
+        std::vector<int> staged{};
+        struct staged_guard
+        {
+            std::vector<int> &fds;
+            ~staged_guard()
+            {
+                for (auto &fd: fds)
+                    close_fd(fd);
+            }
+        } staged_cleanup{staged};
+        for (auto const &[parent_fd, child_fd]: options.inherited_fds)
+        {
+            int const high = ::fcntl(parent_fd, F_DUPFD_CLOEXEC, 64);
+            if (high < 0)
+                return std::unexpected(spawn_error::pipe_failed);
+            staged.push_back(high);
+            ::posix_spawn_file_actions_adddup2(&actions, high, child_fd);
+        }
+
+        // Start from a clean signal state: the daemon may block or ignore signals (e.g. SIGPIPE).
+        sigset_t empty_mask{};
+        sigset_t default_signals{};
+        ::sigemptyset(&empty_mask);
+        ::sigfillset(&default_signals);
+        ::posix_spawnattr_setsigmask(&attributes, &empty_mask);
+        ::posix_spawnattr_setsigdefault(&attributes, &default_signals);
+        ::posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+        auto arguments = options.arguments;
+        auto argv = to_pointers(arguments);
+        auto environment = build_environment(options);
+        auto envp = to_pointers(environment);
+
+        // posix_spawn cannot start a child inside a cgroup, so it is moved in right after the exec. Anything
+        // it forks before that is outside the limits but still killed when the group is removed.
+        task_cgroup cgroup{};
+        if (options.cgroup)
+        {
+            if (auto created = task_cgroup::create(*options.cgroup); created)
+                cgroup = std::move(created.value());
+            else if (options.cgroup->limited())
+                return std::unexpected(spawn_error::cgroup_failed);
+        }
+
+        pid_t pid = -1;
+        auto const &program = options.arguments.front();
+        int const rc = program.find('/') == std::string::npos
+            ? ::posix_spawnp(&pid, program.c_str(), &actions, &attributes, argv.data(), envp.data())
+            : ::posix_spawn(&pid, program.c_str(), &actions, &attributes, argv.data(), envp.data());
+        if (rc != 0)
+            return std::unexpected(spawn_error::spawn_failed);
+
+        if (cgroup.valid() and not cgroup.attach(pid))
+        {
+            if (options.cgroup->limited())
+            {
+                child_process unlimited{pid, -1, std::exchange(out.read_end(), -1), std::exchange(err.read_end(), -1)};
+                return std::unexpected(spawn_error::cgroup_failed);
+            }
+            cgroup = {};
+        }
+
+        // The child owns the write ends now, close ours so EOF is observable.
+        close_fd(out.write_end());
+        close_fd(err.write_end());
+
+        int const pidfd = open_pidfd(pid);
+        if (pidfd < 0 and errno != ENOSYS)
+        {
+            child_process orphan{pid, -1, std::exchange(out.read_end(), -1), std::exchange(err.read_end(), -1)};
+            return std::unexpected(spawn_error::pidfd_failed);
+        }
+
+        for (int fd: {out.read_end(), err.read_end()})
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        return child_process{pid, pidfd, std::exchange(out.read_end(), -1), std::exchange(err.read_end(), -1),
+                             std::move(cgroup)};
+    }
+
+    auto stream_pipes(int done_fd, int stdout_fd, int stderr_fd, stream_options const &options)
+        -> std::expected<stream_result, spawn_error>
+    {
+        tail_buffer stdout_tail{options.tail_bytes};
+        tail_buffer stderr_tail{options.tail_bytes};
+        std::optional<segmented_log> stdout_log{};
+        std::optional<segmented_log> stderr_log{};
+        if (options.directory)
+        {
+            stdout_log.emplace(*options.directory, "stdout", options.segment_bytes);
+            stderr_log.emplace(*options.directory, "stderr", options.segment_bytes);
+        }
+
+        auto pumped = pump_until_exit(done_fd, stdout_fd, stderr_fd, [&](int fd) -> std::expected<bool, spawn_error>
+        {
+            auto const is_stdout = fd == stdout_fd;
+            auto &tail = is_stdout ? stdout_tail : stderr_tail;
+            auto &log = is_stdout ? stdout_log : stderr_log;
+            auto pumped_fd = log ? log->pump(fd, tail) : pump_to_tail(fd, tail);
+            if (not pumped_fd)
+                return std::unexpected(log ? spawn_error::log_failed : spawn_error::read_failed);
+            return pumped_fd.value();
+        });
+        if (not pumped)
+            return std::unexpected(pumped.error());
+
+        return stream_result{
+            .status = {},
+            .stdout_tail = stdout_tail.str(),
+            .stderr_tail = stderr_tail.str(),
+            .stdout_bytes = stdout_log ? stdout_log->bytes_written() : stdout_tail.bytes_seen(),
+            .stderr_bytes = stderr_log ? stderr_log->bytes_written() : stderr_tail.bytes_seen(),
+        };
+    }
+
+    auto run(spawn_options const &options) -> std::expected<process_output, spawn_error>
+    {
+        auto child = spawn(options);
+        if (not child)
+            return std::unexpected(child.error());
+        return child->wait();
+    }
+
+    auto run_streamed(spawn_options const &options, stream_options const &streams) -> std::expected<stream_result, spawn_error>
+    {
+        auto child = spawn(options);
+        if (not child)
+            return std::unexpected(child.error());
+        return child->stream(streams);
+    }
+
+} // namespace cosmos::inline v1
@@ -0,0 +1,172 @@
+// posix_spawn based process launcher (replaces the popen path for task execution)
+#pragma once
+
+// *** Project Includes ***
+#include "cgroup.hpp"
+
+// *** Standard Includes ***
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace cosmos::inline v1
+{
+    enum class spawn_error : uint8_t
+    {
+        no_arguments,
+        pipe_failed,
+        spawn_failed,
+        pidfd_failed,
+        epoll_failed,
+        read_failed,
+        wait_failed,
+        log_failed,
+        worker_failed,
+        memfd_failed,
+        cgroup_failed
+    };
+
+    [[nodiscard]] auto to_string_view(spawn_error error) noexcept -> std::string_view;
+
+    struct spawn_options
+    {
+        // arguments[0] is the program. Without a '/' it is looked up on PATH, otherwise it is
+        // resolved relative to working_directory (the chdir happens before the exec).
+        std::vector<std::string> arguments{};
+        std::optional<std::filesystem::path> working_directory{};
+        // Added to (or overriding) the daemon's environment, or the whole environment when
+        // inherit_environment is false.
+        std::vector<std::pair<std::string, std::string>> environment{};
+        bool inherit_environment{true};
+        // Extra descriptors handed to the child as {parent fd, child fd}, e.g. a control socket on fd 3.
+        std::vector<std::pair<int, int>> inherited_fds{};
+        // Run the child in its own cgroup under this parent (limits + exact accounting). Spawning still
+        // succeeds without one when the hierarchy is not writable, unless limits are set (cgroup_failed).
+        std::optional<cgroup_options> cgroup{};
+    };
+
+    struct exit_status
+    {
+        int code{};
+        int signal{};
+        bool core_dumped{};
+
+        [[nodiscard]] auto exited() const noexcept -> bool { return signal == 0; }
+        [[nodiscard]] auto success() const noexcept -> bool { return exited() and code == 0; }
+    };
+
+    [[nodiscard]] auto to_string(exit_status const& status) -> std::string;
+
+    /**
+     * @brief decodes a raw waitpid(2) status.
+     */
+    [[nodiscard]] auto to_exit_status(int wait_status) noexcept -> exit_status;
+
+    struct process_output
+    {
+        exit_status status{};
+        std::string standard_output{};
+        std::string standard_error{};
+        resource_usage usage{};
+    };
+
+    struct stream_options
+    {
+        // Without a directory the output is only kept in the tails.
+        std::optional<std::filesystem::path> directory{};
+        std::size_t segment_bytes{64 * 1024 * 1024};
+        std::size_t tail_bytes{8 * 1024};
+    };
+
+    struct stream_result
+    {
+        exit_status status{};
+        std::string stdout_tail{};
+        std::string stderr_tail{};
+        std::uint64_t stdout_bytes{};
+        std::uint64_t stderr_bytes{};
+        resource_usage usage{};
+    };
+
+    /**
+     * @brief owns a spawned child: its pid, a pidfd for exit notification and the read ends of
+     * the stdout/stderr pipes. A child that is dropped without being waited on is killed and reaped.
+     */
+    class child_process
+    {
+    public:
+        child_process() = default;
+        child_process(pid_t pid, int pidfd, int stdout_fd, int stderr_fd, task_cgroup cgroup = {}) noexcept
+            : pid_{pid}, pidfd_{pidfd}, stdout_fd_{stdout_fd}, stderr_fd_{stderr_fd}, cgroup_{std::move(cgroup)} {}
+
+        child_process(child_process const&) = delete;
+        child_process& operator=(child_process const&) = delete;
+        child_process(child_process&& other) noexcept;
+        child_process& operator=(child_process&& other) noexcept;
+        ~child_process();
+
+        [[nodiscard]] auto pid() const noexcept -> pid_t { return pid_; }
+        [[nodiscard]] auto pidfd() const noexcept -> int { return pidfd_; }
+        [[nodiscard]] auto stdout_fd() const noexcept -> int { return stdout_fd_; }
+        [[nodiscard]] auto stderr_fd() const noexcept -> int { return stderr_fd_; }
+        [[nodiscard]] auto cgroup() const noexcept -> task_cgroup const& { return cgroup_; }
+
+        /**
+         * @brief drives an epoll loop over stdout, stderr and the pidfd until the child exits,
+         * then reaps it with wait4(2) and collects its resource usage.
+         */
+        [[nodiscard]] auto wait() -> std::expected<process_output, spawn_error>;
+
+        /**
+         * @brief like wait(), but streams stdout/stderr into segmented log files under
+         * options.directory and keeps only a bounded tail of each in memory.
+         */
+        [[nodiscard]] auto stream(stream_options const& options) -> std::expected<stream_result, spawn_error>;
+
+        auto kill(int signal) const noexcept -> bool;
+
+    private:
+        auto reap() noexcept -> std::expected<exit_status, spawn_error>;
+        auto close_fds() noexcept -> void;
+        auto release() noexcept -> void;
+
+        pid_t pid_{-1};
+        int pidfd_{-1};
+        int stdout_fd_{-1};
+        int stderr_fd_{-1};
+        task_cgroup cgroup_{};
+        std::chrono::steady_clock::time_point started_{std::chrono::steady_clock::now()};
+        resource_usage usage_{};
+    };
+
+    [[nodiscard]] auto spawn(spawn_options const& options) -> std::expected<child_process, spawn_error>;
+
+    /**
+     * @brief pumps the non-blocking stdout/stderr read ends into logs and tails until `done_fd` turns
+     * readable (a pidfd, or a socket the result arrives on) and the pipes are drained. The status is
+     * left for the caller to fill in.
+     */
+    [[nodiscard]] auto stream_pipes(int done_fd, int stdout_fd, int stderr_fd, stream_options const& options)
+        -> std::expected<stream_result, spawn_error>;
+
+    /**
+     * @brief spawn + wait, the drop-in replacement for execute_command. Buffers all output, prefer
+     * run_streamed for tasks.
+     */
+    [[nodiscard]] auto run(spawn_options const& options) -> std::expected<process_output, spawn_error>;
+
+    /**
+     * @brief spawn + stream, memory stays bounded by the tail sizes however much the child prints.
+     */
+    [[nodiscard]] auto run_streamed(spawn_options const& options, stream_options const& streams)
+        -> std::expected<stream_result, spawn_error>;
+
+} // namespace cosmos::inline v1
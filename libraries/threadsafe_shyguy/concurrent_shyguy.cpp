@@ -1,50 +1,235 @@
 
 #include "concurrent_shyguy.hpp"
 
-#include <process/system_execution.hpp>
+#include "interpreter_pool.hpp"
+#include "memory_file.hpp"
+#include "subprocess.hpp"
+#include "task_system/task_system.hpp"
 
 #include <range/v3/all.hpp>
 #include <spdlog/spdlog.h>
 
 #include <cron_parser/cron_expression.hpp>
+#include <cron_parser/cron_iterator.hpp>
 #include <blocking_priority_queue.hpp>
 #include <task_request.hpp>
 
+#include <charconv>
+#include <limits>
+#include <mutex>
 #include <ranges>
+#include <shared_mutex>
 #include <span>
+#include <unordered_set>
 
 namespace cosmos::inline v1
 {
-    auto concurrent_shyguy::make_task_metadata(shyguy_task const &task) const -> std::optional<task_metadata>
+    namespace
+    {
+        // What execute answers: the run that will serve the request.
+        [[nodiscard]] auto run_receipt(std::uint64_t run_id, std::size_t merged) -> std::string
+        {
+            return fmt::format(R"({{"run_id":{},"merged":{}}})", run_id, merged);
+        }
+
+        // Past runs a DAG snapshot carries, from the run history.
+        constexpr std::size_t snapshot_history_runs = 16;
+
+        // Resolves a task's script to its content-addressed cache file, writing it on first use.
+        [[nodiscard]] auto materialize_script(data_storage const &store, std::string const &blob_id,
+                                              content_cache::content_ptr const &content)
+            -> std::expected<std::filesystem::path, storage_error>
+        {
+            auto const &scripts = store->scripts();
+            if (scripts.contains(blob_id))
+                return scripts.path_of(blob_id);
+            return scripts.materialize(blob_id, *content);
+        }
+
+        [[nodiscard]] auto to_task_usage(resource_usage const &usage) noexcept -> task_usage
+        {
+            return task_usage{
+                .wall_us = static_cast<std::uint64_t>(usage.wall.count()),
+                .user_cpu_us = static_cast<std::uint64_t>(usage.user_cpu.count()),
+                .system_cpu_us = static_cast<std::uint64_t>(usage.system_cpu.count()),
+                .max_rss_bytes = std::max(usage.max_rss_bytes, usage.memory_peak_bytes),
+                .read_bytes = usage.read_bytes,
+                .write_bytes = usage.write_bytes,
+                .voluntary_switches = usage.voluntary_switches,
+                .involuntary_switches = usage.involuntary_switches,
+            };
+        }
+
+        [[nodiscard]] auto launch_arguments(task_type type, std::filesystem::path const &script) -> std::vector<std::string>
+        {
+            switch (type)
+            {
+                case task_type::python:
+                    return {"python3", script.string()};
+                case task_type::shell:
+                    return {"/bin/sh", script.string()};
+                default:
+                    return {script.string()};
+            }
+        }
+
+        using environment_t = std::vector<std::pair<std::string, std::string>>;
+
+        // What a spawned task learns about its run: the logical time (seconds since the epoch, UTC).
+        [[nodiscard]] auto run_environment(run_progress const &progress) -> environment_t
+        {
+            auto const logical = std::chrono::duration_cast<std::chrono::seconds>(progress.logical_time.time_since_epoch());
+            return {{"SHYGUY_LOGICAL_TIME", std::to_string(logical.count())},
+                    {"SHYGUY_RUN_ID", std::to_string(progress.run_id)}};
+        }
+
+        // Runs the task from a sealed memfd filled from the cached content: nothing is written to disk.
+        [[nodiscard]] auto run_in_memory(std::string const &blob_id, content_cache::content_ptr const &content,
+                                         task_type type, task_launch_options const &launch,
+                                         stream_options const &streams, environment_t environment)
+            -> std::expected<stream_result, spawn_error>
+        {
+            auto script = memory_file::from_bytes(blob_id, *content);
+            if (not script)
+                return std::unexpected(script.error());
+
+            if (type == task_type::python and launch.python_pool)
+                return launch.python_pool->run_script(script.value(), streams, launch.cgroup);
+            return run_streamed({.arguments = launch_arguments(type, memory_file::child_path()),
+                                 .environment = std::move(environment),
+                                 .inherited_fds = {script->inherit()},
+                                 .cgroup = launch.cgroup},
+                                streams);
+        }
+
+        // Cron times are wall-clock, the request queue runs on the steady clock.
+        [[nodiscard]] auto to_steady(std::chrono::system_clock::time_point when) noexcept
+            -> std::chrono::steady_clock::time_point
+        {
+            auto const wait = when - std::chrono::system_clock::now();
+            return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(wait);
+        }
+
+        // Publishes the task's state as it starts and, on every way out, its outcome: to the run's
+        // progress and, when there is storage, to the run history.
+        struct task_state_guard
+        {
+            run_progress &progress;
+            std::size_t index;
+            fs_run_log const *history;
+            run_record record;
+            task_run_state outcome{task_run_state::failed};
+
+            task_state_guard(run_progress &p, std::size_t i, fs_run_log const *h, run_record r) noexcept :
+                progress{p}, index{i}, history{h}, record{std::move(r)}
+            {
+                progress.set(index, task_run_state::running);
+                record.started = std::chrono::system_clock::now();
+                record.exit_code = -1;
+            }
+            task_state_guard(task_state_guard const &) = delete;
+            task_state_guard &operator=(task_state_guard const &) = delete;
+            ~task_state_guard()
+            {
+                progress.set(index, outcome);
+                if (not history)
+                    return;
+                record.status = outcome == task_run_state::succeeded ? dag_run_status::success : dag_run_status::failed;
+                record.finished = std::chrono::system_clock::now();
+                (void) history->append(record);
+            }
+        };
+
+        // Pooled python interpreters are forked before the run exists and do not get its environment.
+        [[nodiscard]] auto run_from_file(std::filesystem::path const &script, task_type type,
+                                         task_launch_options const &launch, stream_options const &streams,
+                                         environment_t environment) -> std::expected<stream_result, spawn_error>
+        {
+            if (type == task_type::python and launch.python_pool)
+                return launch.python_pool->run_script(script, streams, launch.cgroup);
+            return run_streamed({.arguments = launch_arguments(type, script), .environment = std::move(environment),
+                                 .cgroup = launch.cgroup},
+                                streams);
+        }
+    } // namespace
+
+    auto concurrent_shyguy::find_dag(std::string const &name) const -> dag_state_ptr
     {
-        std::optional<std::string> cron_expression{};
+        std::shared_lock lock(directory_mutex);
+        auto const found = dags.find(name);
+        return found == dags.end() ? nullptr : found->second;
+    }
 
-        if (auto const in_memory = schedules.find(task.associated_dag); in_memory != schedules.end())
-        {
-            cron_expression = in_memory->second;
-        }
-        else if (storage)
-        {
-            auto dag_entry = storage->dags().get_dag(task.associated_dag);
-            if (dag_entry and dag_entry->value.schedule and not dag_entry->value.schedule->empty())
-                cron_expression = dag_entry->value.schedule.value();
-        }
+    auto concurrent_shyguy::publish(dag_state &state, std::shared_ptr<dag_shape const> shape,
+                                    std::vector<run_progress_ptr> runs) -> void
+    {
+        std::erase_if(runs, [](auto const &run) { return run->done(); });
+        auto view = std::make_shared<dag_view>(dag_view{
+            .version = view_epoch.fetch_add(1, std::memory_order_relaxed) + 1,
+            .shape = std::move(shape),
+            .runs = std::move(runs),
+        });
+        state.view.store(std::move(view), std::memory_order_release);
+    }
+
+    auto concurrent_shyguy::publish_shape(dag_state &state, shape_tasks tasks) -> void
+    {
+        auto const current = state.view.load(std::memory_order_acquire);
+        publish(state, std::make_shared<dag_shape const>(std::string{state.graph.view_name()}, state.schedule, std::move(tasks)),
+                current ? current->runs : std::vector<run_progress_ptr>{});
+    }
 
-        if (not cron_expression or cron_expression->empty())
+    auto concurrent_shyguy::make_task_metadata(std::optional<cron_tab_str> const &schedule) const
+        -> std::optional<task_metadata>
+    {
+        // The in-memory DAG is authoritative: no storage read while its lock is held.
+        if (not schedule or schedule->empty())
             return std::nullopt;
 
         task_metadata metadata{};
-        metadata.schedule.cron_expression = *cron_expression;
-        metadata.schedule.frequency = classify_schedule(*cron_expression);
+        metadata.schedule.cron_expression = *schedule;
+        metadata.schedule.frequency = classify_schedule(*schedule);
         return metadata;
     }
 
+    auto concurrent_shyguy::run_log_directory(std::string_view dag_name, std::uint64_t run_id,
+                                              std::string_view task_name) const -> std::filesystem::path
+    {
+        auto const root = storage ? storage->root() : std::filesystem::path{};
+        return root / "logs" / "runs" / dag_name / std::to_string(run_id) / task_name;
+    }
+
+    auto concurrent_shyguy::first_unused_run_id() const -> std::uint64_t
+    {
+        if (not storage)
+            return 0;
+        std::uint64_t next = storage->runs().highest_run_id().transform([](std::uint64_t id) { return id + 1; }).value_or(0);
+
+        // Task logs are opened truncated, so a reused id would overwrite the old run's logs.
+        std::error_code ec;
+        auto const logs = storage->root() / "logs" / "runs";
+        for (auto dag = std::filesystem::directory_iterator(logs, ec); not ec and dag != std::filesystem::directory_iterator{};
+             dag.increment(ec))
+        {
+            std::error_code run_ec;
+            for (auto run = std::filesystem::directory_iterator(dag->path(), run_ec);
+                 not run_ec and run != std::filesystem::directory_iterator{}; run.increment(run_ec))
+            {
+                auto const name = run->path().filename().string();
+                std::uint64_t id{0};
+                if (auto const [end, error] = std::from_chars(name.data(), name.data() + name.size(), id);
+                    error == std::errc{} and end == name.data() + name.size())
+                    next = std::max(next, id + 1);
+            }
+        }
+        return next;
+    }
+
     auto concurrent_shyguy::process(shyguy_request const &request) noexcept -> command_result_type
     {
-        std::lock_guard lock(mutex);
         return request.data | match
                {
-                       [this, command = request.command](requestable auto const &dag_or_task) -> command_result_type
+                       [this, command = request.command, &key = request.idempotency_key](requestable auto const &dag_or_task) -> command_result_type
                        {
                            switch (command)
                            {
@@ -53,7 +238,10 @@ namespace cosmos::inline v1
                                case command_enum::remove:
                                    return remove(dag_or_task);
                                case command_enum::execute:
-                                   return execute(dag_or_task);
+                                   if constexpr (std::same_as<std::remove_cvref_t<decltype(dag_or_task)>, shyguy_dag>)
+                                       return execute(dag_or_task, key);
+                                   else
+                                       return execute(dag_or_task);
                                case command_enum::snapshot:
                                    return snapshot(dag_or_task);
                                default:
@@ -66,164 +254,500 @@ namespace cosmos::inline v1
 
     auto concurrent_shyguy::create(shyguy_dag const &dag) noexcept -> command_result_type
     {
-        if (auto const dag_found = dags.find(dag.name); dag_found != dags.end())
-            return std::unexpected(command_error::dag_duplicate);
-
-        if (auto [_, in] = dags.emplace(dag.name, directed_acyclic_graph(dag.name)); not in)
-            return std::unexpected(command_error::dag_insertion_failed);
+        if (auto const existing = find_dag(dag.name))
+        {
+            std::shared_lock lock(existing->mutex);
+            if (not existing->removed)
+            {
+                // Re-submitting a DAG with another cron expression changes its schedule.
+                auto const changed = existing->schedule ? dag.schedule != existing->schedule : has_schedule(dag);
+                lock.unlock();
+                if (changed)
+                    return reschedule(dag);
+                return std::unexpected(command_error::dag_duplicate);
+            }
+        }
 
+        // Published already locked: requests for this DAG wait until it is persisted, other DAGs do not.
+        auto state = std::make_shared<dag_state>(dag.name);
+        std::unique_lock lock(state->mutex);
         if (has_schedule(dag))
-            schedules.emplace(dag.name, dag.schedule.value());
+            state->schedule = dag.schedule;
+        publish_shape(*state, {});
 
-        // persist into storage if available
-        if (storage)
         {
-            (void) storage->dags().upsert_dag(dag, std::nullopt);
+            std::unique_lock directory(directory_mutex);
+            if (auto [_, in] = dags.try_emplace(dag.name, state); not in)
+                return std::unexpected(command_error::dag_duplicate);
+
+            // Together with the directory, so a racing remove and re-create of the name cannot interleave.
+            if (state->schedule)
+            {
+                std::unique_lock schedules_lock(schedules_mutex);
+                (void) schedules.upsert(dag.name, *state->schedule, std::chrono::system_clock::now());
+            }
+            if (persistence)
+                persistence->upsert_dag(dag);
         }
+
         return log_return("created dag {}", dag.name);
     }
 
     auto concurrent_shyguy::remove(shyguy_dag const &dag) noexcept -> command_result_type
     {
-        if (bool const erased = dags.erase(dag.name); erased)
+        dag_state_ptr state{};
+        {
+            std::unique_lock directory(directory_mutex);
+            auto node = dags.extract(dag.name);
+            if (node.empty())
+                return std::unexpected(command_error::dag_deletion_failed);
+            state = std::move(node.mapped());
+
+            std::unique_lock schedules_lock(schedules_mutex);
+            state->removed = true;
+            (void) schedules.erase(dag.name);
+            if (persistence)
+                persistence->erase_dag(dag.name);
+        }
+
         {
-            if (has_schedule(dag))
-                schedules.erase(dag.name);
+            // Waits for requests already working on this DAG; later ones see `removed` and back off.
+            std::unique_lock lock(state->mutex);
 
-            // remove from storage if available
-            if (storage)
+            if (auto const cancelled = cancel_queued_runs(*state); cancelled > 0)
+                logger->info("cancelled {} queued run(s) of removed dag {}", cancelled, dag.name);
+
+            // A task create already past its `removed` check queued its write behind the erase: erase
+            // once more after it, unless the name was created again meanwhile.
+            if (persistence)
             {
-                (void) storage->dags().erase_dag(dag.name, std::nullopt);
+                std::shared_lock directory(directory_mutex);
+                if (not dags.contains(dag.name))
+                    persistence->erase_dag(dag.name);
             }
-            return log_return("removed dag {}", dag.name);
         }
 
-        return std::unexpected(command_error::dag_deletion_failed);
+        // Its cancelled backfill runs never finish, so nothing else would retire the job.
+        {
+            std::lock_guard jobs(backfills->mutex);
+            backfills->by_dag.erase(dag.name);
+        }
+
+        return log_return("removed dag {}", dag.name);
     }
 
-    auto concurrent_shyguy::execute(shyguy_dag const &dag) noexcept -> command_result_type
+    auto concurrent_shyguy::execute(shyguy_dag const &dag, std::optional<std::string> const &idempotency_key) noexcept
+        -> command_result_type
     {
-        return execute_at(dag, std::chrono::steady_clock::now());
+        return enqueue_run(dag, std::chrono::steady_clock::now(), false, idempotency_key);
     }
 
-    auto concurrent_shyguy::execute_at(shyguy_dag const& dag, std::chrono::steady_clock::time_point scheduled_time) noexcept
+    auto concurrent_shyguy::execute_at(shyguy_dag const& dag, std::chrono::steady_clock::time_point scheduled_time,
+                                       std::optional<std::chrono::system_clock::time_point> logical_time) noexcept
         -> command_result_type
     {
-        std::lock_guard lock(mutex);
-        auto const dag_iter = dags.find(dag.name);
-        if (dag_iter == end(dags))
+        return enqueue_run(dag, scheduled_time, true, std::nullopt, logical_time);
+    }
+
+    auto concurrent_shyguy::reschedule(shyguy_dag const &dag) noexcept -> command_result_type
+    {
+        auto const state = find_dag(dag.name);
+        if (not state)
+            return std::unexpected(command_error::dag_not_found);
+
+        std::unique_lock lock(state->mutex);
+        if (state->removed)
+            return std::unexpected(command_error::dag_not_found);
+
+        state->schedule = has_schedule(dag) ? dag.schedule : std::nullopt;
+        std::optional<std::chrono::steady_clock::time_point> next{};
+        {
+            // Checked again under schedules_mutex: remove() may have taken the entry out meanwhile.
+            std::unique_lock schedules_lock(schedules_mutex);
+            if (state->removed)
+                return std::unexpected(command_error::dag_not_found);
+            if (state->schedule)
+                (void) schedules.upsert(dag.name, *state->schedule, std::chrono::system_clock::now());
+            else
+                (void) schedules.erase(dag.name);
+            if (auto const when = schedules.next_time_of(dag.name))
+                next = to_steady(*when);
+            // Queued while `removed` is known to be false, so it cannot land after remove's erase.
+            if (persistence)
+                persistence->upsert_dag(dag);
+        }
+
+        auto const now = std::chrono::steady_clock::now();
+        std::size_t moved{0};
+        std::size_t cancelled{0};
+        std::vector<run_progress const *> dropped{};
+        std::lock_guard runs_lock(state->runs_mutex);
+        for (auto const &run: state->queued_runs)
+        {
+            // Only runs that are still waiting for their old time; due ones go ahead.
+            auto const when = run.from_schedule ? request_queue->scheduled_time(run.handle) : std::nullopt;
+            if (not when or *when <= now)
+                continue;
+            if (next and request_queue->reschedule(run.handle, *next))
+            {
+                run.progress->scheduled_time.store(*next, std::memory_order_relaxed);
+                ++moved;
+            }
+            else if (not next and request_queue->erase(run.handle))
+            {
+                dropped.push_back(run.progress.get());
+                ++cancelled;
+            }
+        }
+
+        auto const current = state->view.load(std::memory_order_acquire);
+        auto runs = current->runs;
+        std::erase_if(runs, [&dropped](auto const &run) { return std::ranges::find(dropped, run.get()) != dropped.end(); });
+        publish(*state,
+                std::make_shared<dag_shape const>(current->shape->name, state->schedule, current->shape->tasks),
+                std::move(runs));
+
+        return log_return("rescheduled dag {} ({} queued run(s) moved, {} cancelled)", dag.name, moved, cancelled);
+    }
+
+    auto concurrent_shyguy::cancel_queued_runs(dag_state &state) noexcept -> std::size_t
+    {
+        std::lock_guard lock(state.runs_mutex);
+        auto const cancelled = std::ranges::count_if(state.queued_runs,
+                                                     [this](auto const &run) { return request_queue->erase(run.handle); });
+        state.queued_runs.clear();
+        return static_cast<std::size_t>(cancelled);
+    }
+
+    auto concurrent_shyguy::enqueue_run(shyguy_dag const &dag, std::chrono::steady_clock::time_point scheduled_time,
+                                        bool from_schedule, std::optional<std::string> const &idempotency_key,
+                                        std::optional<std::chrono::system_clock::time_point> logical_time,
+                                        backfill_fire *backfill) noexcept -> command_result_type
+    {
+        auto const state = find_dag(dag.name);
+        if (not state)
             return std::unexpected(command_error::dag_not_found);
 
-        auto const ordered_tasks = dag_iter->second.run_order();
+        // Shared: other reads and runs of this DAG go on, edits of its graph wait until the payload is built.
+        std::shared_lock lock(state->mutex);
+        if (state->removed)
+            return std::unexpected(command_error::dag_not_found);
+
+        std::lock_guard runs_lock(state->runs_mutex);
+        // Forget runs the executor already took, so the list stays as short as the queue.
+        auto &runs = state->queued_runs;
+        std::erase_if(runs, [this](auto const &run) { return not request_queue->contains(run.handle); });
+
+        auto const now = std::chrono::steady_clock::now();
+        auto &keys = state->recent_keys;
+        std::erase_if(keys, [now](auto const &entry) { return entry.second.expires <= now; });
+        auto const remember = [&](run_progress_ptr const &progress)
+        {
+            if (idempotency_key)
+                keys.insert_or_assign(*idempotency_key, keyed_run{progress, now + launch_options.idempotency_window});
+        };
+        auto const merge_into = [&](run_progress_ptr const &progress) -> command_result_type
+        {
+            remember(progress);
+            auto const merged = progress->merged.fetch_add(1, std::memory_order_relaxed) + 1;
+            logger->info("merged execute of dag {} into run {} ({} merged)", dag.name, progress->run_id, merged);
+            return run_receipt(progress->run_id, merged);
+        };
+
+        // A retry within the window gets the run the first request queued, even if it already started.
+        if (idempotency_key)
+            if (auto const found = keys.find(*idempotency_key); found != keys.end())
+                return merge_into(found->second.progress);
+
+        auto const current = state->view.load(std::memory_order_acquire);
+        if (from_schedule)
+        {
+            // A scheduled run still waiting for a later time is moved rather than duplicated.
+            for (auto const &run: runs)
+            {
+                auto const when = run.from_schedule ? request_queue->scheduled_time(run.handle) : std::nullopt;
+                if (when and *when > now and request_queue->reschedule(run.handle, scheduled_time))
+                {
+                    run.progress->scheduled_time.store(scheduled_time, std::memory_order_relaxed);
+                    logger->info("moved queued run of dag {} to its next scheduled time", dag.name);
+                    return run_receipt(run.progress->run_id, run.progress->merged.load(std::memory_order_relaxed));
+                }
+            }
+        }
+        else if (not backfill)
+        {
+            // Another execute of the same DAG version that is due but not started covers this one.
+            for (auto const &run: runs)
+            {
+                auto const identical = not run.backfill and run.shape == current->shape;
+                auto const when = identical ? request_queue->scheduled_time(run.handle) : std::nullopt;
+                if (when and *when <= now)
+                    return merge_into(run.progress);
+            }
+        }
+
+        auto const ordered_tasks = state->graph.run_order();
 
         if (not ordered_tasks)
             return std::unexpected(command_error::task_creates_cycle);
 
         auto const &order = ordered_tasks.value();
+        auto const run_id = task_request_sequence.fetch_add(1U, std::memory_order_relaxed);
+        if (backfill)
+            logical_time = backfill->logical_time;
+        else if (not logical_time)
+            logical_time = std::chrono::system_clock::now()
+                           + std::chrono::duration_cast<std::chrono::system_clock::duration>(scheduled_time - now);
+        auto progress = std::make_shared<run_progress>(run_id, scheduled_time,
+                                                       std::make_shared<std::vector<std::string> const>(order),
+                                                       *logical_time,
+                                                       backfill ? std::move(backfill->on_finished) : std::function<void()>{});
+        std::size_t next_index{0};
+
+        auto const profile_of = [&state](std::string const &task_name) -> task_profile const *
+        {
+            auto const found = state->profiles.find(task_name);
+            return found == state->profiles.end() ? nullptr : &found->second;
+        };
+
+        // Scripts each task's dependents will need: prefetched as the task starts, so they are
+        // usually cached by the time the dependents become ready.
+        std::unordered_map<std::string, std::vector<std::string>> dependent_blobs{};
+        std::vector<std::string> root_blobs{};
+        for (auto const &task_name: order)
+        {
+            auto const profile = profile_of(task_name);
+            if (not profile or not profile->blob_id)
+                continue;
+            auto const &dependencies = state->graph.dependencies_of(task_name);
+            if (dependencies.empty())
+                root_blobs.push_back(*profile->blob_id);
+            for (auto const &dependency: dependencies)
+                dependent_blobs[dependency].push_back(*profile->blob_id);
+        }
 
         auto tr = std::make_shared<task_request>(task_request{
             .scheduled_time = scheduled_time,
-            .sequence = task_request_sequence.fetch_add(1U, std::memory_order_relaxed),
+            .sequence = run_id,
             .payload = task_request_payload{
-            std::views::transform(order, [this, &dag](auto const& task_name)
+            std::views::transform(order, [&](auto const& task_name)
             {
                 task_runner runner{};
                 runner.name = task_name;
-                if (storage)
+                runner.index = next_index++;
+                std::optional<std::string> blob_id{};
+                auto type = task_type::unset;
+                std::shared_ptr<std::atomic_int64_t> expected_cost_us{};
+                if (auto const profile = profile_of(task_name))
                 {
-                    auto rv = storage->tasks().get_task(dag.name, task_name);
-                    if (rv && rv.value().value.file_content.has_value())
-                        runner.contents = rv.value().value.file_content.value();
+                    blob_id = profile->blob_id;
+                    type = profile->type;
+                    expected_cost_us = profile->expected_cost_us;
+                    runner.expected_cost = std::chrono::microseconds{expected_cost_us->load(std::memory_order_relaxed)};
                 }
+                auto prefetch = dependent_blobs.contains(task_name) ? std::move(dependent_blobs[task_name])
+                                                                    : std::vector<std::string>{};
 
-                runner.task_function = [this]() noexcept -> void
+                // Runs without any orchestrator lock: everything it touches is captured by value or is
+                // internally synchronized (storage, content cache, logger), so tasks of a wave really run
+                // in parallel. The script is resolved here, at launch, not when the run was queued.
+                runner.task_function = [store = storage, cache = contents, log = logger, launch = launch_options,
+                                        blob_id, type, expected_cost_us, prefetch = std::move(prefetch), progress,
+                                        index = runner.index, dag_name = dag.name, task_name,
+                                        log_directory = run_log_directory(dag.name, run_id, task_name)]() noexcept -> void
                 {
-                    std::lock_guard lock(mutex);
-                    std::string const command{"./task_executable"};
-                    if (auto output = execute_command(command); output)
-                        logger->info("Task executed successfully with output: {}", output.value());
+                    task_state_guard state_guard{*progress, index, store ? &store->runs() : nullptr,
+                                                 run_record{.run_id = progress->run_id, .dag = dag_name, .task = task_name,
+                                                            .logical_time = progress->logical_time}};
+                    if (not store or not blob_id or blob_id->empty())
+                    {
+                        log->error("Task {} in DAG {} has no runnable script", task_name, dag_name);
+                        return;
+                    }
+
+                    cache->prefetch(prefetch);
+                    auto const content = cache->get(*blob_id);
+                    if (not content)
+                    {
+                        log->error("Task {} in DAG {} has no runnable script", task_name, dag_name);
+                        return;
+                    }
+
+                    stream_options const streams{.directory = log_directory};
+                    auto output = std::expected<stream_result, spawn_error>{std::unexpected(spawn_error::memfd_failed)};
+                    if (launch.in_memory)
+                        output = run_in_memory(*blob_id, content.value(), type, launch, streams, run_environment(*progress));
+
+                    if (not output and output.error() == spawn_error::memfd_failed)
+                    {
+                        auto script = materialize_script(store, *blob_id, content.value());
+                        if (not script)
+                        {
+                            log->error("Task {} in DAG {} has no runnable script", task_name, dag_name);
+                            return;
+                        }
+                        output = run_from_file(script.value(), type, launch, streams, run_environment(*progress));
+                    }
+
+                    if (not output)
+                    {
+                        log->error("Task {} in DAG {} could not be launched: {}", task_name, dag_name,
+                                   to_string_view(output.error()));
+                        return;
+                    }
+
+                    state_guard.record.exit_code = output->status.exited() ? output->status.code : -output->status.signal;
+                    auto const &usage = output->usage;
+                    log->info("Task {} in DAG {} used {}us wall, {}us user, {}us sys, {} KiB max RSS", task_name,
+                              dag_name, usage.wall.count(), usage.user_cpu.count(), usage.system_cpu.count(),
+                              usage.max_rss_bytes / 1024U);
+                    auto const recorded = store->tasks().record_run(dag_name, task_name, to_task_usage(usage),
+                                                                    output->status.success());
+                    if (recorded and recorded->cost and expected_cost_us)
+                        expected_cost_us->store(static_cast<std::int64_t>(recorded->cost->mean_wall_us),
+                                                std::memory_order_relaxed);
+
+                    if (output->status.success())
+                    {
+                        state_guard.outcome = task_run_state::succeeded;
+                        log->info("Task {} in DAG {} succeeded ({} bytes of output in {}), tail: {}", task_name,
+                                  dag_name, output->stdout_bytes, log_directory.string(), output->stdout_tail);
+                    }
                     else
-                        logger->error("Task execution failed with exit code: {}", output.error());
+                        log->error("Task {} in DAG {} {} (logs in {}), stderr tail: {}", task_name, dag_name,
+                                   to_string(output->status), log_directory.string(), output->stderr_tail);
                 };
 
                 return runner;
             }) | ranges::v3::to<std::vector>(),
-            dag_iter->second
+            state->graph
         }});
 
-        request_queue->enqueue(std::move(tr));
+        contents->prefetch(root_blobs);
+        runs.push_back({.handle = request_queue->enqueue(std::move(tr)), .from_schedule = from_schedule,
+                        .progress = progress, .shape = current->shape, .backfill = backfill != nullptr});
+        remember(progress);
 
-        return std::unexpected(command_error::not_currently_supported);
+        auto published = current->runs;
+        published.push_back(std::move(progress));
+        publish(*state, current->shape, std::move(published));
+
+        return run_receipt(run_id, 0);
     }
 
-    auto concurrent_shyguy::snapshot(shyguy_dag const &) noexcept -> command_result_type
+    auto concurrent_shyguy::snapshot(shyguy_dag const &dag) noexcept -> command_result_type
     {
-        return std::unexpected(command_error::not_currently_supported);
+        auto const view = view_of(dag.name);
+        if (not view)
+            return std::unexpected(command_error::dag_not_found);
+        auto const history = storage ? storage->runs().last_runs(dag.name, snapshot_history_runs)
+                                     : std::vector<run_summary>{};
+        return to_json(*view, std::chrono::steady_clock::now(), history);
     }
 
-    auto concurrent_shyguy::create(shyguy_task const &task) noexcept -> command_result_type
+    auto concurrent_shyguy::view_of(std::string const &dag) const -> dag_view_ptr
     {
-        task_map.insert_or_assign(task.name, task);
-        auto &dag = dags.at(task.associated_dag);
-        if (auto const inserted = dag.push_task(task.name, task.dependency_names); not inserted)
-            return std::unexpected(static_cast<command_error>(inserted.error()));
+        auto const state = find_dag(dag);
+        return state ? state->view.load(std::memory_order_acquire) : nullptr;
+    }
 
-        auto metadata = storage ? make_task_metadata(task) : std::optional<task_metadata>{};
+    auto concurrent_shyguy::views() const -> std::vector<dag_view_ptr>
+    {
+        std::vector<dag_view_ptr> out{};
+        std::shared_lock lock(directory_mutex);
+        out.reserve(dags.size());
+        for (auto const &[_, state]: dags)
+            out.push_back(state->view.load(std::memory_order_acquire));
+        return out;
+    }
 
-        if (task.file_content and task.filename)
+    auto concurrent_shyguy::create(shyguy_task const &task) noexcept -> command_result_type
+    {
+        auto const state = find_dag(task.associated_dag);
+        if (not state)
+            return std::unexpected(command_error::dag_not_found);
+
+        // Blobs are content addressed: the id is known before the write, which is queued with the rest.
+        // The cache holds the script pinned until the write lands, so a run does not wait for (or miss) it.
+        std::optional<std::string> blob_id{};
+        if (task.file_content and task.filename and persistence)
         {
-            // also persist to storage
-            if (storage)
-            {
-                const auto bytes = std::as_bytes(
-                        std::span{std::data(*task.file_content), std::size(*task.file_content)});
-                if (auto id = storage->blobs().put_blob(bytes))
-                {
-                    (void) storage->tasks().upsert_task(task, *id, std::nullopt, metadata);
-                }
-                else
-                {
-                    spdlog::warn("blob store put failed for task {}", task.name);
-                    (void) storage->tasks().upsert_task(task, std::nullopt, std::nullopt, metadata);
-                }
-            }
+            const auto bytes = std::as_bytes(std::span{std::data(*task.file_content), std::size(*task.file_content)});
+            blob_id = fs_blob_store::id_of(bytes);
+            std::vector<std::byte> content{bytes.begin(), bytes.end()};
+            contents->pin(*blob_id, content);
+            persistence->put_blob(*blob_id, std::move(content));
         }
+
+        std::unique_lock lock(state->mutex);
+        if (state->removed)
+            return std::unexpected(command_error::dag_not_found);
+
+        if (auto const inserted = state->graph.push_task(task.name, task.dependency_names); not inserted)
+            return std::unexpected(static_cast<command_error>(inserted.error()));
+
+        // The script lives in the blob store from here on; only the cache keeps (some of) them in memory.
+        auto &kept = state->tasks.insert_or_assign(task.name, task).first->second;
+        if (blob_id)
+            kept.file_content.reset();
+
+        auto &profile = state->profiles[task.name];
+        profile.blob_id = blob_id;
+        profile.type = to_task_type(task.type.value_or("unset"));
+
+        auto shaped = std::make_shared<dag_shape::task const>(dag_shape::task{
+            .name = task.name,
+            .dependencies = task.dependency_names.value_or(std::vector<std::string>{}),
+            .type = profile.type,
+            .has_script = blob_id.has_value(),
+        });
+        auto tasks = state->view.load(std::memory_order_acquire)->shape->tasks;
+        if (auto found = std::ranges::find(tasks, task.name, [](auto const &entry) { return entry->name; });
+            found != tasks.end())
+            *found = std::move(shaped);
         else
-        {
-            if (storage)
-            {
-                (void) storage->tasks().upsert_task(task, std::nullopt, std::nullopt, metadata);
-            }
-        }
+            tasks.push_back(std::move(shaped));
+        publish_shape(*state, std::move(tasks));
+
+        if (persistence)
+            persistence->upsert_task(task, blob_id, make_task_metadata(state->schedule));
 
         return log_return("Created New Task {}", task.name);
     }
 
     auto concurrent_shyguy::remove(shyguy_task const &task) noexcept -> command_result_type
     {
-        if (auto const dag = dags.find(task.associated_dag); dag != std::end(dags))
+        std::unique_lock<std::shared_mutex> lock{};
+        if (auto const state = find_dag(task.associated_dag))
         {
-            if (auto const removed = dag->second.remove_task(task.name); not removed)
-                return std::unexpected(static_cast<command_error>(removed.error()));
+            lock = std::unique_lock(state->mutex);
+            if (not state->removed)
+            {
+                if (auto const removed = state->graph.remove_task(task.name); not removed)
+                    return std::unexpected(static_cast<command_error>(removed.error()));
+                state->tasks.erase(task.name);
+                state->profiles.erase(task.name);
 
+                auto tasks = state->view.load(std::memory_order_acquire)->shape->tasks;
+                std::erase_if(tasks, [&task](auto const &entry) { return entry->name == task.name; });
+                publish_shape(*state, std::move(tasks));
+            }
         }
 
-        if (storage)
-        {
-            (void) storage->tasks().erase_task(task.associated_dag, task.name);
-        }
+        if (persistence)
+            persistence->erase_task(task.associated_dag, task.name);
         return log_return("Removed Task {}", task.name);
     }
 
     auto concurrent_shyguy::execute(shyguy_task const &task) noexcept -> command_result_type
     {
         using namespace std::string_literals;
-        std::lock_guard lock(mutex);
-        auto const dag = dags.find(task.associated_dag);
-        if (dag == std::end(dags))
+        auto const state = find_dag(task.associated_dag);
+        if (not state)
             return std::unexpected(command_error::dag_not_found);
 
-        auto const ordered_tasks = dag->second.run_order();
+        std::shared_lock lock(state->mutex);
+        auto const ordered_tasks = state->graph.run_order();
         if (not ordered_tasks)
             return std::unexpected(command_error::task_creates_cycle);
 
@@ -233,9 +757,23 @@ namespace cosmos::inline v1
         return std::unexpected(command_error::not_currently_supported);
     }
 
-    auto concurrent_shyguy::snapshot(shyguy_task const &) noexcept -> command_result_type
+    auto concurrent_shyguy::snapshot(shyguy_task const &task) noexcept -> command_result_type
     {
-        return std::unexpected(command_error::not_currently_supported);
+        auto const view = view_of(task.associated_dag);
+        if (not view)
+            return std::unexpected(command_error::dag_not_found);
+        if (auto json = to_json(*view, task.name))
+            return std::move(*json);
+        return std::unexpected(command_error::task_not_found);
+    }
+
+    auto concurrent_shyguy::flush() -> std::future<bool>
+    {
+        if (persistence)
+            return persistence->flush();
+        std::promise<bool> nothing_to_write{};
+        nothing_to_write.set_value(true);
+        return nothing_to_write.get_future();
     }
 
     auto concurrent_shyguy::process(std::monostate) const noexcept -> command_result_type
@@ -244,46 +782,349 @@ namespace cosmos::inline v1
         return std::unexpected(command_error::monostate_reached);
     }
 
-    auto concurrent_shyguy::next_scheduled_dag() const noexcept -> std::optional<notification_type>
+    concurrent_shyguy::~concurrent_shyguy()
+    {
+        std::lock_guard lock(backfills->mutex);
+        backfills->owner = nullptr;
+        backfills->by_dag.clear();
+    }
+
+    auto concurrent_shyguy::backfill(shyguy_dag const &dag, std::chrono::system_clock::time_point from,
+                                     std::chrono::system_clock::time_point to, std::size_t parallelism) noexcept
+        -> std::expected<backfill_report, command_error>
+    {
+        auto const state = find_dag(dag.name);
+        if (not state)
+            return std::unexpected(command_error::dag_not_found);
+
+        std::optional<cron_tab_str> schedule{};
+        {
+            std::shared_lock lock(state->mutex);
+            schedule = state->schedule;
+        }
+        if (not schedule)
+            return std::unexpected(command_error::dag_not_scheduled);
+
+        backfill_report report{};
+        backfill_job job{.parallelism = std::max<std::size_t>(parallelism, 1)};
+        try
+        {
+            geheb::cron_iterator fires{geheb::cron_expression{*schedule}, from};
+            for (auto fire = fires.next(); fire != decltype(fire){} and fire <= to; fire = fires.next())
+            {
+                if (job.fires.size() == max_backfill_runs)
+                {
+                    report.truncated = true;
+                    break;
+                }
+                job.fires.push_back(fire);
+            }
+        }
+        catch (std::exception const &)
+        {
+            return std::unexpected(command_error::dag_schedule_not_valid);
+        }
+
+        report.fires = job.fires.size();
+        std::lock_guard lock(backfills->mutex);
+        backfills->by_dag.erase(dag.name);
+        if (job.fires.empty())
+            return report;
+
+        auto &queued = backfills->by_dag.insert_or_assign(dag.name, std::move(job)).first->second;
+        report.queued = launch_backfill_runs(dag.name, queued);
+        logger->info("backfilling {} run(s) of dag {}{}, {} at a time", report.fires, dag.name,
+                     report.truncated ? " (truncated)" : "", queued.parallelism);
+        return report;
+    }
+
+    auto concurrent_shyguy::launch_backfill_runs(std::string const &dag, backfill_job &job) -> std::size_t
+    {
+        std::size_t launched{0};
+        while (job.in_flight < job.parallelism and job.next < job.fires.size())
+        {
+            backfill_fire fire{
+                .logical_time = job.fires[job.next],
+                .on_finished = [jobs = std::weak_ptr{backfills}, dag]
+                {
+                    auto const shared = jobs.lock();
+                    if (not shared)
+                        return;
+                    std::lock_guard lock(shared->mutex);
+                    if (shared->owner)
+                        shared->owner->backfill_run_finished(dag);
+                },
+            };
+            auto const queued = enqueue_run(shyguy_dag{.name = dag}, std::chrono::steady_clock::now(), false,
+                                            std::nullopt, std::nullopt, &fire);
+            if (not queued)
+            {
+                // The DAG is gone or no longer runnable: the remaining fires are dropped.
+                logger->warn("backfill of dag {} stopped after {} of {} run(s)", dag, job.next, job.fires.size());
+                job.next = job.fires.size();
+                break;
+            }
+            ++job.next;
+            ++job.in_flight;
+            ++launched;
+        }
+        return launched;
+    }
+
+    auto concurrent_shyguy::backfill_run_finished(std::string const &dag) -> void
+    {
+        auto const found = backfills->by_dag.find(dag);
+        if (found == backfills->by_dag.end())
+            return;
+        auto &job = found->second;
+        job.in_flight -= std::min<std::size_t>(job.in_flight, 1);
+        (void) launch_backfill_runs(dag, job);
+        if (job.in_flight == 0 and job.next == job.fires.size())
+        {
+            logger->info("backfill of dag {} finished ({} run(s))", dag, job.fires.size());
+            backfills->by_dag.erase(found);
+        }
+    }
+
+    auto concurrent_shyguy::catch_up(std::size_t parallelism) noexcept -> std::size_t
+    {
+        if (not storage)
+            return 0;
+
+        std::vector<std::string> scheduled{};
+        {
+            std::shared_lock lock(directory_mutex);
+            for (auto const &[name, state]: dags)
+                if (state->schedule)
+                    scheduled.push_back(name);
+        }
+
+        auto const now = std::chrono::system_clock::now();
+        std::size_t missed{0};
+        for (auto const &name: scheduled)
+        {
+            // From the latest fire that ran, not from when it ran: a run that started late (spread,
+            // rate limited or queued) would otherwise skip the fire after it or repeat its own.
+            auto const recorded = storage->runs().last_runs(name, std::numeric_limits<std::size_t>::max());
+            if (recorded.empty())
+                continue;
+            auto const latest = std::ranges::max(recorded | std::views::transform(&run_summary::logical_time));
+            if (auto const report = backfill(shyguy_dag{.name = name}, latest, now, parallelism))
+                missed += report->fires;
+        }
+        return missed;
+    }
+
+    auto concurrent_shyguy::warm_start(unsigned threads) noexcept -> std::expected<warm_start_report, storage_error>
+    {
+        using clock = std::chrono::steady_clock;
+        warm_start_report report{};
+        if (not storage)
+            return report;
+
+        auto const started = clock::now();
+        auto lap = started;
+        auto const elapsed = [&lap]
+        {
+            auto const now = clock::now();
+            return std::chrono::duration_cast<std::chrono::microseconds>(now - std::exchange(lap, now));
+        };
+
+        auto names = storage->dags().list_dag_names();
+        if (not names)
+            return std::unexpected(names.error());
+        report.scan = elapsed();
+
+        struct loaded_dag
+        {
+            std::optional<shyguy_dag> dag{};
+            std::vector<task_entry> tasks{};
+            dag_state_ptr state{};
+            std::size_t dropped{0};
+        };
+        std::vector<loaded_dag> loaded(names->size());
+
+        // One job per chunk of DAGs; the pool's destructor runs every job before it returns.
+        auto const for_each_dag = [&](auto const &work)
+        {
+            constexpr std::size_t chunk = 32;
+            jx::task_system pool{jx::task_system_options{.threads = threads}};
+            for (std::size_t first = 0; first < loaded.size(); first += chunk)
+                pool.async([&work, first, last = std::min(first + chunk, loaded.size())]
+                {
+                    for (auto i = first; i < last; ++i)
+                        work(i);
+                });
+        };
+
+        for_each_dag([&](std::size_t i)
+        {
+            auto const &name = (*names)[i];
+            if (auto dag = storage->dags().get_dag(name))
+                loaded[i].dag = std::move(dag->value);
+            if (auto tasks = storage->tasks().list_tasks(name))
+                loaded[i].tasks = std::move(tasks.value());
+        });
+        report.load = elapsed();
+
+        for_each_dag([&](std::size_t i)
+        {
+            auto &entry = loaded[i];
+            if (not entry.dag)
+                return;
+
+            auto state = std::make_shared<dag_state>(entry.dag->name);
+            if (has_schedule(*entry.dag))
+                state->schedule = entry.dag->schedule;
+
+            // Dependencies on tasks that are gone are dropped, as remove(task) does in memory.
+            std::unordered_set<std::string> known{entry.dag->name};
+            for (auto const &task: entry.tasks)
+                known.insert(task.value.name);
+            std::vector<std::pair<std::string, std::vector<std::string>>> nodes{};
+            nodes.reserve(entry.tasks.size());
+            for (auto &task: entry.tasks)
+            {
+                auto depends = task.value.dependency_names.value_or(std::vector<std::string>{});
+                entry.dropped += static_cast<std::size_t>(std::erase_if(depends, [&known](auto const &d) { return not known.contains(d); }));
+                task.value.dependency_names = depends;
+                nodes.emplace_back(task.value.name, std::move(depends));
+            }
+            if (not state->graph.push_tasks(nodes))
+                return;
+
+            shape_tasks shape{};
+            shape.reserve(entry.tasks.size());
+            for (auto &task: entry.tasks)
+            {
+                auto &profile = state->profiles[task.value.name];
+                if (task.blob_id and not task.blob_id->empty())
+                    profile.blob_id = task.blob_id;
+                profile.type = to_task_type(task.value.type.value_or("unset"));
+                if (task.metadata and task.metadata->cost)
+                    profile.expected_cost_us->store(static_cast<std::int64_t>(task.metadata->cost->mean_wall_us));
+
+                shape.push_back(std::make_shared<dag_shape::task const>(dag_shape::task{
+                    .name = task.value.name,
+                    .dependencies = task.value.dependency_names.value_or(std::vector<std::string>{}),
+                    .type = profile.type,
+                    .has_script = profile.blob_id.has_value(),
+                }));
+                task.value.file_content.reset();
+                state->tasks.emplace(task.value.name, std::move(task.value));
+            }
+            publish_shape(*state, std::move(shape));
+            entry.state = std::move(state);
+        });
+        report.build = elapsed();
+
+        {
+            auto const now = std::chrono::system_clock::now();
+            std::unique_lock directory(directory_mutex);
+            std::unique_lock schedules_lock(schedules_mutex);
+            for (std::size_t i = 0; i < loaded.size(); ++i)
+            {
+                auto &entry = loaded[i];
+                if (not entry.state)
+                {
+                    report.rejected.push_back((*names)[i]);
+                    continue;
+                }
+                auto const &name = entry.dag->name;
+                if (not dags.try_emplace(name, entry.state).second)
+                    continue;
+
+                ++report.dags;
+                report.tasks += entry.tasks.size();
+                report.dropped_dependencies += entry.dropped;
+                if (entry.state->schedule and schedules.upsert(name, *entry.state->schedule, now))
+                    ++report.scheduled;
+            }
+        }
+        report.publish = elapsed();
+        report.total = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - started);
+
+        for (auto const &name: report.rejected)
+            logger->warn("warm start left out dag {}: unreadable, or its tasks do not form a DAG", name);
+        logger->info("warm start loaded {} dag(s), {} task(s), {} scheduled in {}us (scan {}us, load {}us, build {}us, "
+                     "publish {}us)", report.dags, report.tasks, report.scheduled, report.total.count(),
+                     report.scan.count(), report.load.count(), report.build.count(), report.publish.count());
+        return report;
+    }
+
+    auto concurrent_shyguy::next_scheduled_dag() noexcept -> std::optional<notification_type>
     {
-        std::lock_guard lock(this->mutex);
-
-        if (schedules.empty())
+        auto batch = next_scheduled_dags();
+        if (batch.empty())
             return std::nullopt;
+        return std::move(batch.front());
+    }
 
-        using system_clock = std::chrono::system_clock;
-        auto const now_system = system_clock::now();
-
-        std::optional<std::pair<std::string, system_clock::time_point>> next{};
-        for (auto const& [dag_name, cron_expr] : schedules)
+    auto concurrent_shyguy::next_scheduled_dags() noexcept -> std::vector<notification_type>
+    {
+        std::vector<schedule_index::due_dag> due{};
         {
-            try
-            {
-                geheb::cron_expression cron{cron_expr};
-                auto const tp = cron.calc_next(now_system);
-                if (not next || tp < next->second)
-                    next = std::pair{dag_name, tp};
-            }
-            catch (...)
-            {
-                // Ignore invalid schedule in-memory.
-            }
+            std::shared_lock lock(schedules_mutex);
+            due = schedules.next_batch();
         }
 
-        if (not next)
-            return std::nullopt;
+        std::vector<notification_type> batch{};
+        batch.reserve(due.size());
+        for (auto &entry: due)
+        {
+            shyguy_request request{};
+            request.command = command_enum::execute;
+            request.emplace(shyguy_dag{.name = std::move(entry.name), .schedule = std::move(entry.cron)});
+            batch.push_back(notification_type{
+                .time = to_steady(entry.time),
+                .associated_request = std::move(request),
+                .command_type = command_enum::execute,
+            });
+        }
+        return batch;
+    }
 
-        auto const wait = next->second - now_system;
-        auto const now_steady = std::chrono::steady_clock::now();
+    auto concurrent_shyguy::next_fire_time() const noexcept -> std::optional<std::chrono::system_clock::time_point>
+    {
+        std::shared_lock lock(schedules_mutex);
+        return schedules.earliest();
+    }
 
-        shyguy_request request{};
-        request.command = command_enum::execute;
-        request.emplace(shyguy_dag{.name = next->first, .schedule = schedules.at(next->first)});
+    auto concurrent_shyguy::fire_due_schedules() noexcept -> std::size_t
+    {
+        std::vector<schedule_index::due_dag> due{};
+        {
+            std::unique_lock lock(schedules_mutex);
+            due = schedules.take_due(std::chrono::system_clock::now());
+        }
 
-        return notification_type{
-            .time = now_steady + std::chrono::duration_cast<std::chrono::steady_clock::duration>(wait),
-            .associated_request = std::move(request),
-            .command_type = command_enum::execute,
+        struct release
+        {
+            schedule_index::due_dag *entry;
+            std::chrono::steady_clock::time_point start;
         };
+        std::vector<release> starts{};
+        starts.reserve(due.size());
+        {
+            // The bucket hands out start times in order, so spread first, then sort, then release.
+            std::lock_guard lock(release_mutex);
+            for (auto &entry: due)
+                starts.push_back({&entry, releases.spread(entry.name, to_steady(entry.time))});
+            std::ranges::sort(starts, {}, &release::start);
+            for (auto &start: starts)
+                start.start = releases.release(start.start);
+        }
+
+        std::size_t queued{0};
+        for (auto const &[entry, start]: starts)
+        {
+            auto const fired = entry->time;
+            if (execute_at(shyguy_dag{.name = std::move(entry->name), .schedule = std::move(entry->cron)}, start, fired))
+                ++queued;
+        }
+        if (not starts.empty() and starts.back().start - starts.front().start > std::chrono::seconds{1})
+            logger->info("released {} scheduled run(s) over {}ms", starts.size(),
+                         std::chrono::duration_cast<std::chrono::milliseconds>(starts.back().start - starts.front().start).count());
+        return queued;
     }
 }
@@ -5,15 +5,73 @@
 #include "shyguy_request.hpp"
 #include "fwd_vocabulary.hpp"
 #include "fs_storage.hpp"
+#include "cgroup.hpp"
+#include "content_cache.hpp"
+#include "dag_view.hpp"
+#include "persistence_queue.hpp"
+#include "indexed_heap.hpp"
+#include "release_policy.hpp"
+#include "schedule_index.hpp"
 
 // *** 3rd Party Includes ***
 #include <spdlog/spdlog.h>
 
 #include <atomic>
 #include <chrono>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 namespace cosmos::inline v1
 {
+    struct task_launch_options
+    {
+        // Python tasks run on these pre-forked interpreters when set.
+        interpreter_pool_t python_pool{};
+        // Per-task cgroup (limits + accounting) when set.
+        std::optional<cgroup_options> cgroup{};
+        // Scripts are copied from the blob store into a sealed memfd per run; otherwise they are
+        // executed from the on-disk script cache. The cache is also the fallback when memfd fails.
+        bool in_memory{true};
+        // Bound of the LRU cache task scripts are read through at launch.
+        std::size_t content_cache_bytes{content_cache::default_capacity_bytes};
+        // How long an execute's idempotency key keeps answering with the run it queued.
+        std::chrono::seconds idempotency_window{std::chrono::minutes{5}};
+        // How the runs of DAGs sharing a cron time are spread out; by default all start on the dot.
+        release_options scheduled_release{};
+    };
+
+    // What warm_start() loaded and how long each phase took.
+    struct warm_start_report
+    {
+        std::size_t dags{0};
+        std::size_t tasks{0};
+        std::size_t scheduled{0};
+        // Dependencies on tasks that no longer exist (removed after the dependent was stored).
+        std::size_t dropped_dependencies{0};
+        // DAGs left out: unreadable, or whose tasks do not form a DAG.
+        std::vector<std::string> rejected{};
+
+        std::chrono::microseconds scan{};
+        std::chrono::microseconds load{};
+        std::chrono::microseconds build{};
+        std::chrono::microseconds publish{};
+        std::chrono::microseconds total{};
+    };
+
+    // What backfill() found in the range and how much of it started right away.
+    struct backfill_report
+    {
+        std::size_t fires{0};
+        std::size_t queued{0};
+        // More fires than max_backfill_runs: the oldest ones were kept.
+        bool truncated{false};
+    };
+
     class concurrent_shyguy
     {
         using root_name_str = std::string;
@@ -21,9 +79,24 @@ namespace cosmos::inline v1
         using cron_tab_str  = std::string;
         using logger_t      = std::shared_ptr<spdlog::logger>;
     public:
-        explicit concurrent_shyguy(request_queue_t rq, terminator_t t, data_storage storage):
-            logger{spdlog::get("shyguy_logger")}, request_queue{std::move(rq)}, running{std::move(t)}, storage{std::move(storage)}
-         {}
+        explicit concurrent_shyguy(request_queue_t rq, terminator_t t, data_storage storage, task_launch_options launch = {}):
+            logger{spdlog::get("shyguy_logger")}, request_queue{std::move(rq)}, running{std::move(t)}, storage{std::move(storage)},
+            launch_options{std::move(launch)},
+            contents{std::make_shared<content_cache>(this->storage, launch_options.content_cache_bytes)},
+            persistence{this->storage ? std::make_shared<persistence_queue>(this->storage,
+                                            [cache = contents](std::string const &blob_id) { cache->unpin(blob_id); })
+                                      : nullptr},
+            releases{launch_options.scheduled_release}
+         {
+             backfills->owner = this;
+             task_request_sequence.store(first_unused_run_id(), std::memory_order_relaxed);
+         }
+        concurrent_shyguy(concurrent_shyguy const &) = delete;
+        concurrent_shyguy &operator=(concurrent_shyguy const &) = delete;
+        // Detaches backfills still in progress: their remaining fires are dropped.
+        ~concurrent_shyguy();
+
+        static constexpr std::size_t max_backfill_runs = 10'000;
 
 
         /**
@@ -36,8 +109,27 @@ namespace cosmos::inline v1
 
         auto create(shyguy_dag const &dag) noexcept -> command_result_type;
         auto remove(shyguy_dag const &dag) noexcept -> command_result_type;
-        auto execute(shyguy_dag const &dag) noexcept -> command_result_type;
-        auto execute_at(shyguy_dag const& dag, std::chrono::steady_clock::time_point scheduled_time) noexcept -> command_result_type;
+        /**
+         * @brief queues a run of the DAG now. An execute that finds an identical run (same DAG
+         * version) still waiting to start, or that repeats an idempotency key seen within
+         * task_launch_options::idempotency_window, is merged into that run instead. Answers
+         * {"run_id", "merged"}, merged counting the requests folded into the run so far.
+         */
+        auto execute(shyguy_dag const &dag, std::optional<std::string> const &idempotency_key = std::nullopt) noexcept
+            -> command_result_type;
+        // A scheduled run starting at `scheduled_time`; `logical_time` is the cron time it stands for, if not that.
+        auto execute_at(shyguy_dag const& dag, std::chrono::steady_clock::time_point scheduled_time,
+                        std::optional<std::chrono::system_clock::time_point> logical_time = std::nullopt) noexcept
+            -> command_result_type;
+        /**
+         * @brief replaces the DAG's cron expression and moves its queued scheduled run to the new
+         * next fire time (or cancels it when the schedule was dropped).
+         */
+        auto reschedule(shyguy_dag const &dag) noexcept -> command_result_type;
+        /**
+         * @brief JSON of the DAG's structure, schedule and queued / in-flight runs with each task's
+         * state, all from one published view: consistent, and taken without the DAG's lock.
+         */
         auto snapshot(shyguy_dag const &dag) noexcept -> command_result_type;
 
         auto create(shyguy_task const &task) noexcept -> command_result_type;
@@ -45,20 +137,159 @@ namespace cosmos::inline v1
         auto execute(shyguy_task const &task) noexcept -> command_result_type;
         auto snapshot(shyguy_task const &task) noexcept -> command_result_type;
 
+        // The DAG's current view (null when there is no such DAG); holding it keeps it unchanged.
+        [[nodiscard]] auto view_of(std::string const &dag) const -> dag_view_ptr;
+        // Current views of every DAG, for monitors polling all of them.
+        [[nodiscard]] auto views() const -> std::vector<dag_view_ptr>;
+
         auto process(std::monostate) const noexcept -> command_result_type;
-        auto next_scheduled_dag() const noexcept -> std::optional<notification_type>;
+
+        /**
+         * @brief runs the DAG once for every cron fire in (from, to], oldest first, each with the fire
+         * as its logical time. At most `parallelism` of those runs are queued or running at once;
+         * the rest follow as earlier ones finish. Replaces a backfill of the DAG still in progress.
+         */
+        auto backfill(shyguy_dag const &dag, std::chrono::system_clock::time_point from,
+                      std::chrono::system_clock::time_point to, std::size_t parallelism) noexcept
+            -> std::expected<backfill_report, command_error>;
+        /**
+         * @brief backfills every scheduled DAG from the fire time of its latest recorded run up to
+         * now: the fires missed while the daemon was down. DAGs that never ran are left alone. Returns the number
+         * of missed fires found.
+         */
+        auto catch_up(std::size_t parallelism) noexcept -> std::size_t;
+
+        /**
+         * @brief rebuilds every DAG stored on disk before requests are served: scans the DAG names,
+         * reads and validates them on a `threads` wide pool, then publishes them and their schedules
+         * in one pass. DAGs that already exist in memory are kept as they are.
+         */
+        auto warm_start(unsigned threads = std::max(1U, std::thread::hardware_concurrency())) noexcept
+            -> std::expected<warm_start_report, storage_error>;
+        // Earliest scheduled DAG (the first of next_scheduled_dags()).
+        auto next_scheduled_dag() noexcept -> std::optional<notification_type>;
+        /**
+         * @brief every DAG due at the earliest fire time, as one batch. A fire time that has passed
+         * stays until fire_due_schedules() takes it.
+         */
+        auto next_scheduled_dags() noexcept -> std::vector<notification_type>;
+        // Earliest (wall-clock) fire time of any schedule, passed or not; what the schedule timer is armed at.
+        [[nodiscard]] auto next_fire_time() const noexcept -> std::optional<std::chrono::system_clock::time_point>;
+        /**
+         * @brief queues a run of every DAG whose fire time has passed and moves their schedules on.
+         * Each run starts when task_launch_options::scheduled_release lets it, and keeps the fire
+         * time as its logical time.
+         */
+        auto fire_due_schedules() noexcept -> std::size_t;
+        /**
+         * @brief mutations reach storage through a write-behind queue; the future is fulfilled once
+         * every one made before the call is stored (false if one of those writes failed).
+         */
+        [[nodiscard]] auto flush() -> std::future<bool>;
+        // Reads through it may lag the latest mutations until a flush().
         [[nodiscard]] auto storage_handle() const noexcept -> data_storage { return storage; }
 
     private:
-        bool has_unique_name(shyguy_dag const &request) const { return not dags.contains(request.name); }
-        bool has_unique_name(shyguy_task const &request) const
+        // Runs still sitting in request_queue, so they can be cancelled or moved instead of running stale.
+        struct queued_run
         {
-            if (const auto iter = dags.find(request.associated_dag); iter != dags.end())
-                return not iter->second.contains(request.name);
-            return false;
-        }
+            heap_handle handle{};
+            bool from_schedule{false};
+            run_progress_ptr progress{};
+            // The DAG as the run was built: only an execute of the same version may merge into it.
+            std::shared_ptr<dag_shape const> shape{};
+            bool backfill{false};
+        };
+
+        // A run enqueue_run queues for a past cron fire on behalf of backfill().
+        struct backfill_fire
+        {
+            std::chrono::system_clock::time_point logical_time{};
+            std::function<void()> on_finished{};
+        };
+
+        struct backfill_job
+        {
+            std::vector<std::chrono::system_clock::time_point> fires{};
+            std::size_t next{0};
+            std::size_t in_flight{0};
+            std::size_t parallelism{1};
+        };
+
+        // Shared with the callbacks of backfill runs, which may outlive this object: they reach it
+        // through `owner`, cleared by the destructor under `mutex`. Lock order: mutex, then DAG locks.
+        struct backfill_jobs
+        {
+            std::mutex mutex{};
+            concurrent_shyguy *owner{nullptr};
+            std::unordered_map<std::string, backfill_job> by_dag{};
+        };
+
+        struct keyed_run
+        {
+            run_progress_ptr progress{};
+            std::chrono::steady_clock::time_point expires{};
+        };
 
-        [[nodiscard]] auto make_task_metadata(shyguy_task const &task) const -> std::optional<task_metadata>;
+        // What a run needs of a task, kept in memory so enqueue_run reads no storage; the script
+        // itself is only fetched (through the content cache) when the task launches.
+        struct task_profile
+        {
+            std::optional<std::string> blob_id{};
+            task_type type{task_type::unset};
+            // Smoothed wall time of earlier runs, refreshed as runs of the task finish.
+            std::shared_ptr<std::atomic_int64_t> expected_cost_us{std::make_shared<std::atomic_int64_t>(0)};
+        };
+        using shape_tasks = std::vector<std::shared_ptr<dag_shape::task const>>;
+
+        /**
+         * @brief everything about one DAG, behind its own reader/writer lock. Requests for different
+         * DAGs only meet on the directory lock, which is held just long enough to find or publish an
+         * entry and never across storage I/O (writes are only queued). Lock order: directory_mutex or
+         * dag_state::mutex, then runs_mutex or schedules_mutex.
+         */
+        struct dag_state
+        {
+            explicit dag_state(std::string const &name) : graph{name} {}
+
+            mutable std::shared_mutex mutex{};
+            directed_acyclic_graph graph;
+            std::optional<cron_tab_str> schedule{};
+            std::unordered_map<name_str, shyguy_task> tasks{};
+            std::unordered_map<name_str, task_profile> profiles{};
+            // Set by remove(dag) as the entry leaves the directory; requests that found it earlier back off.
+            std::atomic_bool removed{false};
+
+            // Makes enqueue_run's check-then-enqueue atomic against reschedule and remove.
+            std::mutex runs_mutex{};
+            std::vector<queued_run> queued_runs{};
+            // Idempotency keys of recent executes, pruned as they expire.
+            std::unordered_map<std::string, keyed_run> recent_keys{};
+
+            // Replaced (never modified) by whoever changes the DAG: a unique lock, or the shared lock
+            // plus runs_mutex, so publications never race. Readers only load it.
+            std::atomic<dag_view_ptr> view{};
+        };
+        using dag_state_ptr = std::shared_ptr<dag_state>;
+
+        [[nodiscard]] auto find_dag(std::string const &name) const -> dag_state_ptr;
+        [[nodiscard]] auto make_task_metadata(std::optional<cron_tab_str> const &schedule) const
+            -> std::optional<task_metadata>;
+        auto enqueue_run(shyguy_dag const &dag, std::chrono::steady_clock::time_point scheduled_time,
+                         bool from_schedule, std::optional<std::string> const &idempotency_key = std::nullopt,
+                         std::optional<std::chrono::system_clock::time_point> logical_time = std::nullopt,
+                         backfill_fire *backfill = nullptr) noexcept -> command_result_type;
+        // Tops the DAG's backfill up to its parallelism; backfills->mutex must be held.
+        auto launch_backfill_runs(std::string const &dag, backfill_job &job) -> std::size_t;
+        auto backfill_run_finished(std::string const &dag) -> void;
+        auto cancel_queued_runs(dag_state &state) noexcept -> std::size_t;
+        // Publishes a new view of the DAG; finished runs are dropped from it on the way.
+        auto publish(dag_state &state, std::shared_ptr<dag_shape const> shape, std::vector<run_progress_ptr> runs) -> void;
+        auto publish_shape(dag_state &state, shape_tasks tasks) -> void;
+        [[nodiscard]] auto run_log_directory(std::string_view dag_name, std::uint64_t run_id,
+                                             std::string_view task_name) const -> std::filesystem::path;
+        // Past every id a previous boot used: the run log's, and those of runs cut off before any task finished.
+        [[nodiscard]] auto first_unused_run_id() const -> std::uint64_t;
 
         template<class... T>
         auto log_return(fmt::format_string<T...> fmt_str, T&&... args) noexcept -> std::string
@@ -68,102 +299,26 @@ namespace cosmos::inline v1
             return value;
         }
 
-        std::unordered_map<name_str, shyguy_task> task_map{};
-        std::unordered_map<root_name_str, directed_acyclic_graph> dags{};
-        std::unordered_map<root_name_str, cron_tab_str> schedules{};
-        std::vector<root_name_str> running_dags{};
-        std::vector<name_str> running_tasks{};
+        mutable std::shared_mutex directory_mutex{};
+        std::unordered_map<root_name_str, dag_state_ptr> dags{};
+        // Every scheduled DAG by next fire time, kept apart so next_scheduled_dags never waits on a DAG's lock.
+        mutable std::shared_mutex schedules_mutex{};
+        schedule_index schedules{};
 
-        mutable std::recursive_mutex mutex{};
         std::shared_ptr<spdlog::logger> logger;
         request_queue_t request_queue;
         terminator_t    running;
         data_storage storage{};
+        task_launch_options launch_options{};
+        // Scripts submitted but not yet written stay pinned here until persistence stores their blob.
+        content_cache_t contents{};
+        // Null without storage. Mutations of one DAG are queued in the order they are made.
+        persistence_queue_t persistence{};
         std::atomic_uint64_t task_request_sequence{0};
+        std::atomic_uint64_t view_epoch{0};
+        std::shared_ptr<backfill_jobs> backfills{std::make_shared<backfill_jobs>()};
+        std::mutex release_mutex{};
+        release_policy releases{};
     };
 
-    class notify_updater
-    {
-    public:
-        auto notify_wakeup(const notification_type &notification) noexcept -> void
-        {
-            std::lock_guard lock(this->mutex_);
-            cached_time_ = notification;
-            this->condition_variable_.notify_one();
-        }
-
-        auto sleep_until_or_notified(const std::chrono::steady_clock::time_point next_time) noexcept
-        {
-            std::unique_lock lock{this->mutex_};
-            this->condition_variable_.wait_until(lock, next_time);
-            auto result_time = cached_time_;
-            cached_time_.reset();
-            return result_time;
-        }
-
-    private:
-        std::optional<notification_type> cached_time_{};
-        mutable std::mutex mutex_{};
-        std::condition_variable condition_variable_{};
-    };
-
-    template <class AfterExecute>
-    inline auto function_schedule_runner(notify_updater &notifier,
-                                         concurrent_shyguy &shy_guy,
-                                         terminator_t running,
-                                         AfterExecute after_execute)
-    {
-        // default sleep time
-        auto sleep_until_dag_scheduled = [&]() mutable -> notification_type
-        {
-            auto default_wait_time = std::chrono::steady_clock::now() + std::chrono::months(1);
-            while (running->load(std::memory_order_relaxed))
-            {
-                if (auto notification = notifier.sleep_until_or_notified(default_wait_time); notification.has_value())
-                {
-                    return notification.value();
-                }
-
-                default_wait_time += std::chrono::months(1);
-            }
-
-            return {.time = std::chrono::steady_clock::now(), .associated_request = {}, .command_type = command_enum::error};
-        };
-
-        auto launch_dag_and_sleep_till_next = [&](auto &notified) mutable
-        {
-            while (running->load(std::memory_order_relaxed))
-            {
-                if (auto notification = notifier.sleep_until_or_notified(notified.time); notification.has_value())
-                {
-                    notified = notification.value();
-                    continue;
-                }
-
-                notified.associated_request.command = command_enum::execute;
-                (void) shy_guy.process(notified.associated_request);
-                after_execute();
-
-                auto const next_scheduled_time = shy_guy.next_scheduled_dag();
-                if (not next_scheduled_time.has_value())
-                    break;
-
-                notified = next_scheduled_time.value();
-            }
-        };
-
-        while (running->load(std::memory_order_relaxed))
-        {
-            auto notification = sleep_until_dag_scheduled();
-            if (not running->load(std::memory_order_relaxed))
-                break;
-            launch_dag_and_sleep_till_next(notification);
-        }
-    }
-
-    inline auto function_schedule_runner(notify_updater &notifier, concurrent_shyguy &shy_guy, terminator_t running)
-    {
-        function_schedule_runner(notifier, shy_guy, std::move(running), [] {});
-    }
-
 } // namespace cosmos::inline v1
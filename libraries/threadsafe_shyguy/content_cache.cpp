@@ -0,0 +1,139 @@
+#include "content_cache.hpp"
+
+#include <chrono>
+#include <utility>
+
+namespace cosmos::inline v1
+{
+    content_cache::content_cache(data_storage store_, std::size_t capacity) :
+        store{std::move(store_)}, capacity_bytes{capacity}
+    {
+        if (store)
+            prefetcher = std::thread{[this] { prefetch_loop(); }};
+    }
+
+    content_cache::~content_cache()
+    {
+        stopping.store(true, std::memory_order_release);
+        prefetch_queue.close();
+        if (prefetcher.joinable())
+            prefetcher.join();
+    }
+
+    auto content_cache::get(std::string const &blob_id) -> std::expected<content_ptr, storage_error>
+    {
+        {
+            std::lock_guard lock(mutex);
+            if (auto const found = index.find(blob_id); found != index.end())
+            {
+                entries.splice(entries.begin(), entries, found->second);
+                hit_count.fetch_add(1, std::memory_order_relaxed);
+                return found->second->content;
+            }
+            if (auto const found = pinned.find(blob_id); found != pinned.end())
+            {
+                hit_count.fetch_add(1, std::memory_order_relaxed);
+                return found->second;
+            }
+        }
+
+        miss_count.fetch_add(1, std::memory_order_relaxed);
+        if (not store or blob_id.empty())
+            return std::unexpected(storage_error::not_found);
+
+        // Read unlocked: a concurrent miss on the same blob reads it twice, which beats serializing all reads.
+        auto bytes = store->blobs().get_blob(blob_id);
+        if (not bytes)
+            return std::unexpected(bytes.error());
+
+        auto content = std::make_shared<std::vector<std::byte> const>(std::move(bytes.value()));
+        insert(blob_id, content);
+        return content;
+    }
+
+    auto content_cache::pin(std::string const &blob_id, std::vector<std::byte> content) -> void
+    {
+        std::lock_guard lock(mutex);
+        pinned.try_emplace(blob_id, std::make_shared<std::vector<std::byte> const>(std::move(content)));
+    }
+
+    auto content_cache::unpin(std::string const &blob_id) -> void
+    {
+        content_ptr content{};
+        {
+            std::lock_guard lock(mutex);
+            auto node = pinned.extract(blob_id);
+            if (node.empty())
+                return;
+            content = std::move(node.mapped());
+        }
+        insert(blob_id, std::move(content));
+    }
+
+    auto content_cache::prefetch(std::span<std::string const> blob_ids) -> void
+    {
+        if (not store)
+            return;
+        for (auto const &blob_id: blob_ids)
+        {
+            if (blob_id.empty() or contains(blob_id))
+                continue;
+            auto queued = blob_id;
+            if (not prefetch_queue.try_enqueue(std::move(queued)))
+                return;
+        }
+    }
+
+    auto content_cache::contains(std::string const &blob_id) const -> bool
+    {
+        std::lock_guard lock(mutex);
+        return index.contains(blob_id) or pinned.contains(blob_id);
+    }
+
+    auto content_cache::size() const -> std::size_t
+    {
+        std::lock_guard lock(mutex);
+        return index.size();
+    }
+
+    auto content_cache::bytes() const -> std::size_t
+    {
+        std::lock_guard lock(mutex);
+        return used_bytes;
+    }
+
+    auto content_cache::insert(std::string const &blob_id, content_ptr content) -> void
+    {
+        auto const size = content->size();
+        if (size > capacity_bytes)
+            return;
+
+        std::lock_guard lock(mutex);
+        if (index.contains(blob_id))
+            return;
+
+        while (used_bytes + size > capacity_bytes and not entries.empty())
+        {
+            used_bytes -= entries.back().content->size();
+            index.erase(entries.back().blob_id);
+            entries.pop_back();
+        }
+
+        entries.push_front(entry{.blob_id = blob_id, .content = std::move(content)});
+        index.emplace(blob_id, entries.begin());
+        used_bytes += size;
+    }
+
+    auto content_cache::prefetch_loop() -> void
+    {
+        using namespace std::chrono_literals;
+        while (not stopping.load(std::memory_order_acquire))
+        {
+            auto blob_id = prefetch_queue.dequeue_wait(1h);
+            if (not blob_id or contains(*blob_id))
+                continue;
+            if (auto bytes = store->blobs().get_blob(*blob_id))
+                insert(*blob_id, std::make_shared<std::vector<std::byte> const>(std::move(bytes.value())));
+        }
+    }
+} // namespace cosmos::inline v1
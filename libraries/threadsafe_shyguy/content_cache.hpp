@@ -0,0 +1,91 @@
+// Task script contents by blob id, least recently used evicted first
+#pragma once
+
+// *** Project Includes ***
+#include "blocking_queue.hpp"
+#include "fs_storage.hpp"
+#include "fwd_vocabulary.hpp"
+
+// *** Standard Includes ***
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief size-bounded LRU cache of blob contents, shared by every run. Blobs are read from
+     * storage on first use (at launch, never while the orchestrator holds a lock) and the ones a
+     * run is about to need can be prefetched by a background thread. Blob ids are content
+     * addresses, so a cached entry never goes stale. Internally synchronized.
+     */
+    class content_cache
+    {
+    public:
+        using content_ptr = std::shared_ptr<std::vector<std::byte> const>;
+
+        static constexpr std::size_t default_capacity_bytes = 64U * 1024U * 1024U;
+
+        // Without a store every lookup is not_found and no prefetch thread is started.
+        explicit content_cache(data_storage store, std::size_t capacity_bytes = default_capacity_bytes);
+        content_cache(content_cache const &) = delete;
+        content_cache &operator=(content_cache const &) = delete;
+        ~content_cache();
+
+        // The blob's bytes, read from storage on a miss. A blob larger than the whole cache is returned but not kept.
+        [[nodiscard]] auto get(std::string const &blob_id) -> std::expected<content_ptr, storage_error>;
+
+        // Holds content storage does not have yet, e.g. a script whose blob write is still queued: it is
+        // served from here and never evicted until unpin(). Its bytes do not count against the capacity.
+        auto pin(std::string const &blob_id, std::vector<std::byte> content) -> void;
+        // The blob reached storage: its content becomes an ordinary, evictable entry.
+        auto unpin(std::string const &blob_id) -> void;
+
+        // Queues the blobs that are not cached yet for the prefetch thread; a hint, dropped when its queue is full.
+        auto prefetch(std::span<std::string const> blob_ids) -> void;
+
+        [[nodiscard]] auto contains(std::string const &blob_id) const -> bool;
+        [[nodiscard]] auto size() const -> std::size_t;
+        [[nodiscard]] auto bytes() const -> std::size_t;
+        [[nodiscard]] auto hits() const noexcept -> std::size_t { return hit_count.load(std::memory_order_relaxed); }
+        [[nodiscard]] auto misses() const noexcept -> std::size_t { return miss_count.load(std::memory_order_relaxed); }
+
+    private:
+        struct entry
+        {
+            std::string blob_id{};
+            content_ptr content{};
+        };
+
+        // Takes the cache lock; the storage read in get() happens before it.
+        auto insert(std::string const &blob_id, content_ptr content) -> void;
+        auto prefetch_loop() -> void;
+
+        data_storage store{};
+        std::size_t capacity_bytes{};
+
+        mutable std::mutex mutex{};
+        // Most recently used first.
+        std::list<entry> entries{};
+        std::unordered_map<std::string, std::list<entry>::iterator> index{};
+        std::size_t used_bytes{0};
+        std::unordered_map<std::string, content_ptr> pinned{};
+
+        std::atomic_size_t hit_count{0};
+        std::atomic_size_t miss_count{0};
+
+        blocking_queue<std::string> prefetch_queue{256};
+        std::atomic_bool stopping{false};
+        std::thread prefetcher{};
+    };
+
+    using content_cache_t = std::shared_ptr<content_cache>;
+} // namespace cosmos::inline v1
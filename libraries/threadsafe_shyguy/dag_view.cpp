@@ -0,0 +1,171 @@
+#include "dag_view.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace cosmos::inline v1
+{
+    auto to_string_view(task_run_state const state) noexcept -> std::string_view
+    {
+        using namespace std::string_view_literals;
+        switch (state)
+        {
+            case task_run_state::queued:
+                return "queued"sv;
+            case task_run_state::running:
+                return "running"sv;
+            case task_run_state::succeeded:
+                return "succeeded"sv;
+            case task_run_state::failed:
+                return "failed"sv;
+            default:
+                return "unknown"sv;
+        }
+    }
+
+    run_progress::run_progress(std::uint64_t id, std::chrono::steady_clock::time_point when,
+                               std::shared_ptr<std::vector<std::string> const> order_,
+                               std::chrono::system_clock::time_point logical, std::function<void()> on_finished) :
+        run_id{id}, logical_time{logical}, scheduled_time{when}, tasks{std::move(order_)},
+        states{std::make_unique<std::atomic<task_run_state>[]>(tasks->size())},
+        finished_callback{std::move(on_finished)}
+    {
+        for (std::size_t i = 0; i < tasks->size(); ++i)
+            states[i].store(task_run_state::queued, std::memory_order_relaxed);
+    }
+
+    auto run_progress::set(std::size_t index, task_run_state state_) noexcept -> void
+    {
+        if (index >= tasks->size())
+            return;
+        states[index].store(state_, std::memory_order_release);
+        if (state_ != task_run_state::succeeded and state_ != task_run_state::failed)
+            return;
+        if (finished.fetch_add(1, std::memory_order_acq_rel) + 1 == tasks->size() and finished_callback)
+            finished_callback();
+    }
+
+    auto run_progress::state(std::size_t index) const noexcept -> task_run_state
+    {
+        return states[index].load(std::memory_order_acquire);
+    }
+
+    auto run_progress::done() const noexcept -> bool
+    {
+        return finished.load(std::memory_order_acquire) == tasks->size();
+    }
+
+    auto dag_shape::json() const -> std::string const &
+    {
+        std::call_once(rendered, [this]
+        {
+            auto task_list = nlohmann::json::array();
+            for (auto const &entry: tasks)
+                task_list.push_back({{"name", entry->name},
+                                     {"dependencies", entry->dependencies},
+                                     {"type", to_string_view(entry->type)},
+                                     {"has_script", entry->has_script}});
+            nlohmann::json shape{{"name", name}, {"tasks", std::move(task_list)}};
+            shape["schedule"] = schedule ? nlohmann::json(*schedule) : nlohmann::json(nullptr);
+            rendered_json = shape.dump();
+        });
+        return rendered_json;
+    }
+
+    auto to_json(dag_view const &view, std::chrono::steady_clock::time_point now,
+                 std::span<run_summary const> history) -> std::string
+    {
+        auto runs = nlohmann::json::array();
+        for (auto const &run: view.runs)
+        {
+            // Counts for every state, names only for the tasks worth looking at.
+            std::array<std::size_t, 4> counts{};
+            auto running = nlohmann::json::array();
+            auto failed = nlohmann::json::array();
+            auto const &order = run->order();
+            for (std::size_t i = 0; i < order.size(); ++i)
+            {
+                auto const state = run->state(i);
+                ++counts[static_cast<std::size_t>(state)];
+                if (state == task_run_state::running)
+                    running.push_back(order[i]);
+                else if (state == task_run_state::failed)
+                    failed.push_back(order[i]);
+            }
+
+            auto const status = counts[0] == order.size() ? "queued" : run->done() ? "finished" : "running";
+            auto const due_in = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    run->scheduled_time.load(std::memory_order_relaxed) - now);
+            runs.push_back({{"run_id", run->run_id},
+                            {"status", status},
+                            {"logical_time_ms", std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                        run->logical_time.time_since_epoch()).count()},
+                            {"due_in_ms", std::max<std::int64_t>(due_in.count(), 0)},
+                            {"merged", run->merged.load(std::memory_order_relaxed)},
+                            {"queued", counts[0]},
+                            {"running", counts[1]},
+                            {"succeeded", counts[2]},
+                            {"failed", counts[3]},
+                            {"running_tasks", std::move(running)},
+                            {"failed_tasks", std::move(failed)}});
+        }
+
+        auto out = R"({"version":)" + std::to_string(view.version) + R"(,"dag":)";
+        out += view.shape->json();
+        out += R"(,"runs":)";
+        out += runs.dump();
+
+        auto const epoch_ms = [](std::chrono::system_clock::time_point tp)
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+        };
+        auto past = nlohmann::json::array();
+        for (auto const &run: history)
+        {
+            auto tasks = nlohmann::json::array();
+            for (auto const &task: run.tasks)
+                tasks.push_back({{"name", task.task},
+                                 {"status", to_string(task.status)},
+                                 {"exit_code", task.exit_code},
+                                 {"wall_ms", epoch_ms(task.finished) - epoch_ms(task.started)}});
+            past.push_back({{"run_id", run.run_id},
+                            {"status", to_string(run.status)},
+                            {"started_ms", epoch_ms(run.started)},
+                            {"finished_ms", epoch_ms(run.finished)},
+                            {"tasks", std::move(tasks)}});
+        }
+        out += R"(,"history":)";
+        out += past.dump();
+        out += '}';
+        return out;
+    }
+
+    auto to_json(dag_view const &view, std::string_view task_name) -> std::optional<std::string>
+    {
+        auto const &tasks = view.shape->tasks;
+        auto const found = std::ranges::find_if(tasks, [&](auto const &entry) { return entry->name == task_name; });
+        if (found == tasks.end())
+            return std::nullopt;
+
+        auto runs = nlohmann::json::array();
+        for (auto const &run: view.runs)
+        {
+            auto const &order = run->order();
+            auto const index = static_cast<std::size_t>(std::ranges::find(order, task_name) - order.begin());
+            if (index < order.size())
+                runs.push_back({{"run_id", run->run_id}, {"state", to_string_view(run->state(index))}});
+        }
+
+        auto const &entry = **found;
+        return nlohmann::json{{"version", view.version},
+                              {"dag", view.shape->name},
+                              {"name", entry.name},
+                              {"dependencies", entry.dependencies},
+                              {"type", to_string_view(entry.type)},
+                              {"has_script", entry.has_script},
+                              {"runs", std::move(runs)}}
+                .dump();
+    }
+} // namespace cosmos::inline v1
@@ -0,0 +1,120 @@
+// Immutable, version-stamped views of a DAG for snapshot()
+#pragma once
+
+// *** Project Includes ***
+#include "shyguy_request.hpp"
+#include "storage.hpp"
+
+// *** Standard Includes ***
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cosmos::inline v1
+{
+    enum class task_run_state : std::uint8_t
+    {
+        queued,
+        running,
+        succeeded,
+        failed,
+    };
+
+    [[nodiscard]] auto to_string_view(task_run_state state) noexcept -> std::string_view;
+
+    /**
+     * @brief live progress of one queued or in-flight run. Its tasks publish their state here as
+     * they start and finish (a plain atomic store each), so readers see runs move without the
+     * executor ever taking a lock for them.
+     */
+    class run_progress
+    {
+    public:
+        run_progress(std::uint64_t id, std::chrono::steady_clock::time_point when,
+                     std::shared_ptr<std::vector<std::string> const> order,
+                     std::chrono::system_clock::time_point logical = std::chrono::system_clock::now(),
+                     std::function<void()> on_finished = {});
+
+        auto set(std::size_t index, task_run_state state) noexcept -> void;
+        [[nodiscard]] auto state(std::size_t index) const noexcept -> task_run_state;
+        [[nodiscard]] auto done() const noexcept -> bool;
+
+        // Tasks in run order; state(i) is the state of order()[i].
+        [[nodiscard]] auto order() const noexcept -> std::vector<std::string> const & { return *tasks; }
+
+        std::uint64_t const run_id;
+        // The wall-clock time the run stands for: its cron fire time, a past one for a backfill.
+        std::chrono::system_clock::time_point const logical_time;
+        // Execute requests folded into this run instead of queuing a run of their own.
+        std::atomic_size_t merged{0};
+        // Moved by reschedule() while the run waits.
+        std::atomic<std::chrono::steady_clock::time_point> scheduled_time;
+
+    private:
+        std::shared_ptr<std::vector<std::string> const> tasks;
+        std::unique_ptr<std::atomic<task_run_state>[]> states;
+        std::atomic_size_t finished{0};
+        // Called once, by the task that finishes the run.
+        std::function<void()> finished_callback{};
+    };
+
+    using run_progress_ptr = std::shared_ptr<run_progress>;
+
+    /**
+     * @brief structure and schedule of a DAG as of one edit. Never modified after it is published;
+     * an edit publishes a new one that shares the unchanged task entries. Its JSON is rendered
+     * once, by the first snapshot that needs it.
+     */
+    struct dag_shape
+    {
+        struct task
+        {
+            std::string name{};
+            std::vector<std::string> dependencies{};
+            task_type type{task_type::unset};
+            bool has_script{false};
+        };
+
+        dag_shape(std::string name_, std::optional<std::string> schedule_, std::vector<std::shared_ptr<task const>> tasks_) :
+            name{std::move(name_)}, schedule{std::move(schedule_)}, tasks{std::move(tasks_)}
+        {}
+
+        std::string const name;
+        std::optional<std::string> const schedule;
+        std::vector<std::shared_ptr<task const>> const tasks;
+
+        [[nodiscard]] auto json() const -> std::string const &;
+
+    private:
+        mutable std::once_flag rendered{};
+        mutable std::string rendered_json{};
+    };
+
+    // What snapshot() reads: one atomic load, no DAG lock.
+    struct dag_view
+    {
+        // Grows with every publication of any DAG, so views of different DAGs can be ordered too.
+        std::uint64_t version{0};
+        std::shared_ptr<dag_shape const> shape{};
+        std::vector<run_progress_ptr> runs{};
+    };
+
+    using dag_view_ptr = std::shared_ptr<dag_view const>;
+
+    // {"version", "dag", "runs", "history"}: the cached shape, the runs' states as of `now` and the
+    // finished runs from the run history.
+    [[nodiscard]] auto to_json(dag_view const &view, std::chrono::steady_clock::time_point now,
+                               std::span<run_summary const> history = {}) -> std::string;
+    // One task of the view, with its state in every run; nullopt when the DAG has no such task.
+    [[nodiscard]] auto to_json(dag_view const &view, std::string_view task_name) -> std::optional<std::string>;
+} // namespace cosmos::inline v1
@@ -0,0 +1,196 @@
+#include "persistence_queue.hpp"
+
+#include <utility>
+
+namespace cosmos::inline v1
+{
+    namespace
+    {
+        template<class... Ts>
+        struct overloaded : Ts...
+        {
+            using Ts::operator()...;
+        };
+    } // namespace
+
+    persistence_queue::persistence_queue(data_storage store_, std::function<void(std::string const &)> on_stored) :
+        store{std::move(store_)}, on_blob_stored{std::move(on_stored)}
+    {
+        writer = std::thread{[this] { writer_loop(); }};
+    }
+
+    persistence_queue::~persistence_queue()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+    }
+
+    auto persistence_queue::put_blob(std::string blob_id, std::vector<std::byte> bytes) -> void
+    {
+        auto key = "blob:" + blob_id;
+        // Same id, same bytes: a waiting write of the blob already covers this one, keep its place.
+        push(std::move(key), blob_write{.blob_id = std::move(blob_id), .bytes = std::move(bytes)}, false);
+    }
+
+    auto persistence_queue::upsert_dag(shyguy_dag dag) -> void
+    {
+        auto key = "dag:" + dag.name;
+        push(std::move(key), dag_upsert{.dag = std::move(dag)});
+    }
+
+    auto persistence_queue::erase_dag(std::string dag) -> void
+    {
+        auto key = "dag:" + dag;
+        push(std::move(key), dag_erase{.dag = std::move(dag)});
+    }
+
+    auto persistence_queue::upsert_task(shyguy_task task, std::optional<std::string> blob_id,
+                                        std::optional<task_metadata> metadata) -> void
+    {
+        auto key = "task:" + task.associated_dag + "/" + task.name;
+        push(std::move(key), task_upsert{.task = std::move(task), .blob_id = std::move(blob_id), .metadata = std::move(metadata)});
+    }
+
+    auto persistence_queue::erase_task(std::string dag, std::string task) -> void
+    {
+        auto key = "task:" + dag + "/" + task;
+        push(std::move(key), task_erase{.dag = std::move(dag), .task = std::move(task)});
+    }
+
+    auto persistence_queue::flush() -> std::future<bool>
+    {
+        flush_marker marker{};
+        auto done = marker.done.get_future();
+        {
+            std::lock_guard lock(mutex);
+            queue.emplace_back(std::move(marker));
+            // Writes after the marker must not be pulled in front of it (or it in front of them).
+            waiting.clear();
+        }
+        wake.notify_one();
+        return done;
+    }
+
+    auto persistence_queue::pending() const -> std::size_t
+    {
+        std::lock_guard lock(mutex);
+        return queue.size();
+    }
+
+    auto persistence_queue::written() const -> std::size_t
+    {
+        std::lock_guard lock(mutex);
+        return written_count;
+    }
+
+    auto persistence_queue::coalesced() const -> std::size_t
+    {
+        std::lock_guard lock(mutex);
+        return coalesced_count;
+    }
+
+    auto persistence_queue::push(std::string key, write item, bool replace) -> void
+    {
+        {
+            std::lock_guard lock(mutex);
+            if (auto const found = waiting.find(key); found != waiting.end())
+            {
+                if (not replace)
+                {
+                    ++coalesced_count;
+                    return;
+                }
+                // A DAG erase clears the DAG's tasks too: a re-create goes behind it rather than replacing it.
+                if (not std::holds_alternative<dag_erase>(*found->second) or std::holds_alternative<dag_erase>(item))
+                {
+                    queue.erase(found->second);
+                    ++coalesced_count;
+                }
+                waiting.erase(found);
+            }
+            queue.push_back(std::move(item));
+            waiting.emplace(std::move(key), std::prev(queue.end()));
+        }
+        wake.notify_one();
+    }
+
+    auto persistence_queue::apply(write &item) -> bool
+    {
+        if (not store)
+            return true;
+        // Erasing what is already gone is not a failure.
+        auto const erased = [](std::expected<void, storage_error> const &result)
+        {
+            return result.has_value() or result.error() == storage_error::not_found;
+        };
+        return std::visit(overloaded{
+            [&](blob_write const &w)
+            {
+                auto const stored = store->blobs().put_blob(w.bytes).has_value();
+                if (stored and on_blob_stored)
+                    on_blob_stored(w.blob_id);
+                return stored;
+            },
+            [&](dag_upsert const &w) { return store->dags().upsert_dag(w.dag, std::nullopt).has_value(); },
+            [&](dag_erase const &w)
+            {
+                // Its tasks go with it, or a DAG created again under the name would get them back on the next start.
+                auto tasks_erased = true;
+                if (auto const tasks = store->tasks().list_tasks(w.dag))
+                    for (auto const &task: *tasks)
+                        tasks_erased = erased(store->tasks().erase_task(w.dag, task.value.name, std::nullopt)) and tasks_erased;
+                return erased(store->dags().erase_dag(w.dag, std::nullopt)) and tasks_erased;
+            },
+            [&](task_upsert const &w)
+            {
+                return store->tasks().upsert_task(w.task, w.blob_id, std::nullopt, w.metadata).has_value();
+            },
+            [&](task_erase const &w) { return erased(store->tasks().erase_task(w.dag, w.task, std::nullopt)); },
+            [](flush_marker const &) { return true; },
+        }, item);
+    }
+
+    auto persistence_queue::writer_loop() -> void
+    {
+        // Failures since the last flush marker; reported to (and cleared by) the next one.
+        bool failed{false};
+        std::list<write> batch{};
+        while (true)
+        {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [this] { return stopping or not queue.empty(); });
+                if (queue.empty())
+                    return;
+                batch.splice(batch.end(), queue);
+                waiting.clear();
+            }
+
+            std::size_t applied{0};
+            // Counted before a marker is fulfilled, so a completed flush() sees its writes in written().
+            auto const count_applied = [&]
+            {
+                std::lock_guard lock(mutex);
+                written_count += std::exchange(applied, 0);
+            };
+            for (auto &item: batch)
+            {
+                if (auto *marker = std::get_if<flush_marker>(&item))
+                {
+                    count_applied();
+                    marker->done.set_value(not failed);
+                    failed = false;
+                    continue;
+                }
+                failed = not apply(item) or failed;
+                ++applied;
+            }
+            batch.clear();
+            count_applied();
+        }
+    }
+} // namespace cosmos::inline v1
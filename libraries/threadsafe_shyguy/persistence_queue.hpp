@@ -0,0 +1,107 @@
+// Write-behind persistence of orchestrator mutations
+#pragma once
+
+// *** Project Includes ***
+#include "fs_storage.hpp"
+#include "fwd_vocabulary.hpp"
+#include "shyguy_request.hpp"
+
+// *** Standard Includes ***
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief hands storage writes to one background thread so requests only pay for an in-memory
+     * update. Writes are applied in the order they were queued; a write to a key that is still
+     * waiting replaces the waiting one (and moves to the back), so a burst of edits to one DAG or
+     * task costs one file write. flush() gives callers that need durability a future that is
+     * fulfilled once everything queued before it has reached storage. Internally synchronized.
+     */
+    class persistence_queue
+    {
+    public:
+        // `on_blob_stored` is called on the writer thread with the id of each blob once it is in storage.
+        explicit persistence_queue(data_storage store, std::function<void(std::string const &)> on_blob_stored = {});
+        persistence_queue(persistence_queue const &) = delete;
+        persistence_queue &operator=(persistence_queue const &) = delete;
+        // Writes everything still queued before returning.
+        ~persistence_queue();
+
+        auto put_blob(std::string blob_id, std::vector<std::byte> bytes) -> void;
+        auto upsert_dag(shyguy_dag dag) -> void;
+        // Erases the DAG and every task stored under it; a later write to the DAG never replaces this one.
+        auto erase_dag(std::string dag) -> void;
+        auto upsert_task(shyguy_task task, std::optional<std::string> blob_id, std::optional<task_metadata> metadata) -> void;
+        auto erase_task(std::string dag, std::string task) -> void;
+
+        // True once every write queued before the call is stored, false if one of them failed.
+        [[nodiscard]] auto flush() -> std::future<bool>;
+
+        [[nodiscard]] auto pending() const -> std::size_t;
+        [[nodiscard]] auto written() const -> std::size_t;
+        [[nodiscard]] auto coalesced() const -> std::size_t;
+
+    private:
+        struct blob_write
+        {
+            std::string blob_id{};
+            std::vector<std::byte> bytes{};
+        };
+        struct dag_upsert
+        {
+            shyguy_dag dag{};
+        };
+        struct dag_erase
+        {
+            std::string dag{};
+        };
+        struct task_upsert
+        {
+            shyguy_task task{};
+            std::optional<std::string> blob_id{};
+            std::optional<task_metadata> metadata{};
+        };
+        struct task_erase
+        {
+            std::string dag{};
+            std::string task{};
+        };
+        struct flush_marker
+        {
+            std::promise<bool> done{};
+        };
+        using write = std::variant<blob_write, dag_upsert, dag_erase, task_upsert, task_erase, flush_marker>;
+
+        // One key per stored file: repeated writes to it within a flush segment collapse into the last.
+        auto push(std::string key, write item, bool replace = true) -> void;
+        auto apply(write &item) -> bool;
+        auto writer_loop() -> void;
+
+        data_storage store{};
+        std::function<void(std::string const &)> on_blob_stored{};
+
+        mutable std::mutex mutex{};
+        std::condition_variable wake{};
+        std::list<write> queue{};
+        std::unordered_map<std::string, std::list<write>::iterator> waiting{};
+        std::size_t written_count{0};
+        std::size_t coalesced_count{0};
+        bool stopping{false};
+
+        std::thread writer{};
+    };
+
+    using persistence_queue_t = std::shared_ptr<persistence_queue>;
+} // namespace cosmos::inline v1
@@ -0,0 +1,45 @@
+#include "release_policy.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace cosmos::inline v1
+{
+    release_policy::release_policy(release_options options) noexcept : settings{options}
+    {
+        if (settings.starts_per_second > 0.0)
+        {
+            interval = std::chrono::duration_cast<clock_type::duration>(
+                    std::chrono::duration<double>{1.0 / settings.starts_per_second});
+            tolerance = interval * static_cast<clock_type::rep>(std::max<std::size_t>(settings.burst, 1) - 1);
+        }
+    }
+
+    auto release_policy::offset_of(std::string_view dag) const noexcept -> std::chrono::milliseconds
+    {
+        if (settings.spread.count() <= 0)
+            return std::chrono::milliseconds{0};
+        // FNV-1a: a stable hash, unlike std::hash, so a DAG keeps its slot across restarts.
+        std::uint64_t hash = 1469598103934665603ULL;
+        for (auto const c: dag)
+        {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 1099511628211ULL;
+        }
+        return std::chrono::milliseconds{static_cast<std::int64_t>(hash % static_cast<std::uint64_t>(settings.spread.count()))};
+    }
+
+    auto release_policy::spread(std::string_view dag, clock_type::time_point due) const noexcept -> clock_type::time_point
+    {
+        return due + offset_of(dag);
+    }
+
+    auto release_policy::release(clock_type::time_point due) noexcept -> clock_type::time_point
+    {
+        if (interval == clock_type::duration::zero())
+            return due;
+        auto const start = std::max(due, theoretical - tolerance);
+        theoretical = std::max(theoretical, start) + interval;
+        return start;
+    }
+} // namespace cosmos::inline v1
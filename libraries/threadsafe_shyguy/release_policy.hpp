@@ -0,0 +1,49 @@
+// When scheduled runs may start: per-DAG spread and a cap on starts per second
+#pragma once
+
+// *** Standard Includes ***
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+
+namespace cosmos::inline v1
+{
+    struct release_options
+    {
+        // Each scheduled DAG starts up to this long after its cron time, at an offset fixed by its
+        // name (the same on every restart). Keep it well under the shortest cron period.
+        std::chrono::milliseconds spread{0};
+        // Scheduled run starts per second, 0 for no cap; `burst` of them may start back to back.
+        double starts_per_second{0.0};
+        std::size_t burst{1};
+    };
+
+    /**
+     * @brief smooths the herd of runs that share a cron time (every `0 * * * *` DAG at once) into
+     * a steady release: a DAG's run is held back by its offset within the spread window, then by a
+     * token bucket (kept as its theoretical arrival time, GCRA style) until a start is allowed. Only
+     * the physical start moves; the run keeps its cron time as its logical time. Releases must be
+     * asked for in order of their due times. Not synchronized.
+     */
+    class release_policy
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        explicit release_policy(release_options options = {}) noexcept;
+
+        [[nodiscard]] auto offset_of(std::string_view dag) const noexcept -> std::chrono::milliseconds;
+        // The DAG's offset added to `due`; what release() orders by.
+        [[nodiscard]] auto spread(std::string_view dag, clock_type::time_point due) const noexcept -> clock_type::time_point;
+        // When a run due (after its spread) at `due` may start; takes the bucket's token for it.
+        auto release(clock_type::time_point due) noexcept -> clock_type::time_point;
+
+        [[nodiscard]] auto options() const noexcept -> release_options const & { return settings; }
+
+    private:
+        release_options settings{};
+        clock_type::duration interval{};
+        clock_type::duration tolerance{};
+        clock_type::time_point theoretical{};
+    };
+} // namespace cosmos::inline v1
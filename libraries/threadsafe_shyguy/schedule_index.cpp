@@ -0,0 +1,131 @@
+#include "schedule_index.hpp"
+
+#include <utility>
+
+namespace cosmos::inline v1
+{
+    namespace
+    {
+        // calc_next keeps the seconds it is given and answers a time inside a matching minute with
+        // itself; from the whole minute it returns the next fire after that minute, on the minute.
+        auto next_fire(geheb::cron_expression const &expression, schedule_index::clock_type::time_point now)
+        {
+            return expression.calc_next(std::chrono::floor<std::chrono::minutes>(now));
+        }
+    } // namespace
+
+    auto schedule_index::upsert(std::string const &dag, std::string const &cron, clock_type::time_point now) -> bool
+    {
+        std::optional<schedule> parsed{};
+        try
+        {
+            geheb::cron_expression expression{cron};
+            auto const next = next_fire(expression, now);
+            parsed.emplace(schedule{.dag = dag, .cron = cron, .expression = std::move(expression), .next = next});
+        }
+        catch (...)
+        {
+            (void) erase(dag);
+            return false;
+        }
+
+        if (auto const found = handles.find(dag); found != handles.end())
+            return heap.update(found->second, [&](schedule &entry) { entry = std::move(*parsed); });
+
+        handles.emplace(dag, heap.push(std::move(*parsed)));
+        return true;
+    }
+
+    auto schedule_index::erase(std::string const &dag) -> bool
+    {
+        auto const found = handles.find(dag);
+        if (found == handles.end())
+            return false;
+        (void) heap.erase(found->second);
+        handles.erase(found);
+        return true;
+    }
+
+    auto schedule_index::due(clock_type::time_point now) const noexcept -> bool
+    {
+        return not heap.empty() and heap.top().next <= now;
+    }
+
+    auto schedule_index::advance(clock_type::time_point now) -> std::size_t
+    {
+        std::size_t moved{0};
+        while (due(now))
+            moved += advance_top(now) ? 1 : 0;
+        return moved;
+    }
+
+    auto schedule_index::take_due(clock_type::time_point now) -> std::vector<due_dag>
+    {
+        std::vector<due_dag> fired{};
+        while (due(now))
+        {
+            auto const &top = heap.top();
+            due_dag entry{.name = top.dag, .cron = top.cron, .time = top.next};
+            if (advance_top(now))
+                fired.push_back(std::move(entry));
+        }
+        return fired;
+    }
+
+    auto schedule_index::earliest() const noexcept -> std::optional<clock_type::time_point>
+    {
+        if (heap.empty())
+            return std::nullopt;
+        return heap.top().next;
+    }
+
+    auto schedule_index::advance_top(clock_type::time_point now) -> bool
+    {
+        // An expression that stops producing later times (or throws) is dropped instead of spinning here.
+        auto const top = heap.top_handle();
+        auto advanced = false;
+        (void) heap.update(top, [&](schedule &entry)
+        {
+            try
+            {
+                auto const next = next_fire(entry.expression, now);
+                advanced = next > now;
+                entry.next = next;
+            }
+            catch (...)
+            {
+            }
+        });
+        if (not advanced)
+        {
+            auto const dropped = heap.erase(top);
+            if (dropped)
+                handles.erase(dropped->dag);
+        }
+        return advanced;
+    }
+
+    auto schedule_index::next_batch() const -> std::vector<due_dag>
+    {
+        std::vector<due_dag> batch{};
+        if (heap.empty())
+            return batch;
+
+        auto const earliest = heap.top().next;
+        heap.visit_top([earliest](schedule const &entry) { return entry.next == earliest; },
+                       [&batch](schedule const &entry)
+                       {
+                           batch.push_back({.name = entry.dag, .cron = entry.cron, .time = entry.next});
+                       });
+        return batch;
+    }
+
+    auto schedule_index::next_time_of(std::string const &dag) const -> std::optional<clock_type::time_point>
+    {
+        auto const found = handles.find(dag);
+        if (found == handles.end())
+            return std::nullopt;
+        auto const *entry = heap.get(found->second);
+        return entry ? std::optional{entry->next} : std::nullopt;
+    }
+} // namespace cosmos::inline v1
@@ -0,0 +1,78 @@
+// Precompiled cron schedules of every DAG, ordered by next fire time
+#pragma once
+
+// *** Project Includes ***
+#include "indexed_heap.hpp"
+
+// *** 3rd Party Includes ***
+#include <cron_parser/cron_expression.hpp>
+
+// *** Standard Includes ***
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief each DAG's cron expression is parsed once, when it is added, and the DAGs sit in a
+     * min-heap keyed by their next fire time. Finding what runs next is a look at the top (plus a
+     * walk over the entries tied with it), and only DAGs that actually fired are moved on: nothing
+     * is recomputed for the thousands of DAGs that are not due. Not synchronized.
+     */
+    class schedule_index
+    {
+    public:
+        using clock_type = std::chrono::system_clock;
+
+        struct due_dag
+        {
+            std::string name{};
+            std::string cron{};
+            clock_type::time_point time{};
+        };
+
+        // Adds the DAG or replaces its expression; false (and the DAG left out) when `cron` does not parse.
+        auto upsert(std::string const &dag, std::string const &cron, clock_type::time_point now) -> bool;
+        auto erase(std::string const &dag) -> bool;
+
+        // True when the earliest fire time is at or before `now`, i.e. advance() has work to do.
+        [[nodiscard]] auto due(clock_type::time_point now) const noexcept -> bool;
+        // Moves every DAG due at or before `now` to its first fire time after `now`, returns how many moved.
+        auto advance(clock_type::time_point now) -> std::size_t;
+        // advance(), returning the DAGs it moved with the fire time each one was due at.
+        auto take_due(clock_type::time_point now) -> std::vector<due_dag>;
+
+        [[nodiscard]] auto earliest() const noexcept -> std::optional<clock_type::time_point>;
+
+        // Every DAG sharing the earliest fire time, empty when nothing is scheduled.
+        [[nodiscard]] auto next_batch() const -> std::vector<due_dag>;
+        [[nodiscard]] auto next_time_of(std::string const &dag) const -> std::optional<clock_type::time_point>;
+
+        [[nodiscard]] auto size() const noexcept -> std::size_t { return handles.size(); }
+        [[nodiscard]] auto empty() const noexcept -> bool { return handles.empty(); }
+
+    private:
+        // Moves the top entry past `now`, or drops it when its expression has no later time.
+        auto advance_top(clock_type::time_point now) -> bool;
+
+        struct schedule
+        {
+            std::string dag{};
+            std::string cron{};
+            geheb::cron_expression expression;
+            clock_type::time_point next{};
+        };
+
+        struct later_first
+        {
+            auto operator()(schedule const &lhs, schedule const &rhs) const noexcept -> bool { return lhs.next > rhs.next; }
+        };
+
+        indexed_heap<schedule, later_first> heap{};
+        std::unordered_map<std::string, heap_handle> handles{};
+    };
+} // namespace cosmos::inline v1
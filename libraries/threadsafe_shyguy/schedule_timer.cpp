@@ -0,0 +1,77 @@
+#include "schedule_timer.hpp"
+
+#include "concurrent_shyguy.hpp"
+
+#include <utility>
+
+namespace cosmos::inline v1
+{
+    schedule_timer::schedule_timer(timer_service &timers_, concurrent_shyguy &shy_guy_, after_fire_type after_fire_) :
+        timers{timers_}, shy_guy{shy_guy_}, after_fire{std::move(after_fire_)}
+    {
+        alive->owner = this;
+        rearm();
+    }
+
+    schedule_timer::~schedule_timer()
+    {
+        {
+            std::lock_guard lock(alive->mutex);
+            alive->owner = nullptr;
+        }
+        std::lock_guard lock(mutex);
+        stopped = true;
+        if (armed)
+            (void) timers.cancel(*armed);
+    }
+
+    auto schedule_timer::rearm() -> void
+    {
+        auto const next = shy_guy.next_fire_time();
+        std::lock_guard lock(mutex);
+        arm(next);
+    }
+
+    auto schedule_timer::armed_for() const -> std::optional<std::chrono::system_clock::time_point>
+    {
+        std::lock_guard lock(mutex);
+        return armed ? std::optional{armed_time} : std::nullopt;
+    }
+
+    auto schedule_timer::arm(std::optional<std::chrono::system_clock::time_point> next) -> void
+    {
+        if (stopped or (armed and next == armed_time))
+            return;
+        // A timer that already went off is not pending any more: its fire() arms the next one.
+        if (armed)
+            (void) timers.cancel(*armed);
+        armed.reset();
+        if (not next)
+            return;
+        auto const wait = std::chrono::duration_cast<timer_service::clock_type::duration>(*next - std::chrono::system_clock::now());
+        armed = timers.schedule_after(wait, [alive = alive]
+        {
+            std::lock_guard lock(alive->mutex);
+            if (alive->owner)
+                alive->owner->fire();
+        });
+        armed_time = *next;
+    }
+
+    auto schedule_timer::fire() -> void
+    {
+        {
+            std::lock_guard lock(mutex);
+            armed.reset();
+        }
+
+        // Each DAG's fire is taken (and its schedule moved on) once, however the timer and rearm() race.
+        auto const queued = shy_guy.fire_due_schedules();
+        if (queued > 0 and after_fire)
+            after_fire(queued);
+
+        auto const next = shy_guy.next_fire_time();
+        std::lock_guard lock(mutex);
+        arm(next);
+    }
+} // namespace cosmos::inline v1
@@ -0,0 +1,64 @@
+// Cron schedules fired from the timer service
+#pragma once
+
+// *** Project Includes ***
+#include "fwd_vocabulary.hpp"
+#include "timer_service.hpp"
+
+// *** Standard Includes ***
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief keeps one timer armed at the earliest cron fire time of the orchestrator. When it fires,
+     * a run of every DAG that came due is queued at its fire time, `after_fire` is told how many,
+     * and the timer is armed for the next fire time. rearm() after anything that may have moved a
+     * schedule; it leaves the wheel alone when the earliest fire time did not change.
+     */
+    class schedule_timer
+    {
+    public:
+        using after_fire_type = std::function<void(std::size_t queued)>;
+
+        // Armed right away for whatever is already scheduled.
+        schedule_timer(timer_service &timers, concurrent_shyguy &shy_guy, after_fire_type after_fire = {});
+        schedule_timer(schedule_timer const &) = delete;
+        schedule_timer &operator=(schedule_timer const &) = delete;
+        // Disarms, and waits for a firing already under way to finish.
+        ~schedule_timer();
+
+        auto rearm() -> void;
+
+        [[nodiscard]] auto armed_for() const -> std::optional<std::chrono::system_clock::time_point>;
+
+    private:
+        // Shared with the armed callback, which can be on its way in while this is destroyed: it
+        // reaches the timer through `owner`, cleared by the destructor under `mutex`.
+        struct lifetime
+        {
+            std::mutex mutex{};
+            schedule_timer *owner{nullptr};
+        };
+
+        auto fire() -> void;
+        // mutex must be held.
+        auto arm(std::optional<std::chrono::system_clock::time_point> next) -> void;
+
+        timer_service &timers;
+        concurrent_shyguy &shy_guy;
+        after_fire_type after_fire{};
+
+        std::shared_ptr<lifetime> alive{std::make_shared<lifetime>()};
+        mutable std::mutex mutex{};
+        std::optional<timer_handle> armed{};
+        // Wall-clock, as cron fire times are; compared exactly so an unchanged schedule keeps its timer.
+        std::chrono::system_clock::time_point armed_time{};
+        bool stopped{false};
+    };
+} // namespace cosmos::inline v1
@@ -0,0 +1,113 @@
+#include "timer_service.hpp"
+
+#include <limits>
+#include <utility>
+
+namespace cosmos::inline v1
+{
+    timer_service::timer_service(clock_type::duration tick_) : origin{clock_type::now()}, tick{tick_}
+    {
+        worker = std::thread{[this] { timer_loop(); }};
+    }
+
+    timer_service::~timer_service()
+    {
+        stop();
+    }
+
+    auto timer_service::schedule_at(clock_type::time_point when, callback_type callback) -> timer_handle
+    {
+        auto const deadline = deadline_tick(when);
+        std::lock_guard lock(mutex);
+        if (stopping)
+            return {};
+        auto const timer = wheel.insert(deadline, std::move(callback));
+        if (asleep and deadline < sleeping_until)
+            wake.notify_one();
+        return timer;
+    }
+
+    auto timer_service::schedule_after(clock_type::duration delay, callback_type callback) -> timer_handle
+    {
+        return schedule_at(clock_type::now() + delay, std::move(callback));
+    }
+
+    auto timer_service::cancel(timer_handle timer) -> bool
+    {
+        std::optional<callback_type> cancelled{};
+        {
+            std::lock_guard lock(mutex);
+            cancelled = wheel.cancel(timer);
+        }
+        // Destroyed here, outside the lock: its captures may cancel timers of their own.
+        return cancelled.has_value();
+    }
+
+    auto timer_service::stop() -> void
+    {
+        timer_wheel<callback_type> dropped{};
+        {
+            std::lock_guard lock(mutex);
+            if (stopping)
+                return;
+            stopping = true;
+            std::swap(dropped, wheel);
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    auto timer_service::pending() const -> std::size_t
+    {
+        std::lock_guard lock(mutex);
+        return wheel.size();
+    }
+
+    auto timer_service::fired() const -> std::size_t
+    {
+        std::lock_guard lock(mutex);
+        return fired_count;
+    }
+
+    auto timer_service::deadline_tick(clock_type::time_point when) const noexcept -> std::uint64_t
+    {
+        if (when <= origin)
+            return 0;
+        auto const ticks = (when - origin + tick - clock_type::duration{1}) / tick;
+        return static_cast<std::uint64_t>(ticks);
+    }
+
+    auto timer_service::current_tick() const noexcept -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>((clock_type::now() - origin) / tick);
+    }
+
+    auto timer_service::timer_loop() -> void
+    {
+        std::unique_lock lock(mutex);
+        while (not stopping)
+        {
+            (void) wheel.advance(current_tick());
+            if (auto expired = wheel.pop_expired())
+            {
+                auto callback = std::move(expired->second);
+                expired.reset();
+                ++fired_count;
+                lock.unlock();
+                callback();
+                callback = nullptr;
+                lock.lock();
+                continue;
+            }
+
+            auto const next = wheel.next_deadline();
+            asleep = true;
+            sleeping_until = next.value_or(std::numeric_limits<std::uint64_t>::max());
+            if (next)
+                (void) wake.wait_until(lock, origin + static_cast<clock_type::rep>(*next) * tick);
+            else
+                wake.wait(lock);
+            asleep = false;
+        }
+    }
+} // namespace cosmos::inline v1
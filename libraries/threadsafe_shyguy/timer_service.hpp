@@ -0,0 +1,69 @@
+// One thread firing callbacks off a hierarchical timing wheel
+#pragma once
+
+// *** Project Includes ***
+#include "small_function.hpp"
+#include "timer_wheel.hpp"
+
+// *** Standard Includes ***
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace cosmos::inline v1
+{
+    /**
+     * @brief timers for the whole daemon: scheduling or cancelling one is O(1) however many are
+     * pending, and a single thread sleeps until the earliest one and runs the callbacks, one at a
+     * time and without the service's lock held (they may schedule or cancel timers themselves).
+     * Deadlines are rounded up to whole ticks, so a callback never runs early. Internally synchronized.
+     */
+    class timer_service
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+        using callback_type = small_function<void()>;
+
+        static constexpr clock_type::duration default_tick = std::chrono::milliseconds{1};
+
+        explicit timer_service(clock_type::duration tick = default_tick);
+        timer_service(timer_service const &) = delete;
+        timer_service &operator=(timer_service const &) = delete;
+        ~timer_service();
+
+        // Runs `callback` on the timer thread once `when` has passed. After stop() it is dropped (invalid handle).
+        auto schedule_at(clock_type::time_point when, callback_type callback) -> timer_handle;
+        auto schedule_after(clock_type::duration delay, callback_type callback) -> timer_handle;
+        // True when the timer was still pending. Never waits: a callback already running finishes.
+        auto cancel(timer_handle timer) -> bool;
+
+        // Drops the pending timers and joins the thread, after the callback in flight returns.
+        auto stop() -> void;
+
+        [[nodiscard]] auto pending() const -> std::size_t;
+        [[nodiscard]] auto fired() const -> std::size_t;
+
+    private:
+        // Wheel ticks since `origin`: rounded up for deadlines, down for the current time.
+        [[nodiscard]] auto deadline_tick(clock_type::time_point when) const noexcept -> std::uint64_t;
+        [[nodiscard]] auto current_tick() const noexcept -> std::uint64_t;
+        auto timer_loop() -> void;
+
+        clock_type::time_point const origin;
+        clock_type::duration const tick;
+
+        mutable std::mutex mutex{};
+        std::condition_variable wake{};
+        timer_wheel<callback_type> wheel{};
+        // While the thread sleeps: the tick it wakes at, so only an earlier deadline has to wake it.
+        bool asleep{false};
+        std::uint64_t sleeping_until{0};
+        std::size_t fired_count{0};
+        bool stopping{false};
+
+        std::thread worker{};
+    };
+} // namespace cosmos::inline v1
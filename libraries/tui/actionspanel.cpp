@@ -273,6 +273,7 @@ namespace cosmos::inline v1
         task_file_field = ftxui::Input(&task_file_path_input, "task file path");
         task_deps_field = ftxui::Input(&task_dependencies_input, "deps: a,b,c");
 
+        // Runs on the UI thread, so a full io_queue rejects the request instead of freezing the screen.
         auto submit_request = [&]() -> bool
         {
             if (not io_queue)
@@ -337,7 +338,11 @@ namespace cosmos::inline v1
                 }
 
                 request.emplace(shyguy_dag{.name = dag_name, .schedule = schedule});
-                io_queue->enqueue(std::move(request));
+                if (not io_queue->try_enqueue(std::move(request)))
+                {
+                    status_line = "IO queue is full, '" + action + "' was not sent";
+                    return true;
+                }
                 status_line = "Queued '" + action + "' for dag '" + dag_name + "'";
                 return true;
             }
@@ -388,7 +393,11 @@ namespace cosmos::inline v1
                     .dependency_names = std::move(dep_opt),
                 });
 
-                io_queue->enqueue(std::move(request));
+                if (not io_queue->try_enqueue(std::move(request)))
+                {
+                    status_line = "IO queue is full, '" + action + "' was not sent";
+                    return true;
+                }
                 status_line = "Queued '" + action + "' for task '" + dag_name + " :: " + task_name + "'";
                 return true;
             }
@@ -406,7 +415,11 @@ namespace cosmos::inline v1
                 .associated_dag = dag_name,
             });
 
-            io_queue->enqueue(std::move(request));
+            if (not io_queue->try_enqueue(std::move(request)))
+            {
+                status_line = "IO queue is full, '" + action + "' was not sent";
+                return true;
+            }
             status_line = "Queued '" + action + "' for " + dag_name + " :: " + task_name;
             return true;
         };
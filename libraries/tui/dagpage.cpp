@@ -14,8 +14,10 @@
 #include <ctime>
 #include <iomanip>
 #include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace cosmos::inline v1
@@ -47,24 +49,6 @@ namespace cosmos::inline v1
             return {view.begin(), view.end()};
         }
 
-        [[nodiscard]] auto frequency_interval(schedule_frequency frequency) -> std::chrono::system_clock::duration
-        {
-            using namespace std::chrono;
-            switch (frequency)
-            {
-                case schedule_frequency::hourly:  return hours{1};
-                case schedule_frequency::daily:   return hours{24};
-                case schedule_frequency::weekly:  return hours{24 * 7};
-                case schedule_frequency::monthly: return hours{24 * 30};
-                case schedule_frequency::yearly:  return hours{24 * 365};
-                case schedule_frequency::custom:
-                case schedule_frequency::unset:
-                case schedule_frequency::unknown:
-                default:
-                    return hours{24};
-            }
-        }
-
         [[nodiscard]] auto format_timestamp(std::chrono::system_clock::time_point tp) -> std::string
         {
             auto const time = std::chrono::system_clock::to_time_t(tp);
@@ -81,21 +65,28 @@ namespace cosmos::inline v1
             return oss.str();
         }
 
-        [[nodiscard]] auto make_run_labels(schedule_frequency frequency, std::size_t count) -> std::vector<std::string>
+        // One column per recorded run, oldest left and right-aligned; columns without a run stay blank.
+        [[nodiscard]] auto make_run_labels(std::span<const run_summary> runs, std::size_t count) -> std::vector<std::string>
         {
-            std::vector<std::string> labels;
-            labels.reserve(count);
-            auto interval = frequency_interval(frequency);
-            if (interval <= std::chrono::system_clock::duration::zero())
-                interval = std::chrono::hours{24};
-            auto const now = std::chrono::system_clock::now();
-            for (std::size_t index = count; index > 0; --index)
+            std::vector<std::string> labels(count - std::min(count, runs.size()));
+            for (auto const& run : runs | std::views::take(count))
+                labels.emplace_back(format_timestamp(run.started));
+            return labels;
+        }
+
+        [[nodiscard]] auto task_statuses(std::span<const run_summary> runs, std::string_view task, std::size_t count)
+            -> std::vector<dag_run_status>
+        {
+            std::vector<dag_run_status> statuses(count, dag_run_status::none);
+            auto column = count - std::min(count, runs.size());
+            for (auto const& run : runs | std::views::take(count))
             {
-                auto const offset = static_cast<int>(index - 1);
-                auto const tp = now - interval * offset;
-                labels.emplace_back(format_timestamp(tp));
+                auto const found = std::ranges::find(run.tasks, task, &run_record::task);
+                if (found != run.tasks.end())
+                    statuses[column] = found->status;
+                ++column;
             }
-            return labels;
+            return statuses;
         }
     } // namespace
 
@@ -153,7 +144,8 @@ namespace cosmos::inline v1
             return ftxui::text(message) | ftxui::dim;
         }
 
-        auto const run_labels = make_run_labels(frequency, run_history_columns);
+        auto const runs = storage->runs().last_runs(dag_name, run_history_columns);
+        auto const run_labels = make_run_labels(runs, run_history_columns);
         std::vector<std::vector<std::string>> table_rows;
         table_rows.reserve(tasks.size() + 1);
 
@@ -177,13 +169,7 @@ namespace cosmos::inline v1
             row.reserve(run_history_columns + 1);
             row.push_back(entry.value.name);
 
-            std::vector<dag_run_status> statuses(run_history_columns, dag_run_status::none);
-            if (entry.metadata)
-            {
-                statuses.back() = entry.metadata->statuses.current;
-                if (run_history_columns > 1U)
-                    statuses[run_history_columns - 2U] = entry.metadata->statuses.previous;
-            }
+            auto statuses = task_statuses(runs, entry.value.name, run_history_columns);
 
             for (std::size_t column = 0; column < run_history_columns; ++column)
                 row.emplace_back(status_cell_fill);
@@ -7,6 +7,7 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <threadsafe_shyguy/concurrent_shyguy.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
@@ -64,25 +65,7 @@ namespace cosmos::inline v1
             }
         }
 
-        [[nodiscard]] auto frequency_interval(schedule_frequency frequency) -> std::chrono::system_clock::duration
-        {
-            using namespace std::chrono;
-            switch (frequency)
-            {
-                case schedule_frequency::hourly:  return hours{1};
-                case schedule_frequency::daily:   return hours{24};
-                case schedule_frequency::weekly:  return hours{24 * 7};
-                case schedule_frequency::monthly: return hours{24 * 30};
-                case schedule_frequency::yearly:  return hours{24 * 365};
-                case schedule_frequency::custom:
-                case schedule_frequency::unset:
-                case schedule_frequency::unknown:
-                default:
-                    return hours{24};
-            }
-        }
-
-        [[nodiscard]] auto format_date_mm_dd_yyyy(std::chrono::system_clock::time_point tp) -> std::string
+        [[nodiscard]] auto format_run_start(std::chrono::system_clock::time_point tp) -> std::string
         {
             auto const time = std::chrono::system_clock::to_time_t(tp);
             std::tm tm{};
@@ -92,54 +75,38 @@ namespace cosmos::inline v1
             localtime_r(&time, &tm);
 #endif
             std::ostringstream oss;
-            oss << std::put_time(&tm, "%m/%d/%Y");
+            oss << std::put_time(&tm, "%m/%d %H:%M");
             if (oss.fail())
                 return "n/a";
             return oss.str();
         }
 
-        [[nodiscard]] auto infer_frequency(std::span<const task_entry> tasks) -> schedule_frequency
+        // One column per recorded run, oldest left and right-aligned; columns without a run stay blank.
+        [[nodiscard]] auto make_run_labels(std::span<const run_summary> runs, std::size_t count) -> std::vector<std::string>
         {
-            schedule_frequency inferred = schedule_frequency::unset;
-            for (auto const& entry : tasks)
-            {
-                if (not entry.metadata)
-                    continue;
-
-                auto const freq = entry.metadata->schedule.frequency;
-                if (freq == schedule_frequency::unset || freq == schedule_frequency::unknown)
-                    continue;
-
-                if (inferred == schedule_frequency::unset)
-                    inferred = freq;
-                else if (inferred != freq)
-                    return schedule_frequency::daily;
-            }
-
-            if (inferred == schedule_frequency::unset)
-                return schedule_frequency::daily;
-            return inferred;
+            std::vector<std::string> labels(count - std::min(count, runs.size()));
+            for (auto const& run : runs | std::views::take(count))
+                labels.emplace_back(format_run_start(run.started));
+            return labels;
         }
 
-        [[nodiscard]] auto make_run_labels(schedule_frequency frequency, std::size_t count) -> std::vector<std::string>
+        [[nodiscard]] auto task_statuses(std::span<const run_summary> runs, std::string_view task, std::size_t count)
+            -> std::vector<dag_run_status>
         {
-            std::vector<std::string> labels;
-            labels.reserve(count);
-
-            auto interval = frequency_interval(frequency);
-            if (interval <= std::chrono::system_clock::duration::zero())
-                interval = std::chrono::hours{24};
-
-            auto const now = std::chrono::system_clock::now();
-            for (std::size_t index = count; index > 0; --index)
+            std::vector<dag_run_status> statuses(count, dag_run_status::none);
+            auto column = count - std::min(count, runs.size());
+            for (auto const& run : runs | std::views::take(count))
             {
-                auto const offset = static_cast<int>(index - 1);
-                labels.emplace_back(format_date_mm_dd_yyyy(now - interval * offset));
+                auto const found = std::ranges::find(run.tasks, task, &run_record::task);
+                if (found != run.tasks.end())
+                    statuses[column] = found->status;
+                ++column;
             }
-            return labels;
+            return statuses;
         }
 
-        [[nodiscard]] auto build_dag_task_table(std::string_view dag_name, std::span<const task_entry> tasks) -> ftxui::Element
+        [[nodiscard]] auto build_dag_task_table(std::string_view dag_name, std::span<const task_entry> tasks,
+                                                std::span<const run_summary> runs) -> ftxui::Element
         {
             if (tasks.empty())
             {
@@ -148,8 +115,7 @@ namespace cosmos::inline v1
                 return ftxui::text(message) | ftxui::dim;
             }
 
-            auto const frequency = infer_frequency(tasks);
-            auto const run_labels = make_run_labels(frequency, run_history_columns);
+            auto const run_labels = make_run_labels(runs, run_history_columns);
 
             std::vector<std::vector<std::string>> table_rows;
             table_rows.reserve(tasks.size() + 1);
@@ -169,14 +135,7 @@ namespace cosmos::inline v1
                 row.reserve(run_history_columns + 1);
                 row.push_back(entry.value.name);
 
-                std::vector<dag_run_status> statuses(run_history_columns, dag_run_status::none);
-                if (entry.metadata)
-                {
-                    statuses.back() = entry.metadata->statuses.current;
-                    if (run_history_columns > 1U)
-                        statuses[run_history_columns - 2U] = entry.metadata->statuses.previous;
-                }
-
+                auto statuses = task_statuses(runs, entry.value.name, run_history_columns);
                 for (auto const& status : statuses)
                     row.emplace_back(std::string{status_glyph(status)});
 
@@ -281,7 +240,8 @@ namespace cosmos::inline v1
             }
             else
             {
-                element = build_dag_task_table(dag_name, tasks_expected.value());
+                auto const runs = storage->runs().last_runs(dag_name, run_history_columns);
+                element = build_dag_task_table(dag_name, tasks_expected.value(), runs);
             }
 
             menu_components.push_back(ftxui::Renderer([element] { return element; }));
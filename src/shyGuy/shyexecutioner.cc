@@ -18,9 +18,11 @@
 #include <chrono>
 #include <cstdint>
 #include <graph/graph.hpp>
+#include <iterator>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace cosmos::inline v1
 {
@@ -54,21 +56,25 @@ namespace cosmos::inline v1
 
         std::atomic_uint32_t in_flight_dags{0};
 
-        auto select_ready_tasks = [&](const directed_acyclic_graph &dag, 
+        // Cost model: of the runnable tasks, start the most expensive ones (by smoothed wall time of
+        // earlier runs) first, so long tasks do not end up alone in the last wave.
+        auto select_ready_tasks = [&](const directed_acyclic_graph &dag,
+                                      const task_index &by_name,
                                       const name_set &pending,
                                       const name_set &completed) -> std::vector<std::string>
         {
             std::vector<std::string> ready;
-            ready.reserve(max_task_concurrency);
             for (auto const &name: pending)
             {
                 if (dag.is_task_ready(completed, name))
-                {
                     ready.push_back(name);
-                    if (ready.size() >= max_task_concurrency)
-                        break;
-                }
             }
+
+            auto const cost_of = [&](std::string const &name) { return by_name.at(name).get().expected_cost; };
+            auto const keep = std::min(ready.size(), max_task_concurrency);
+            std::ranges::partial_sort(ready, ready.begin() + static_cast<std::ptrdiff_t>(keep),
+                                      [&](auto const &a, auto const &b) { return cost_of(a) > cost_of(b); });
+            ready.resize(keep);
             return ready;
         };
 
@@ -90,6 +96,7 @@ namespace cosmos::inline v1
                                 [&](task_runner &r)
                                 {
                                     logger->info("[shy_exec] Starting task: {} in DAG: {}", r.name, dag.view_name());
+                                    r.start = std::chrono::steady_clock::now();
                                     try
                                     {
                                         if (r.task_function)
@@ -105,7 +112,9 @@ namespace cosmos::inline v1
                                     {
                                         logger->error("[shy_exec] Task '{}' threw unknown exception", r.name);
                                     }
-                                    logger->info("[shy_exec] Finished task: {} in DAG: {}", r.name, dag.view_name());
+                                    r.end = std::chrono::steady_clock::now();
+                                    logger->info("[shy_exec] Finished task: {} in DAG: {} in {}ms", r.name, dag.view_name(),
+                                                 std::chrono::duration_cast<std::chrono::milliseconds>(r.end - r.start).count());
                                     return r.name;
                                 }) |
                         stdexec::then(
@@ -137,7 +146,7 @@ namespace cosmos::inline v1
 
             while (not pending.empty() and running->load(std::memory_order_relaxed))
             {
-                auto ready = select_ready_tasks(dag, pending, completed);
+                auto ready = select_ready_tasks(dag, by_name, pending, completed);
                 if (ready.empty())
                 {
                     logger->error("[shy_exec] No ready tasks but pending remain in DAG: {}. Possible dependency issue.",
@@ -154,11 +163,17 @@ namespace cosmos::inline v1
             }
         };
 
+        // Drain everything that is due in one lock round-trip: when a cron minute fires for many DAGs
+        // they are picked up as one batch instead of one wake-up each.
+        auto const batch_limit = std::max<std::size_t>(dag_threads, 64);
+        std::vector<task_request_ptr> batch{};
+        batch.reserve(batch_limit);
+
         auto last_work = std::chrono::steady_clock::now();
         while (running->load(std::memory_order_relaxed))
         {
-            auto request = request_queue->dequeue_wait(idle_timeout);
-            if (not request)
+            batch.clear();
+            if (request_queue->dequeue_bulk(std::back_inserter(batch), batch_limit, idle_timeout) == 0)
             {
                 if (in_flight_dags.load(std::memory_order_relaxed) == 0U
                     && (std::chrono::steady_clock::now() - last_work) >= idle_timeout)
@@ -170,31 +185,34 @@ namespace cosmos::inline v1
 
             last_work = std::chrono::steady_clock::now();
 
-            in_flight_dags.fetch_add(1U, std::memory_order_relaxed);
-            auto sender = stdexec::just(std::move(*request))
-                | stdexec::then([&](task_request_ptr tr)
-                {
-                    try
-                    {
-                        if (not tr)
-                            return;
-
-                        auto& [task_runners, dag] = tr->payload;
-                        run_dependency_waves(dag, std::move(task_runners));
-                    }
-                    catch (std::exception const& e)
-                    {
-                        logger->error("[shy_exec] DAG runner threw exception: {}", e.what());
-                    }
-                    catch (...)
+            for (auto& request: batch)
+            {
+                in_flight_dags.fetch_add(1U, std::memory_order_relaxed);
+                auto sender = stdexec::just(std::move(request))
+                    | stdexec::then([&](task_request_ptr tr)
                     {
-                        logger->error("[shy_exec] DAG runner threw unknown exception");
-                    }
-
-                    in_flight_dags.fetch_sub(1U, std::memory_order_relaxed);
-                });
-
-            dag_scope.spawn(stdexec::on(dag_scheduler, std::move(sender)));
+                        try
+                        {
+                            if (not tr)
+                                return;
+
+                            auto& [task_runners, dag] = tr->payload;
+                            run_dependency_waves(dag, std::move(task_runners));
+                        }
+                        catch (std::exception const& e)
+                        {
+                            logger->error("[shy_exec] DAG runner threw exception: {}", e.what());
+                        }
+                        catch (...)
+                        {
+                            logger->error("[shy_exec] DAG runner threw unknown exception");
+                        }
+
+                        in_flight_dags.fetch_sub(1U, std::memory_order_relaxed);
+                    });
+
+                dag_scope.spawn(stdexec::on(dag_scheduler, std::move(sender)));
+            }
         }
 
         stdexec::sync_wait(dag_scope.on_empty());
@@ -4,6 +4,9 @@
 #include "fs_storage.hpp"
 #include <shyguy_request.hpp>
 #include "concurrent_shyguy.hpp"
+#include "interpreter_pool.hpp"
+#include "schedule_timer.hpp"
+#include "timer_service.hpp"
 #include "zmq_router.hpp"
 #include "tui.h"
 #include "shyexecutioner.hpp"
@@ -16,8 +19,9 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <stdexec/execution.hpp>
 
-// *** Standard ***
-#include <unordered_map>
+// *** Standard Includes ***
+#include <cstring>
+#include <functional>
 
 namespace cosmos::inline v1
 {
@@ -38,17 +42,48 @@ namespace cosmos::inline v1
     {
         auto file_logger = spdlog::basic_logger_mt("shyguy_logger", "logs/shy-log.txt", true);
         auto request_queue = std::make_shared<blocking_priority_queue<task_request_ptr, task_request_ptr_compare>>();
+        // Holds blocking_queue::default_capacity requests; the actions panel reports a full queue
+        // instead of blocking on it, so a stalled request thread cannot hang the TUI.
         auto io_queue      = std::make_shared<blocking_queue<shyguy_request>>();
         auto store         = std::make_shared<fs_storage>(root_folder());
         auto terminator    = std::make_shared<std::atomic_bool>(true);
-        auto shyguy        = std::make_shared<concurrent_shyguy>(request_queue, terminator, store);
+        auto python_pool   = arguments.python_workers == 0 ? interpreter_pool_t{}
+                           : std::make_shared<interpreter_pool>(interpreter_pool_options{
+                                 .workers = arguments.python_workers,
+                                 .recycle_after = arguments.python_worker_recycle});
+        auto task_cgroup   = std::optional<cgroup_options>{};
+        if (not arguments.task_cgroup.empty())
+        {
+            task_cgroup = cgroup_options{.parent = arguments.task_cgroup};
+            if (arguments.task_memory_limit_mb > 0)
+                task_cgroup->memory_max_bytes = arguments.task_memory_limit_mb * 1024U * 1024U;
+            if (arguments.task_cpu_limit > 0.0)
+                task_cgroup->cpu_max_cores = arguments.task_cpu_limit;
+            // Said once here rather than per task: with limits every launch fails, without them tasks
+            // run unaccounted.
+            if (auto const probe = cosmos::task_cgroup::create(*task_cgroup); not probe)
+                file_logger->error("--task-cgroup {}: cannot create task cgroups ({}), {}", arguments.task_cgroup,
+                                   std::strerror(probe.error()),
+                                   task_cgroup->limited() ? "tasks will fail to launch"
+                                                          : "tasks run without cgroup accounting");
+        }
+        auto shyguy        = std::make_shared<concurrent_shyguy>(request_queue, terminator, store, task_launch_options{
+                                 .python_pool = python_pool,
+                                 .cgroup = task_cgroup,
+                                 .in_memory = not arguments.disk_scripts,
+                                 .scheduled_release = release_options{
+                                     .spread = std::chrono::milliseconds{arguments.schedule_spread_ms},
+                                     .starts_per_second = arguments.scheduled_starts_per_second,
+                                     .burst = arguments.scheduled_start_burst}});
+        // Everything stored before a restart is scheduled again before the first request is served.
+        if (auto const loaded = shyguy->warm_start(); not loaded)
+            file_logger->error("warm start failed: storage error {}", static_cast<int>(loaded.error()));
 
 
         auto high_level_pool = exec::static_thread_pool{3};
         auto high_level_scheduler = high_level_pool.get_scheduler();
         auto scope = exec::async_scope{};
 
-        notify_updater notifier{};
         std::mutex execution_mutex{};
         std::atomic_bool execution_running{false};
         std::optional<std::thread> execution_thread{};
@@ -79,56 +114,54 @@ namespace cosmos::inline v1
             });
         };
 
+        // Cron fires (and every other timer) come off one wheel; the timer thread queues the due runs.
+        timer_service timers{};
+        schedule_timer cron{timers, *shyguy, [&](std::size_t) { ensure_executioner_running(); }};
+
         std::thread request_thread{[&, io_queue]
         {
             using namespace std::chrono_literals;
             while (terminator->load(std::memory_order_relaxed))
             {
-                auto request = io_queue->dequeue_wait(50ms);
+                // Parks on the queue's eventcount; shutdown closes the queue instead of us polling.
+                auto request = io_queue->dequeue_wait(1h);
                 if (not request)
                     continue;
 
                 (void) shyguy->process(*request);
-                if (auto next = shyguy->next_scheduled_dag(); next.has_value())
-                    notifier.notify_wakeup(next.value());
+                cron.rearm();
 
                 ensure_executioner_running();
             }
         }};
 
-        std::thread schedule_thread{[&]
+        // Cron fires missed while the daemon was down; the schedule timer only looks forward.
+        if (arguments.catch_up_parallelism > 0)
         {
-            using namespace std::chrono_literals;
-            std::unordered_map<std::string, std::chrono::steady_clock::time_point> last_enqueued{};
-            while (terminator->load(std::memory_order_relaxed))
+            if (auto const missed = shyguy->catch_up(arguments.catch_up_parallelism); missed > 0)
             {
-                auto next = shyguy->next_scheduled_dag();
-                if (not next)
-                {
-                    (void) notifier.sleep_until_or_notified(std::chrono::steady_clock::now() + std::chrono::months(1));
-                    continue;
-                }
-
-                auto const& scheduled = *next;
-                auto dag_ptr = std::get_if<shyguy_dag>(&scheduled.associated_request.data);
-                if (dag_ptr)
-                {
-                    auto& last = last_enqueued[dag_ptr->name];
-                    if (last != scheduled.time)
-                    {
-                        last = scheduled.time;
-                        (void) shyguy->execute_at(*dag_ptr, scheduled.time);
-                        ensure_executioner_running();
-                    }
-                }
-
-                if (auto notification = notifier.sleep_until_or_notified(scheduled.time); notification.has_value())
-                    continue;
+                file_logger->info("catching up on {} missed cron fire(s)", missed);
+                ensure_executioner_running();
             }
-        }};
+        }
 
-        if (auto next = shyguy->next_scheduled_dag(); next.has_value())
-            notifier.notify_wakeup(next.value());
+        // Run history is trimmed a whole segment at a time: now, after catch-up has read where each
+        // DAG left off, then every hour from the timer thread.
+        std::function<void()> drop_old_runs{};
+        if (arguments.run_history_days > 0)
+        {
+            drop_old_runs = [&]
+            {
+                auto const cutoff = std::chrono::system_clock::now() - std::chrono::days{arguments.run_history_days};
+                if (auto const dropped = store->runs().drop_before(cutoff); not dropped)
+                    file_logger->error("run history retention failed: storage error {}", static_cast<int>(dropped.error()));
+                else if (*dropped > 0)
+                    file_logger->info("dropped {} run history segment(s) older than {} day(s)", *dropped,
+                                      arguments.run_history_days);
+                timers.schedule_after(std::chrono::hours{1}, [&drop_old_runs] { drop_old_runs(); });
+            };
+            drop_old_runs();
+        }
 
         auto interactive_view =
         stdexec::starts_on(high_level_scheduler,
@@ -151,13 +184,10 @@ namespace cosmos::inline v1
         high_level_pool.request_stop();
 
         terminator->store(false, std::memory_order_relaxed);
-        notifier.notify_wakeup({.time = std::chrono::steady_clock::now(),
-                                .associated_request = {},
-                                .command_type = command_enum::error});
+        io_queue->close();
         if (request_thread.joinable())
             request_thread.join();
-        if (schedule_thread.joinable())
-            schedule_thread.join();
+        timers.stop();
         if (execution_thread && execution_thread->joinable())
             execution_thread->join();
 
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+// Create a unique temporary directory for each test run under the system temp, removed with the guard
+struct temp_dir_guard {
+  std::filesystem::path path;
+  explicit temp_dir_guard(std::string const& prefix)
+  {
+    // Append a pseudo-unique suffix using the address of this
+    path = std::filesystem::temp_directory_path() / (prefix + std::to_string(reinterpret_cast<std::uintptr_t>(this)));
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+  }
+  ~temp_dir_guard()
+  {
+    std::error_code ec;
+    std::filesystem::remove_all(path, ec);
+  }
+  temp_dir_guard(temp_dir_guard const&) = delete;
+  auto operator=(temp_dir_guard const&) -> temp_dir_guard& = delete;
+};
@@ -0,0 +1,314 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "blocking_priority_queue.hpp"
+#include "blocking_queue.hpp"
+#include "indexed_heap.hpp"
+#include "mpmc_queue.hpp"
+
+using namespace cosmos; // uses inline v1
+using namespace std::chrono_literals;
+
+TEST_CASE("mpmc_queue is FIFO and bounded", "[queue]")
+{
+  mpmc_queue<std::string> ring{3};
+  REQUIRE(ring.capacity() == 4);
+
+  // A few laps around the ring so sequence numbers wrap per cell.
+  for (int lap = 0; lap < 3; ++lap)
+  {
+    for (int i = 0; i < 4; ++i)
+      REQUIRE(ring.try_enqueue(std::to_string(lap * 10 + i)));
+
+    std::string rejected{"full"};
+    REQUIRE_FALSE(ring.try_enqueue(std::move(rejected)));
+    REQUIRE(rejected == "full");
+    REQUIRE(ring.size_approx() == 4);
+
+    for (int i = 0; i < 4; ++i)
+    {
+      auto value = ring.try_dequeue();
+      REQUIRE(value.has_value());
+      REQUIRE(*value == std::to_string(lap * 10 + i));
+    }
+    REQUIRE_FALSE(ring.try_dequeue().has_value());
+  }
+}
+
+TEST_CASE("mpmc_queue destroys what is left in it", "[queue]")
+{
+  auto tracked = std::make_shared<int>(0);
+  {
+    mpmc_queue<std::shared_ptr<int>> ring{8};
+    for (int i = 0; i < 5; ++i)
+      REQUIRE(ring.try_enqueue(std::shared_ptr<int>{tracked}));
+    REQUIRE(tracked.use_count() == 6);
+  }
+  REQUIRE(tracked.use_count() == 1);
+}
+
+TEST_CASE("blocking_queue dequeue_wait times out and close wakes waiters", "[queue]")
+{
+  blocking_queue<int> queue{};
+
+  auto const start = std::chrono::steady_clock::now();
+  REQUIRE_FALSE(queue.dequeue_wait(20ms).has_value());
+  REQUIRE(std::chrono::steady_clock::now() - start >= 20ms);
+
+  queue.enqueue(7);
+  auto value = queue.dequeue_wait(1s);
+  REQUIRE(value.has_value());
+  REQUIRE(*value == 7);
+
+  std::thread closer{[&] {
+    std::this_thread::sleep_for(20ms);
+    queue.close();
+  }};
+  auto const waited_from = std::chrono::steady_clock::now();
+  REQUIRE_FALSE(queue.dequeue_wait(1h).has_value());
+  REQUIRE(std::chrono::steady_clock::now() - waited_from < 10s);
+  closer.join();
+}
+
+TEST_CASE("blocking_queue delivers every element exactly once across threads", "[queue]")
+{
+  constexpr int producers = 4;
+  constexpr int consumers = 4;
+  constexpr int per_producer = 20'000;
+
+  // Small capacity so producers block on a full ring too.
+  blocking_queue<std::uint64_t> queue{16};
+  std::vector<std::atomic_int> seen(producers * per_producer);
+  std::atomic_int remaining{producers * per_producer};
+
+  std::vector<std::thread> threads{};
+  for (int c = 0; c < consumers; ++c)
+    threads.emplace_back([&] {
+      while (remaining.load() > 0)
+        if (auto value = queue.dequeue_wait(10ms))
+        {
+          seen[*value].fetch_add(1);
+          remaining.fetch_sub(1);
+        }
+    });
+  for (int p = 0; p < producers; ++p)
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < per_producer; ++i)
+        queue.enqueue(static_cast<std::uint64_t>(p * per_producer + i));
+    });
+  for (auto& t: threads)
+    t.join();
+
+  REQUIRE(remaining.load() == 0);
+  int wrong = 0;
+  for (auto const& count: seen)
+    wrong += count.load() == 1 ? 0 : 1;
+  REQUIRE(wrong == 0);
+}
+
+TEST_CASE("indexed_heap orders like std::priority_queue and supports erase/update", "[queue][heap]")
+{
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<int> value{0, 1000};
+
+  indexed_heap<int> heap{};
+  std::vector<std::pair<heap_handle, int>> live{};
+  for (int i = 0; i < 500; ++i)
+  {
+    auto const v = value(rng);
+    live.emplace_back(heap.push(v), v);
+  }
+
+  // Cancel every third entry and bump every fifth, then compare against a reference queue.
+  std::priority_queue<int> reference{};
+  for (std::size_t i = 0; i < live.size(); ++i)
+  {
+    auto& [h, v] = live[i];
+    if (i % 3 == 0)
+    {
+      auto erased = heap.erase(h);
+      REQUIRE(erased.has_value());
+      REQUIRE(*erased == v);
+      REQUIRE_FALSE(heap.contains(h));
+      continue;
+    }
+    if (i % 5 == 0)
+    {
+      v = value(rng);
+      REQUIRE(heap.update(h, [&](int& entry) { entry = v; }));
+    }
+    reference.push(v);
+  }
+
+  REQUIRE(heap.size() == reference.size());
+  while (not reference.empty())
+  {
+    REQUIRE(heap.top() == reference.top());
+    REQUIRE(heap.pop() == reference.top());
+    reference.pop();
+  }
+  REQUIRE(heap.empty());
+}
+
+TEST_CASE("indexed_heap handles go stale once their entry left", "[queue][heap]")
+{
+  indexed_heap<int> heap{};
+  auto const first = heap.push(1);
+  REQUIRE(heap.pop() == 1);
+
+  // The slot is reused, the old handle must not reach the new entry.
+  auto const second = heap.push(2);
+  REQUIRE(second.slot == first.slot);
+  REQUIRE_FALSE(heap.contains(first));
+  REQUIRE_FALSE(heap.erase(first).has_value());
+  REQUIRE_FALSE(heap.update(first, [](int& v) { v = 100; }));
+  REQUIRE(heap.get(second) != nullptr);
+  REQUIRE(*heap.get(second) == 2);
+}
+
+namespace
+{
+  struct timed_entry
+  {
+    std::chrono::steady_clock::time_point scheduled_time{};
+    int id{};
+  };
+
+  struct later_first
+  {
+    auto operator()(timed_entry const& lhs, timed_entry const& rhs) const noexcept -> bool
+    {
+      return lhs.scheduled_time > rhs.scheduled_time;
+    }
+  };
+} // namespace
+
+TEST_CASE("blocking_priority_queue cancels and reschedules queued entries", "[queue][heap]")
+{
+  blocking_priority_queue<timed_entry, later_first> queue{};
+  auto const now = std::chrono::steady_clock::now();
+
+  auto const cancelled = queue.enqueue({.scheduled_time = now, .id = 1});
+  auto const moved = queue.enqueue({.scheduled_time = now + 1h, .id = 2});
+  (void) queue.enqueue({.scheduled_time = now + 10ms, .id = 3});
+
+  REQUIRE(queue.erase(cancelled));
+  REQUIRE_FALSE(queue.erase(cancelled));
+  REQUIRE(queue.reschedule(moved, now));
+  REQUIRE(queue.scheduled_time(moved) == now);
+
+  auto first = queue.dequeue_wait(1s);
+  REQUIRE(first.has_value());
+  REQUIRE(first->id == 2);
+  REQUIRE_FALSE(queue.contains(moved));
+  REQUIRE_FALSE(queue.reschedule(moved, now + 1h));
+
+  auto second = queue.dequeue_wait(1s);
+  REQUIRE(second.has_value());
+  REQUIRE(second->id == 3);
+  REQUIRE(queue.size() == 0);
+}
+
+TEST_CASE("blocking_queue bulk calls move whole batches in order", "[queue][bulk]")
+{
+  blocking_queue<std::string> queue{8};
+  std::vector<std::string> input{};
+  for (int i = 0; i < 6; ++i)
+    input.push_back(std::to_string(i));
+
+  queue.enqueue_bulk(input);
+  REQUIRE(queue.size_approx() == 6);
+
+  std::vector<std::string> output{};
+  REQUIRE(queue.dequeue_bulk(std::back_inserter(output), 4, 1s) == 4);
+  REQUIRE(queue.dequeue_bulk(std::back_inserter(output), 4, 1s) == 2);
+  REQUIRE(output == std::vector<std::string>{"0", "1", "2", "3", "4", "5"});
+  REQUIRE(queue.dequeue_bulk(std::back_inserter(output), 4, 10ms) == 0);
+
+  // A batch larger than the ring waits for a consumer to make room.
+  std::vector<std::uint64_t> many(100);
+  for (std::uint64_t i = 0; i < many.size(); ++i)
+    many[i] = i;
+  blocking_queue<std::uint64_t> small{8};
+  std::thread producer{[&] { small.enqueue_bulk(many); }};
+  std::vector<std::uint64_t> drained{};
+  while (drained.size() < many.size())
+    (void) small.dequeue_bulk(std::back_inserter(drained), 16, 1s);
+  producer.join();
+  REQUIRE(drained == many);
+}
+
+TEST_CASE("blocking_queue bulk dequeue keeps the ring usable when the output throws", "[queue][bulk]")
+{
+  using sink = std::back_insert_iterator<std::vector<std::string>>;
+  STATIC_REQUIRE(noexcept(std::declval<blocking_queue<int>&>().try_dequeue_bulk(std::declval<int*>(), 1)));
+  STATIC_REQUIRE_FALSE(noexcept(std::declval<blocking_queue<std::string>&>().try_dequeue_bulk(std::declval<sink>(), 1)));
+
+  struct fail_after
+  {
+    using difference_type = std::ptrdiff_t;
+    std::vector<std::string>* taken;
+    std::size_t limit;
+    auto operator*() -> fail_after& { return *this; }
+    auto operator++() -> fail_after& { return *this; }
+    auto operator++(int) -> fail_after { return *this; }
+    auto operator=(std::string&& value) -> fail_after&
+    {
+      if (taken->size() == limit)
+        throw std::runtime_error{"sink full"};
+      taken->push_back(std::move(value));
+      return *this;
+    }
+  };
+
+  blocking_queue<std::string> queue{8};
+  std::vector<std::string> input{"a", "b", "c", "d"};
+  queue.enqueue_bulk(input);
+
+  std::vector<std::string> taken{};
+  REQUIRE_THROWS_AS(queue.try_dequeue_bulk(fail_after{&taken, 2}, 4), std::runtime_error);
+  REQUIRE(taken == std::vector<std::string>{"a", "b"});
+
+  // The element being written when the sink threw is gone; the rest is still there, in order.
+  std::vector<std::string> rest{};
+  REQUIRE(queue.try_dequeue_bulk(std::back_inserter(rest), 4) == 1);
+  REQUIRE(rest == std::vector<std::string>{"d"});
+  std::string more{"e"};
+  REQUIRE(queue.try_enqueue(std::move(more)));
+  REQUIRE(queue.try_dequeue() == "e");
+}
+
+TEST_CASE("blocking_priority_queue bulk enqueue heapifies once and drains only due entries", "[queue][bulk]")
+{
+  blocking_priority_queue<timed_entry, later_first> queue{};
+  auto const now = std::chrono::steady_clock::now();
+
+  std::vector<timed_entry> batch{};
+  for (int i = 0; i < 50; ++i)
+    batch.push_back({.scheduled_time = now - std::chrono::milliseconds{i}, .id = i});
+  batch.push_back({.scheduled_time = now + 1h, .id = 1000});
+
+  auto const handles = queue.enqueue_bulk(batch);
+  REQUIRE(handles.size() == 51);
+  REQUIRE(queue.size() == 51);
+
+  std::vector<timed_entry> due{};
+  REQUIRE(queue.dequeue_bulk(std::back_inserter(due), 100, 1s) == 50);
+  REQUIRE(std::ranges::is_sorted(due, std::less{}, &timed_entry::scheduled_time));
+  REQUIRE(due.front().id == 49);
+
+  // Only the future entry is left, so this times out instead of returning it early.
+  REQUIRE(queue.dequeue_bulk(std::back_inserter(due), 100, 20ms) == 0);
+  REQUIRE(queue.contains(handles.back()));
+}
@@ -0,0 +1,266 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "blocking_priority_queue.hpp"
+#include "concurrent_shyguy.hpp"
+#include "task_request.hpp"
+
+using namespace cosmos; // uses inline v1
+using namespace std::chrono_literals;
+
+namespace {
+
+// In-memory orchestrator (no storage) logging nowhere.
+struct orchestrator {
+  request_queue_t queue = std::make_shared<blocking_priority_queue<task_request_ptr, task_request_ptr_compare>>();
+  terminator_t running = std::make_shared<std::atomic_bool>(true);
+  std::shared_ptr<concurrent_shyguy> shyguy;
+
+  orchestrator()
+  {
+    if (not spdlog::get("shyguy_logger"))
+      spdlog::null_logger_mt("shyguy_logger");
+    shyguy = std::make_shared<concurrent_shyguy>(queue, running, nullptr);
+  }
+};
+
+auto request(command_enum command, shyguy_dag dag) -> shyguy_request
+{
+  shyguy_request r{};
+  r.command = command;
+  r.emplace(std::move(dag));
+  return r;
+}
+
+auto request(command_enum command, shyguy_task task) -> shyguy_request
+{
+  shyguy_request r{};
+  r.command = command;
+  r.emplace(std::move(task));
+  return r;
+}
+
+} // namespace
+
+TEST_CASE("concurrent_shyguy creates different DAGs in parallel", "[concurrent_shyguy]")
+{
+  orchestrator o{};
+  constexpr int threads = 4;
+  constexpr int dags_per_thread = 50;
+
+  std::atomic_bool stop{false};
+  std::atomic_int schedule_reads{0};
+  std::thread reader{[&] {
+    while (not stop.load()) {
+      (void) o.shyguy->next_scheduled_dag();
+      schedule_reads.fetch_add(1);
+    }
+  }};
+
+  // Catch2 assertions are not thread safe, workers only count what failed.
+  std::atomic_int failed{0};
+  std::vector<std::thread> writers{};
+  for (int t = 0; t < threads; ++t) {
+    writers.emplace_back([&, t] {
+      for (int d = 0; d < dags_per_thread; ++d) {
+        auto const name = "dag-" + std::to_string(t) + "-" + std::to_string(d);
+        bool ok = o.shyguy->process(request(command_enum::create, shyguy_dag{.name = name, .schedule = "0 * * * *"})).has_value();
+        ok = ok and o.shyguy->process(request(command_enum::create, shyguy_task{.name = "a", .associated_dag = name}));
+        ok = ok and o.shyguy->process(request(command_enum::create,
+                                              shyguy_task{.name = "b", .associated_dag = name, .dependency_names = {{"a"}}}));
+        if (not ok)
+          failed.fetch_add(1);
+      }
+    });
+  }
+  for (auto& w : writers)
+    w.join();
+  stop.store(true);
+  reader.join();
+
+  REQUIRE(failed.load() == 0);
+  REQUIRE(schedule_reads.load() > 0);
+  auto const next = o.shyguy->next_scheduled_dag();
+  REQUIRE(next.has_value());
+
+  auto const duplicate = o.shyguy->process(request(command_enum::create, shyguy_dag{.name = "dag-0-0", .schedule = "0 * * * *"}));
+  REQUIRE_FALSE(duplicate);
+  REQUIRE(duplicate.error() == command_error::dag_duplicate);
+}
+
+TEST_CASE("concurrent_shyguy lets one of several racing creates of a DAG win", "[concurrent_shyguy]")
+{
+  orchestrator o{};
+  std::atomic_int created{0};
+  std::vector<std::thread> racers{};
+  for (int t = 0; t < 4; ++t)
+    racers.emplace_back([&] {
+      if (o.shyguy->process(request(command_enum::create, shyguy_dag{.name = "contended"})))
+        created.fetch_add(1);
+    });
+  for (auto& r : racers)
+    r.join();
+  REQUIRE(created.load() == 1);
+}
+
+TEST_CASE("concurrent_shyguy removing a DAG cancels its queued runs and rejects late requests", "[concurrent_shyguy]")
+{
+  orchestrator o{};
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_dag{.name = "short-lived"})));
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_task{.name = "a", .associated_dag = "short-lived"})));
+
+  (void) o.shyguy->execute_at(shyguy_dag{.name = "short-lived"}, std::chrono::steady_clock::now() + std::chrono::hours{1});
+  REQUIRE(o.queue->size() == 1);
+
+  REQUIRE(o.shyguy->process(request(command_enum::remove, shyguy_dag{.name = "short-lived"})));
+  REQUIRE(o.queue->size() == 0);
+
+  auto const late = o.shyguy->process(request(command_enum::create, shyguy_task{.name = "b", .associated_dag = "short-lived"}));
+  REQUIRE_FALSE(late);
+  REQUIRE(late.error() == command_error::dag_not_found);
+  REQUIRE_FALSE(o.shyguy->next_scheduled_dag().has_value());
+}
+
+TEST_CASE("concurrent_shyguy snapshots come from versioned views readers never lock", "[concurrent_shyguy][snapshot]")
+{
+  orchestrator o{};
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_dag{.name = "etl", .schedule = "0 * * * *"})));
+
+  // A monitor polling while tasks are added sees versions only grow and every view whole.
+  std::atomic_bool stop{false};
+  std::atomic_int bad_views{0};
+  std::thread monitor{[&] {
+    std::uint64_t last{0};
+    while (not stop.load()) {
+      auto const view = o.shyguy->view_of("etl");
+      if (not view or view->version < last or view->shape->tasks.size() > 50)
+        bad_views.fetch_add(1);
+      last = view ? view->version : last;
+      (void) o.shyguy->process(request(command_enum::snapshot, shyguy_dag{.name = "etl"}));
+    }
+  }};
+  for (int i = 0; i < 50; ++i) {
+    auto task = shyguy_task{.name = "t" + std::to_string(i), .associated_dag = "etl"};
+    if (i > 0)
+      task.dependency_names = std::vector<std::string>{"t" + std::to_string(i - 1)};
+    REQUIRE(o.shyguy->process(request(command_enum::create, std::move(task))));
+  }
+  stop.store(true);
+  monitor.join();
+  REQUIRE(bad_views.load() == 0);
+
+  auto const before = o.shyguy->view_of("etl");
+  (void) o.shyguy->execute_at(shyguy_dag{.name = "etl"}, std::chrono::steady_clock::now());
+  auto const after = o.shyguy->view_of("etl");
+  REQUIRE(after->version > before->version);
+  REQUIRE(before->runs.empty()); // views already handed out never change
+  REQUIRE(after->runs.size() == 1);
+  REQUIRE(after->shape == before->shape);
+
+  auto const queued = nlohmann::json::parse(o.shyguy->snapshot(shyguy_dag{.name = "etl"}).value());
+  REQUIRE(queued["dag"]["schedule"] == "0 * * * *");
+  REQUIRE(queued["dag"]["tasks"].size() == 50);
+  REQUIRE(queued["runs"][0]["status"] == "queued");
+  REQUIRE(queued["runs"][0]["queued"] == after->runs[0]->order().size());
+
+  // Without storage every task fails to launch; the states still move.
+  auto run = o.queue->dequeue();
+  run->payload.first.front().task_function();
+  auto const progressed = nlohmann::json::parse(o.shyguy->snapshot(shyguy_dag{.name = "etl"}).value());
+  REQUIRE(progressed["runs"][0]["status"] == "running");
+  REQUIRE(progressed["runs"][0]["failed"] == 1);
+  REQUIRE(progressed["runs"][0]["failed_tasks"][0] == after->runs[0]->order().front());
+
+  auto const task = nlohmann::json::parse(o.shyguy->snapshot(shyguy_task{.name = "t1", .associated_dag = "etl"}).value());
+  REQUIRE(task["dependencies"][0] == "t0");
+  REQUIRE(task["runs"][0]["state"] == "queued");
+  REQUIRE(o.shyguy->snapshot(shyguy_task{.name = "nope", .associated_dag = "etl"}).error() == command_error::task_not_found);
+  REQUIRE(o.shyguy->snapshot(shyguy_dag{.name = "nope"}).error() == command_error::dag_not_found);
+}
+
+TEST_CASE("concurrent_shyguy merges duplicate executes into the queued run", "[concurrent_shyguy][execute]")
+{
+  orchestrator o{};
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_dag{.name = "etl"})));
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_task{.name = "extract", .associated_dag = "etl"})));
+  auto const receipt = [](command_result_type const &result) { return nlohmann::json::parse(result.value()); };
+
+  // A double click: the second execute rides on the run the first one queued.
+  auto const first = receipt(o.shyguy->execute(shyguy_dag{.name = "etl"}));
+  auto const second = receipt(o.shyguy->execute(shyguy_dag{.name = "etl"}, "click-1"));
+  REQUIRE(second["run_id"] == first["run_id"]);
+  REQUIRE(second["merged"] == 1);
+  REQUIRE(o.queue->size() == 1);
+  REQUIRE(o.shyguy->view_of("etl")->runs.front()->merged.load() == 1);
+
+  // Once the run started a plain execute queues a new one, a retried key still gets the old one.
+  (void) o.queue->dequeue();
+  auto const retried = receipt(o.shyguy->execute(shyguy_dag{.name = "etl"}, "click-1"));
+  REQUIRE(retried["run_id"] == first["run_id"]);
+  REQUIRE(retried["merged"] == 2);
+  REQUIRE(o.queue->size() == 0);
+
+  auto const fresh = receipt(o.shyguy->execute(shyguy_dag{.name = "etl"}));
+  REQUIRE(fresh["run_id"] != first["run_id"]);
+  REQUIRE(fresh["merged"] == 0);
+
+  // An edit makes the queued run stale for later requests: they get a run of the new version.
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_task{.name = "load", .associated_dag = "etl"})));
+  auto const edited = receipt(o.shyguy->execute(shyguy_dag{.name = "etl"}));
+  REQUIRE(edited["run_id"] != fresh["run_id"]);
+  REQUIRE(o.queue->size() == 2);
+
+  // The key travels with the request's JSON.
+  auto const parsed = nlohmann::json::parse(
+      R"({"type":"dag","command":"execute","value":{"name":"etl","schedule":null},"idempotency_key":"click-1"})")
+                          .get<shyguy_request>();
+  REQUIRE(parsed.idempotency_key == "click-1");
+  REQUIRE(receipt(o.shyguy->process(parsed))["run_id"] == first["run_id"]);
+}
+
+TEST_CASE("concurrent_shyguy backfills missed cron fires a few runs at a time", "[concurrent_shyguy][backfill]")
+{
+  orchestrator o{};
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_dag{.name = "etl", .schedule = "0 * * * *"})));
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_task{.name = "extract", .associated_dag = "etl"})));
+
+  // 00:30 to 05:30 misses the fires at 01:00 through 05:00.
+  auto const midnight = std::chrono::sys_days{std::chrono::year{2024} / 1 / 1};
+  auto const report = o.shyguy->backfill(shyguy_dag{.name = "etl"}, midnight + 30min, midnight + 5h + 30min, 2);
+  REQUIRE(report.has_value());
+  REQUIRE(report->fires == 5);
+  REQUIRE(report->queued == 2);
+  REQUIRE_FALSE(report->truncated);
+  REQUIRE(o.queue->size() == 2);
+
+  auto const logical_times = [&]
+  {
+    std::vector<std::chrono::system_clock::time_point> out;
+    for (auto const &run : o.shyguy->view_of("etl")->runs)
+      if (not run->done())
+        out.push_back(run->logical_time);
+    return out;
+  };
+  REQUIRE(logical_times() == std::vector<std::chrono::system_clock::time_point>{midnight + 1h, midnight + 2h});
+
+  // Without storage every task fails to launch, which still finishes the run and frees its slot.
+  auto run = o.queue->dequeue();
+  for (auto &task : run->payload.first)
+    task.task_function();
+  REQUIRE(o.queue->size() == 2);
+  REQUIRE(logical_times() == std::vector<std::chrono::system_clock::time_point>{midnight + 2h, midnight + 3h});
+
+  REQUIRE(o.shyguy->backfill(shyguy_dag{.name = "nope"}, midnight, midnight + 1h, 1).error() == command_error::dag_not_found);
+  REQUIRE(o.shyguy->process(request(command_enum::create, shyguy_dag{.name = "adhoc"})));
+  REQUIRE(o.shyguy->backfill(shyguy_dag{.name = "adhoc"}, midnight, midnight + 1h, 1).error() == command_error::dag_not_scheduled);
+}
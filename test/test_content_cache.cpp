@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "content_cache.hpp"
+#include "fs_storage.hpp"
+#include "temp_dir_guard.hpp"
+
+namespace fs = std::filesystem;
+using namespace cosmos; // uses inline v1
+
+namespace {
+
+auto put(fs_storage const& storage, std::string const& text) -> std::string
+{
+  std::vector<std::byte> bytes(text.size());
+  std::memcpy(bytes.data(), text.data(), text.size());
+  return storage.blobs().put_blob(bytes).value();
+}
+
+} // namespace
+
+TEST_CASE("content_cache reads a blob once and evicts the least recently used", "[content_cache]")
+{
+  temp_dir_guard tmp{"content_cache_lru_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  auto const a = put(*storage, std::string(40, 'a'));
+  auto const b = put(*storage, std::string(40, 'b'));
+  auto const c = put(*storage, std::string(40, 'c'));
+
+  content_cache cache{storage, 100};
+  REQUIRE(cache.get(a).value()->size() == 40);
+  REQUIRE(cache.get(a).has_value());
+  REQUIRE(cache.hits() == 1);
+  REQUIRE(cache.misses() == 1);
+
+  // a was used last, so making room for c drops b.
+  REQUIRE(cache.get(b).has_value());
+  REQUIRE(cache.get(a).has_value());
+  REQUIRE(cache.get(c).has_value());
+  REQUIRE(cache.contains(a));
+  REQUIRE_FALSE(cache.contains(b));
+  REQUIRE(cache.contains(c));
+  REQUIRE(cache.bytes() == 80);
+
+  // Content already handed out outlives its eviction.
+  auto const held = cache.get(a).value();
+  REQUIRE(cache.get(b).has_value());
+  REQUIRE(held->size() == 40);
+
+  REQUIRE(cache.get("missing").error() == storage_error::not_found);
+  content_cache without_store{nullptr};
+  REQUIRE(without_store.get(a).error() == storage_error::not_found);
+}
+
+TEST_CASE("content_cache keeps a pinned blob storage does not have yet", "[content_cache]")
+{
+  temp_dir_guard tmp{"content_cache_pinned_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  auto const a = put(*storage, std::string(40, 'a'));
+  auto const b = put(*storage, std::string(40, 'b'));
+  auto const c = put(*storage, std::string(40, 'c'));
+
+  // Submitted, its write still queued: a burst of other reads must not evict it.
+  std::string const text(40, 'u');
+  auto const unflushed = fs_blob_store::id_of(std::as_bytes(std::span{text}));
+  content_cache cache{storage, 100};
+  cache.pin(unflushed, std::vector<std::byte>(40, std::byte{'u'}));
+  for (auto const& id : {a, b, c, a, b, c})
+    REQUIRE(cache.get(id).has_value());
+  REQUIRE(cache.bytes() == 80);
+  REQUIRE(cache.contains(unflushed));
+  REQUIRE(cache.get(unflushed).value()->size() == 40);
+
+  // Once stored it is an ordinary entry again, evicted like any other.
+  REQUIRE(put(*storage, text) == unflushed);
+  cache.unpin(unflushed);
+  REQUIRE(cache.get(a).has_value());
+  REQUIRE(cache.get(b).has_value());
+  REQUIRE_FALSE(cache.contains(unflushed));
+  REQUIRE(cache.get(unflushed).value()->size() == 40);
+}
+
+TEST_CASE("content_cache prefetches in the background", "[content_cache]")
+{
+  temp_dir_guard tmp{"content_cache_prefetch_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  std::vector<std::string> const ids{put(*storage, "echo one"), put(*storage, "echo two")};
+
+  content_cache cache{storage};
+  cache.prefetch(ids);
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+  while (cache.size() < ids.size() and std::chrono::steady_clock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.get(ids[1]).has_value());
+  REQUIRE(cache.misses() == 0);
+}
@@ -0,0 +1,141 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <random>
+#include <string>
+
+#include "cron_expression.hpp"
+#include "cron_iterator.hpp"
+#include "day_of_month_field.hpp"
+#include "day_of_week_field.hpp"
+#include "hour_field.hpp"
+#include "minute_field.hpp"
+#include "month_field.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// 2024-01-30 22:17, close to a month end and a leap day.
+auto const start = std::chrono::sys_days{std::chrono::year{2024} / 1 / 30} + 22h + 17min;
+
+// The field by field walk calc_next used before it was compiled to bitmasks, kept as the reference.
+auto legacy_calc_next(geheb::cron_expression const &cron, std::chrono::system_clock::time_point const time_point)
+    -> std::chrono::system_clock::time_point
+{
+  geheb::date_time next_time{time_point};
+  geheb::month_field const month{};
+  geheb::day_of_month_field const day{};
+  geheb::day_of_week_field const dow{};
+  geheb::hour_field const hour{};
+  geheb::minute_field const minute{};
+  geheb::cron_field const *fields[5] = {&month, &day, &dow, &hour, &minute};
+  for (int i = 0; i < 1000; ++i) {
+    bool start_over = false;
+    for (auto const *field : fields) {
+      auto const &value = cron.value(field->pos());
+      if (value == "*")
+        continue;
+      bool matched = false;
+      if (field->has_list(value)) {
+        for (auto const &item : field->split_list(value))
+          matched = matched or field->match(item, next_time);
+      } else {
+        matched = field->match(value, next_time);
+      }
+      if (not matched) {
+        next_time = field->increment(value, next_time);
+        start_over = true;
+        break;
+      }
+    }
+    if (start_over)
+      continue;
+    if (static_cast<std::chrono::system_clock::time_point>(next_time) == time_point) {
+      next_time = minute.increment(cron.value(geheb::cron_field_pos::minute), next_time);
+      continue;
+    }
+    return next_time;
+  }
+  return {};
+}
+
+} // namespace
+
+TEST_CASE("calc_next matches the field by field walk it replaced", "[cron_parser]")
+{
+  // Lists are written in ascending order: out of order ones made the old walk skip fires. Day of
+  // month lists and steps reaching past a short month's end are left out too, the old walk overshot
+  // those (see the case below).
+  for (std::string const expression :
+       {"* * * * *", "*/7 * * * *", "5,35 */3 * * *", "0 9-17 * * 1-5", "30 2 1,15 * *", "0 0 * 2,3 *",
+        "15 10 * * 0", "0 12 29 * *", "0 0 31 * *", "50-10 * * * *", "0 22-3 * * *", "0 0 * NOV-FEB *",
+        "0 12 * * FRI-MON", "5/15 1/5 * * *", "0 0 1-31/2 * *", "0 0 13 * 5", "0 0 29 2 *", "59 23 31 12 *",
+        "0 0 ? JAN,JUL MON", "*/20 */6 1,10,20 * 1-5", "0 4 8-14 * 1", "10 8 L * *", "0 9 15W * *",
+        "0 9 1W * *", "0 9 31W * *", "0 18 * * 5L", "0 8 ? * 1#1", "0 8 ? * 5#5", "0 8 ? * 2#3,5L"})
+  {
+    INFO(expression);
+    geheb::cron_expression const cron{expression};
+    std::mt19937_64 random{42};
+    auto const from = std::chrono::sys_days{std::chrono::year{2023} / 1 / 1};
+    for (int i = 0; i < 300; ++i)
+    {
+      // On whole minutes, on whole seconds and in between.
+      auto time = std::chrono::system_clock::time_point{from} + std::chrono::minutes{random() % (5 * 366 * 24 * 60)};
+      if (i % 3 > 0)
+        time += std::chrono::seconds{random() % 60};
+      if (i % 3 > 1)
+        time += std::chrono::milliseconds{1 + random() % 999};
+      INFO(time.time_since_epoch().count());
+      REQUIRE(cron.calc_next(time) == legacy_calc_next(cron, time));
+    }
+  }
+}
+
+TEST_CASE("calc_next does not overshoot a stepped day of month past a short month's end", "[cron_parser]")
+{
+  using std::chrono::sys_days;
+  using std::chrono::year;
+
+  // The old walk answered Mar 11 for the first three: it stepped to the next listed day, Feb 31, that is Mar 3.
+  CHECK(geheb::cron_expression{"10-20 * */10 FEB-APR ?"}.calc_next(sys_days{year{2022} / 2 / 28}) ==
+        sys_days{year{2022} / 3 / 1} + 10min);
+  CHECK(geheb::cron_expression{"0 0 */10 * *"}.calc_next(sys_days{year{2023} / 2 / 28} + 1h + 30s) ==
+        sys_days{year{2023} / 3 / 1});
+  CHECK(geheb::cron_expression{"0 0 1,11,21,31 * *"}.calc_next(sys_days{year{2023} / 2 / 28} + 1h) ==
+        sys_days{year{2023} / 3 / 1});
+  CHECK(geheb::cron_expression{"0 12 */7 * *"}.calc_next(sys_days{year{2024} / 2 / 29} + 13h) ==
+        sys_days{year{2024} / 3 / 1} + 12h);
+  CHECK(geheb::cron_expression{"0 0 */10 * *"}.calc_next(sys_days{year{2023} / 4 / 30} + 1h) ==
+        sys_days{year{2023} / 5 / 1});
+}
+
+TEST_CASE("cron_iterator yields the same fire times as chained calc_next", "[cron_parser]")
+{
+  for (std::string const expression : {"* * * * *", "*/7 * * * *", "5,35 */3 * * *", "0 9-17 * * 1-5",
+                                       "30 2 1,15 * *", "0 0 * 2,3 *", "15 10 * * 0", "0 12 29 * *"})
+  {
+    INFO(expression);
+    geheb::cron_expression const cron{expression};
+    geheb::cron_iterator fires{cron, start};
+
+    auto previous = std::chrono::system_clock::time_point{start};
+    for (int i = 0; i < 200; ++i)
+    {
+      auto const expected = cron.calc_next(previous);
+      auto const actual = fires.next();
+      REQUIRE(actual == expected);
+      previous = expected;
+    }
+  }
+}
+
+TEST_CASE("cron_iterator starts strictly after the given time", "[cron_parser]")
+{
+  geheb::cron_expression const cron{"0 * * * *"};
+  auto const on_fire = std::chrono::sys_days{std::chrono::year{2024} / 3 / 1} + 10h;
+
+  geheb::cron_iterator fires{cron, on_fire};
+  CHECK(fires.next() == on_fire + 1h);
+  CHECK(fires.next() == on_fire + 2h);
+}
@@ -1,34 +1,20 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <string>
 #include <vector>
 
 #include "fs_storage.hpp"
+#include "temp_dir_guard.hpp"
 
 namespace fs = std::filesystem;
 using namespace cosmos; // uses inline v1
 
 namespace {
 
-// Create a unique temporary directory for each test run under the system temp
-struct temp_dir_guard {
-  fs::path path;
-  explicit temp_dir_guard(std::string prefix)
-  {
-    auto base = fs::temp_directory_path();
-    // Append a pseudo-unique suffix using the address of this
-    path = base / (prefix + std::to_string(reinterpret_cast<std::uintptr_t>(this)));
-    std::error_code ec;
-    fs::create_directories(path, ec);
-  }
-  ~temp_dir_guard()
-  {
-    std::error_code ec;
-    fs::remove_all(path, ec);
-  }
-};
-
 inline std::vector<std::byte> to_bytes(std::string const& s)
 {
   std::vector<std::byte> out(s.size());
@@ -76,6 +62,17 @@ TEST_CASE("fs_blob_store put/get/has works", "[fs_storage][blob]")
   auto bad = blobs.get_blob("ffffffffffffffff");
   REQUIRE_FALSE(bad.has_value());
   REQUIRE(bad.error() == storage_error::not_found);
+
+  // A blob file cut short (a crash mid-write) is not taken as stored: the next put replaces it.
+  {
+    std::ofstream os(blobs.blob_path(id), std::ios::binary | std::ios::trunc);
+    os << "hello";
+  }
+  REQUIRE(blobs.put_blob(hello_bytes) == id);
+  REQUIRE(blobs.get_blob(id)->size() == hello_bytes.size());
+  // Nothing but the blobs themselves is left behind.
+  for (auto const& entry : fs::directory_iterator(blobs.blob_path(id).parent_path()))
+    REQUIRE(entry.path().extension() == ".bin");
 }
 
 TEST_CASE("fs_dag_store CRUD + versions", "[fs_storage][dag]")
@@ -234,6 +231,117 @@ TEST_CASE("fs_task_store stores schedule metadata", "[fs_storage][task][metadata
   REQUIRE(reloaded->metadata->schedule.frequency == metadata.schedule.frequency);
 }
 
+TEST_CASE("fs_task_store records runs into the cost metadata", "[fs_storage][task][metadata]")
+{
+  temp_dir_guard tmp{"fs_storage_task_cost_"};
+  fs_task_store tasks{tmp.path};
+
+  shyguy_task t1{};
+  t1.name = "task_cost";
+  t1.associated_dag = "dagCost";
+
+  task_metadata metadata{};
+  metadata.schedule.cron_expression = "0 * * * *";
+  auto created = tasks.upsert_task(t1, std::nullopt, std::nullopt, metadata);
+  REQUIRE(created.has_value());
+
+  REQUIRE_FALSE(tasks.record_run("dagCost", "missing", {}, true).has_value());
+
+  auto first = tasks.record_run("dagCost", "task_cost", task_usage{.wall_us = 1000, .user_cpu_us = 400, .max_rss_bytes = 2048}, true);
+  REQUIRE(first.has_value());
+  REQUIRE(first->cost.has_value());
+  REQUIRE(first->cost->runs == 1);
+  REQUIRE(first->cost->mean_wall_us == 1000.0);
+  REQUIRE(first->statuses.current == dag_run_status::success);
+
+  auto second = tasks.record_run("dagCost", "task_cost", task_usage{.wall_us = 2000, .user_cpu_us = 400}, false);
+  REQUIRE(second.has_value());
+  REQUIRE(second->cost->runs == 2);
+  REQUIRE(second->cost->mean_wall_us == 1000.0 + task_cost_smoothing * 1000.0);
+  REQUIRE(second->statuses.previous == dag_run_status::success);
+  REQUIRE(second->statuses.current == dag_run_status::failed);
+
+  // runs do not bump the version, and re-creating the task keeps its cost
+  auto loaded = tasks.get_task("dagCost", "task_cost");
+  REQUIRE(loaded.has_value());
+  REQUIRE(loaded->version == created.value());
+  REQUIRE(loaded->metadata->cost->last.wall_us == 2000);
+  REQUIRE(loaded->metadata->schedule.cron_expression == "0 * * * *");
+
+  REQUIRE(tasks.upsert_task(t1, std::nullopt, std::nullopt, metadata).has_value());
+  auto recreated = tasks.get_task("dagCost", "task_cost");
+  REQUIRE(recreated->metadata->cost.has_value());
+  REQUIRE(recreated->metadata->cost->runs == 2);
+}
+
+TEST_CASE("fs_run_log keeps the latest runs per DAG across reopen", "[fs_storage][runs]")
+{
+  temp_dir_guard tmp{"fs_storage_runs_"};
+  using namespace std::chrono_literals;
+  auto const day = std::chrono::system_clock::time_point{std::chrono::hours{24 * 20000}};
+
+  auto const record = [](std::uint64_t run, std::string dag, std::string task, dag_run_status status,
+                         std::chrono::system_clock::time_point at) {
+    return run_record{.run_id = run, .dag = std::move(dag), .task = std::move(task), .status = status,
+                      .started = at, .finished = at + 2s, .exit_code = status == dag_run_status::failed ? 3 : 0,
+                      .logical_time = at - 1min};
+  };
+
+  {
+    fs_run_log log{tmp.path, std::chrono::hours{24}, 4};
+    for (std::uint64_t run = 1; run <= 6; ++run) {
+      // Each run lands in the segment of its own day.
+      auto const at = day + std::chrono::hours{24} * run;
+      REQUIRE(log.append(record(run, "etl", "extract", dag_run_status::success, at)).has_value());
+      REQUIRE(log.append(record(run, "etl", "load", run == 6 ? dag_run_status::failed : dag_run_status::success, at + 1s))
+                  .has_value());
+    }
+    REQUIRE(log.append(record(7, "other", "only", dag_run_status::success, day)).has_value());
+    REQUIRE_FALSE(log.append(record(8, "bad\nname", "t", dag_run_status::success, day)).has_value());
+
+    auto const runs = log.last_runs("etl", 10);
+    REQUIRE(runs.size() == 4); // bounded by runs_per_dag
+    REQUIRE(runs.front().run_id == 3);
+    REQUIRE(runs.back().run_id == 6);
+    REQUIRE(runs.back().status == dag_run_status::failed);
+    REQUIRE(runs.back().tasks.size() == 2);
+    REQUIRE(runs.back().tasks[1].task == "load");
+    REQUIRE(runs.back().tasks[1].exit_code == 3);
+    REQUIRE(runs.back().finished - runs.back().started == 3s);
+    REQUIRE(runs.back().logical_time == day + std::chrono::hours{24 * 6} - 1min);
+    REQUIRE(log.last_runs("etl", 1).front().run_id == 6);
+    REQUIRE(log.last_runs("nope", 5).empty());
+    REQUIRE(log.highest_run_id() == 7);
+  }
+
+  // A torn record at the end of a segment is dropped, everything before it is indexed again.
+  auto const segment = tmp.path / "history" / "runs" / (std::to_string((day + std::chrono::hours{24 * 6}).time_since_epoch() / 1s) + ".runs");
+  REQUIRE(fs::exists(segment));
+  {
+    std::ofstream torn(segment, std::ios::binary | std::ios::app);
+    torn << "partial";
+  }
+
+  fs_run_log reopened{tmp.path, std::chrono::hours{24}, 4};
+  auto const runs = reopened.last_runs("etl", 10);
+  REQUIRE(runs.size() == 4);
+  REQUIRE(runs.back().run_id == 6);
+  REQUIRE(runs.back().tasks.size() == 2);
+  REQUIRE(fs::file_size(segment) % 48 == 0);
+  REQUIRE(reopened.highest_run_id() == 7);
+  REQUIRE_FALSE(fs_run_log{tmp.path / "fresh"}.highest_run_id().has_value());
+  REQUIRE(reopened.append(record(9, "etl", "extract", dag_run_status::success, day + std::chrono::hours{24 * 6})).has_value());
+  REQUIRE(reopened.last_runs("etl", 1).front().run_id == 9);
+
+  // Retention works in whole segments: runs 1..4 (and "other") are gone, 5 onwards stay.
+  auto const dropped = reopened.drop_before(day + std::chrono::hours{24 * 5});
+  REQUIRE(dropped.has_value());
+  REQUIRE(dropped.value() == 5);
+  REQUIRE(reopened.last_runs("other", 5).empty());
+  REQUIRE(reopened.last_runs("etl", 10).front().run_id == 5);
+  REQUIRE(reopened.highest_run_id() == 9);
+}
+
 TEST_CASE("fs_storage aggregates stores with shared root", "[fs_storage][api]")
 {
   temp_dir_guard tmp{"fs_storage_root_"};
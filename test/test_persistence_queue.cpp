@@ -0,0 +1,252 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/spdlog.h>
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "blocking_priority_queue.hpp"
+#include "concurrent_shyguy.hpp"
+#include "persistence_queue.hpp"
+#include "task_request.hpp"
+#include "temp_dir_guard.hpp"
+
+namespace fs = std::filesystem;
+using namespace cosmos; // uses inline v1
+
+TEST_CASE("persistence_queue coalesces writes to a key and keeps the last", "[persistence_queue]")
+{
+  temp_dir_guard tmp{"persistence_queue_coalesce_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  std::vector<std::string> stored_blobs{};
+  persistence_queue queue{storage, [&](std::string const &blob_id) { stored_blobs.push_back(blob_id); }};
+
+  constexpr std::size_t edits = 200;
+  for (std::size_t i = 0; i < edits; ++i)
+    queue.upsert_dag(shyguy_dag{.name = "dag", .schedule = std::to_string(i) + " * * * *"});
+  queue.upsert_dag(shyguy_dag{.name = "gone", .schedule = std::nullopt});
+  queue.erase_dag("gone");
+
+  REQUIRE(queue.flush().get());
+  REQUIRE(queue.written() + queue.coalesced() == edits + 2);
+  REQUIRE(queue.pending() == 0);
+
+  auto const stored = storage->dags().get_dag("dag");
+  REQUIRE(stored.has_value());
+  REQUIRE(stored->value.schedule == std::to_string(edits - 1) + " * * * *");
+  REQUIRE_FALSE(storage->dags().get_dag("gone").has_value());
+
+  // Writes after a flush are never pulled in front of it.
+  queue.upsert_dag(shyguy_dag{.name = "later", .schedule = std::nullopt});
+  auto first = queue.flush();
+  queue.erase_dag("later");
+  auto second = queue.flush();
+  REQUIRE(first.get());
+  REQUIRE(second.get());
+  REQUIRE_FALSE(storage->dags().get_dag("later").has_value());
+
+  // A blob is reported once it is stored (what unpins it in the content cache).
+  std::vector<std::byte> const script(8, std::byte{'x'});
+  auto const blob_id = fs_blob_store::id_of(script);
+  queue.put_blob(blob_id, script);
+  REQUIRE(queue.flush().get());
+  REQUIRE(stored_blobs == std::vector<std::string>{blob_id});
+  REQUIRE(storage->blobs().has_blob(blob_id).value());
+}
+
+TEST_CASE("concurrent_shyguy mutations reach storage behind the request", "[persistence_queue][concurrent_shyguy]")
+{
+  if (not spdlog::get("shyguy_logger"))
+    spdlog::null_logger_mt("shyguy_logger");
+
+  temp_dir_guard tmp{"persistence_queue_shyguy_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  auto queue = std::make_shared<blocking_priority_queue<task_request_ptr, task_request_ptr_compare>>();
+  concurrent_shyguy shyguy{queue, std::make_shared<std::atomic_bool>(true), storage};
+
+  REQUIRE(shyguy.create(shyguy_dag{.name = "etl", .schedule = "0 * * * *"}).has_value());
+  REQUIRE(shyguy.create(shyguy_task{.name = "extract",
+                                    .associated_dag = "etl",
+                                    .type = "shell",
+                                    .filename = "extract.sh",
+                                    .file_content = "echo extract"})
+              .has_value());
+  REQUIRE(shyguy.flush().get());
+
+  REQUIRE(storage->dags().get_dag("etl")->value.schedule == "0 * * * *");
+  auto const task = storage->tasks().get_task("etl", "extract");
+  REQUIRE(task.has_value());
+  REQUIRE(task->blob_id.has_value());
+  REQUIRE(storage->blobs().has_blob(*task->blob_id).value());
+
+  REQUIRE(shyguy.remove(shyguy_dag{.name = "etl", .schedule = std::nullopt}).has_value());
+  REQUIRE(shyguy.flush().get());
+  REQUIRE_FALSE(storage->dags().get_dag("etl").has_value());
+}
+
+TEST_CASE("concurrent_shyguy warm start rebuilds what storage holds", "[persistence_queue][concurrent_shyguy][warm_start]")
+{
+  if (not spdlog::get("shyguy_logger"))
+    spdlog::null_logger_mt("shyguy_logger");
+
+  temp_dir_guard tmp{"persistence_queue_warm_start_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  auto queue = std::make_shared<blocking_priority_queue<task_request_ptr, task_request_ptr_compare>>();
+  {
+    concurrent_shyguy before{queue, std::make_shared<std::atomic_bool>(true), storage};
+    REQUIRE(before.create(shyguy_dag{.name = "etl", .schedule = "0 * * * *"}).has_value());
+    REQUIRE(before.create(shyguy_task{.name = "extract", .associated_dag = "etl", .type = "shell",
+                                      .filename = "extract.sh", .file_content = "echo extract"})
+                .has_value());
+    REQUIRE(before.create(shyguy_task{.name = "load", .associated_dag = "etl", .type = "shell",
+                                      .dependency_names = std::vector<std::string>{"extract"}})
+                .has_value());
+    REQUIRE(before.create(shyguy_dag{.name = "adhoc", .schedule = std::nullopt}).has_value());
+    REQUIRE(before.flush().get());
+  }
+
+  // Written behind the orchestrator's back: a cycle, and a dependency on a task that is gone.
+  auto const store_task = [&](std::string dag, std::string name, std::vector<std::string> depends) {
+    REQUIRE(storage->tasks()
+                .upsert_task(shyguy_task{.name = std::move(name), .associated_dag = std::move(dag),
+                                         .dependency_names = std::move(depends)},
+                             std::nullopt, std::nullopt, std::nullopt)
+                .has_value());
+  };
+  REQUIRE(storage->dags().upsert_dag(shyguy_dag{.name = "loop", .schedule = std::nullopt}, std::nullopt).has_value());
+  store_task("loop", "a", {"b"});
+  store_task("loop", "b", {"a"});
+  store_task("adhoc", "report", {"removed"});
+
+  concurrent_shyguy after{queue, std::make_shared<std::atomic_bool>(true), storage};
+  auto const report = after.warm_start(2);
+  REQUIRE(report.has_value());
+  REQUIRE(report->dags == 2);
+  REQUIRE(report->tasks == 3);
+  REQUIRE(report->scheduled == 1);
+  REQUIRE(report->dropped_dependencies == 1);
+  REQUIRE(report->rejected == std::vector<std::string>{"loop"});
+
+  auto const etl = after.view_of("etl");
+  REQUIRE(etl != nullptr);
+  REQUIRE(etl->shape->schedule == "0 * * * *");
+  REQUIRE(etl->shape->tasks.size() == 2);
+  REQUIRE(after.view_of("loop") == nullptr);
+  REQUIRE(after.next_scheduled_dag().has_value());
+
+  // The loaded DAGs behave like ones created here: their graph still knows every task.
+  REQUIRE_FALSE(after.create(shyguy_task{.name = "extract", .associated_dag = "etl"}).has_value());
+  REQUIRE(after.create(shyguy_task{.name = "publish", .associated_dag = "adhoc",
+                                   .dependency_names = std::vector<std::string>{"report"}})
+              .has_value());
+
+  // A second warm start keeps what is already in memory.
+  REQUIRE(after.warm_start(2)->dags == 0);
+}
+
+TEST_CASE("concurrent_shyguy run ids go on from the previous boot", "[persistence_queue][concurrent_shyguy]")
+{
+  if (not spdlog::get("shyguy_logger"))
+    spdlog::null_logger_mt("shyguy_logger");
+
+  temp_dir_guard tmp{"persistence_queue_run_ids_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  auto queue = std::make_shared<blocking_priority_queue<task_request_ptr, task_request_ptr_compare>>();
+  auto const run_id = [](command_result_type const &result) {
+    return nlohmann::json::parse(result.value())["run_id"].get<std::uint64_t>();
+  };
+
+  {
+    concurrent_shyguy fresh{queue, std::make_shared<std::atomic_bool>(true), storage};
+    REQUIRE(fresh.create(shyguy_dag{.name = "etl", .schedule = std::nullopt}).has_value());
+    REQUIRE(fresh.create(shyguy_task{.name = "extract", .associated_dag = "etl"}).has_value());
+    REQUIRE(run_id(fresh.execute(shyguy_dag{.name = "etl", .schedule = std::nullopt})) == 0);
+  }
+
+  // Run 4 was recorded; run 7 was cut off before any task finished and only left its logs.
+  auto const now = std::chrono::system_clock::now();
+  REQUIRE(storage->runs()
+              .append(run_record{.run_id = 4, .dag = "etl", .task = "extract", .status = dag_run_status::success,
+                                 .started = now, .finished = now})
+              .has_value());
+  fs::create_directories(tmp.path / "logs" / "runs" / "etl" / "7" / "extract");
+
+  concurrent_shyguy rebooted{queue, std::make_shared<std::atomic_bool>(true), storage};
+  REQUIRE(rebooted.create(shyguy_dag{.name = "etl", .schedule = std::nullopt}).has_value());
+  REQUIRE(rebooted.create(shyguy_task{.name = "extract", .associated_dag = "etl"}).has_value());
+  REQUIRE(run_id(rebooted.execute(shyguy_dag{.name = "etl", .schedule = std::nullopt})) == 8);
+}
+
+TEST_CASE("concurrent_shyguy catches up from the fire the last run stood for", "[persistence_queue][concurrent_shyguy][backfill]")
+{
+  if (not spdlog::get("shyguy_logger"))
+    spdlog::null_logger_mt("shyguy_logger");
+
+  temp_dir_guard tmp{"persistence_queue_catch_up_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  auto queue = std::make_shared<blocking_priority_queue<task_request_ptr, task_request_ptr_compare>>();
+
+  // The last run was the fire three hours ago, but it only started half an hour after the next fire.
+  auto const fired = std::chrono::floor<std::chrono::hours>(std::chrono::system_clock::now()) - std::chrono::hours{3};
+  auto const started = fired + std::chrono::minutes{90};
+  REQUIRE(storage->runs()
+              .append(run_record{.run_id = 0, .dag = "etl", .task = "extract", .status = dag_run_status::success,
+                                 .started = started, .finished = started, .logical_time = fired})
+              .has_value());
+
+  concurrent_shyguy rebooted{queue, std::make_shared<std::atomic_bool>(true), storage};
+  REQUIRE(rebooted.create(shyguy_dag{.name = "etl", .schedule = "0 * * * *"}).has_value());
+  REQUIRE(rebooted.create(shyguy_task{.name = "extract", .associated_dag = "etl"}).has_value());
+
+  // Every fire after it, including the one it started after.
+  REQUIRE(rebooted.catch_up(1) >= 3);
+  auto const view = rebooted.view_of("etl");
+  REQUIRE(view);
+  REQUIRE(view->runs.size() == 1);
+  REQUIRE(view->runs.front()->logical_time == fired + std::chrono::hours{1});
+}
+
+TEST_CASE("concurrent_shyguy removing a DAG takes its stored tasks along", "[persistence_queue][concurrent_shyguy][warm_start]")
+{
+  if (not spdlog::get("shyguy_logger"))
+    spdlog::null_logger_mt("shyguy_logger");
+
+  temp_dir_guard tmp{"persistence_queue_recreate_"};
+  auto storage = std::make_shared<fs_storage>(tmp.path);
+  auto queue = std::make_shared<blocking_priority_queue<task_request_ptr, task_request_ptr_compare>>();
+  {
+    concurrent_shyguy before{queue, std::make_shared<std::atomic_bool>(true), storage};
+    REQUIRE(before.create(shyguy_dag{.name = "etl", .schedule = std::nullopt}).has_value());
+    REQUIRE(before.create(shyguy_task{.name = "old", .associated_dag = "etl"}).has_value());
+    REQUIRE(before.flush().get());
+
+    // Removed and created again before the erase reached storage.
+    REQUIRE(before.remove(shyguy_dag{.name = "etl", .schedule = std::nullopt}).has_value());
+    REQUIRE(before.create(shyguy_dag{.name = "etl", .schedule = std::nullopt}).has_value());
+    REQUIRE(before.create(shyguy_task{.name = "new", .associated_dag = "etl"}).has_value());
+    REQUIRE(before.flush().get());
+  }
+
+  auto const stored = storage->tasks().list_tasks("etl");
+  REQUIRE(stored.has_value());
+  REQUIRE(stored->size() == 1);
+  REQUIRE(stored->front().value.name == "new");
+
+  concurrent_shyguy after{queue, std::make_shared<std::atomic_bool>(true), storage};
+  auto const report = after.warm_start(1);
+  REQUIRE(report.has_value());
+  REQUIRE(report->dags == 1);
+  REQUIRE(report->tasks == 1);
+  auto const view = after.view_of("etl");
+  REQUIRE(view);
+  REQUIRE(view->shape->tasks.size() == 1);
+  REQUIRE(view->shape->tasks.front()->name == "new");
+}
@@ -0,0 +1,52 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "release_policy.hpp"
+
+using namespace cosmos; // uses inline v1
+using namespace std::chrono_literals;
+
+TEST_CASE("release_policy gives every DAG a fixed offset within the spread", "[release_policy]")
+{
+  release_policy const spread{release_options{.spread = 60s}};
+  release_policy const again{release_options{.spread = 60s}};
+  std::set<std::chrono::milliseconds> offsets{};
+  for (int i = 0; i < 1000; ++i) {
+    auto const name = "dag-" + std::to_string(i);
+    auto const offset = spread.offset_of(name);
+    REQUIRE(offset >= 0ms);
+    REQUIRE(offset < 60s);
+    REQUIRE(again.offset_of(name) == offset); // same on every restart
+    offsets.insert(offset);
+  }
+  // A top-of-the-hour herd lands all over the window, not on a few instants.
+  REQUIRE(offsets.size() > 950);
+
+  auto const due = release_policy::clock_type::now();
+  REQUIRE(spread.spread("dag-1", due) == due + spread.offset_of("dag-1"));
+  REQUIRE(release_policy{}.offset_of("dag-1") == 0ms);
+}
+
+TEST_CASE("release_policy lets a burst through, then one start per interval", "[release_policy]")
+{
+  release_policy capped{release_options{.starts_per_second = 2.0, .burst = 2}};
+  auto const due = release_policy::clock_type::now();
+  std::vector<release_policy::clock_type::time_point> starts{};
+  for (int i = 0; i < 5; ++i)
+    starts.push_back(capped.release(due));
+  REQUIRE(starts == std::vector{due, due, due + 500ms, due + 1s, due + 1500ms});
+
+  // Once the herd has drained the bucket refills: a run due later starts on time again.
+  REQUIRE(capped.release(due + 10s) == due + 10s);
+  REQUIRE(capped.release(due + 10s) == due + 10s);
+  REQUIRE(capped.release(due + 10s) == due + 10500ms);
+
+  release_policy unlimited{};
+  REQUIRE(unlimited.release(due) == due);
+  REQUIRE(unlimited.release(due) == due);
+}
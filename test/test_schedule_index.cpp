@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "schedule_index.hpp"
+
+using namespace cosmos; // uses inline v1
+using namespace std::chrono_literals;
+
+namespace {
+
+// 2024-01-01 10:02, between fire times.
+auto const start = std::chrono::sys_days{std::chrono::year{2024} / 1 / 1} + 10h + 2min;
+
+auto names(std::vector<schedule_index::due_dag> const& batch) -> std::vector<std::string>
+{
+  std::vector<std::string> out;
+  for (auto const& entry : batch)
+    out.push_back(entry.name);
+  std::ranges::sort(out);
+  return out;
+}
+
+} // namespace
+
+TEST_CASE("schedule_index returns every DAG due at the earliest time as one batch", "[schedule_index]")
+{
+  schedule_index index{};
+  REQUIRE(index.upsert("every-five", "*/5 * * * *", start));
+  REQUIRE(index.upsert("at-five", "5 * * * *", start));
+  REQUIRE(index.upsert("hourly", "0 * * * *", start));
+  REQUIRE(index.size() == 3);
+
+  auto const batch = index.next_batch();
+  REQUIRE(names(batch) == std::vector<std::string>{"at-five", "every-five"});
+  REQUIRE(batch.front().time == batch.back().time);
+  REQUIRE(batch.front().time - start == 3min);
+  REQUIRE_FALSE(index.due(start));
+
+  // Once that minute passes only the fired DAGs move on.
+  auto const fired = batch.front().time;
+  REQUIRE(index.due(fired));
+  REQUIRE(index.advance(fired) == 2);
+  REQUIRE(names(index.next_batch()) == std::vector<std::string>{"every-five"});
+  REQUIRE(index.next_time_of("every-five") == fired + 5min);
+  REQUIRE(index.next_time_of("at-five") == fired + 1h);
+  REQUIRE(index.next_time_of("hourly") == fired + 55min);
+}
+
+TEST_CASE("schedule_index replaces, erases and rejects expressions", "[schedule_index]")
+{
+  schedule_index index{};
+  REQUIRE(index.upsert("dag", "0 * * * *", start));
+  REQUIRE(index.upsert("dag", "*/5 * * * *", start));
+  REQUIRE(index.size() == 1);
+  REQUIRE(index.next_time_of("dag") == start + 3min);
+
+  // A bad expression takes the DAG out rather than keeping its old schedule.
+  REQUIRE_FALSE(index.upsert("dag", "not a cron", start));
+  REQUIRE(index.empty());
+  REQUIRE_FALSE(index.next_time_of("dag").has_value());
+  REQUIRE(index.next_batch().empty());
+
+  REQUIRE(index.upsert("other", "0 * * * *", start));
+  REQUIRE(index.erase("other"));
+  REQUIRE_FALSE(index.erase("other"));
+  REQUIRE(index.empty());
+  REQUIRE(index.advance(start + 24h) == 0);
+}
+
+TEST_CASE("schedule_index hands each due fire out once with the time it was due at", "[schedule_index]")
+{
+  schedule_index index{};
+  REQUIRE(index.upsert("every-five", "*/5 * * * *", start));
+  REQUIRE(index.upsert("hourly", "0 * * * *", start));
+  REQUIRE(index.earliest() == start + 3min);
+  REQUIRE(index.take_due(start).empty());
+
+  // 10:05 and 10:10 passed for every-five, it fires once, for its earliest missed time.
+  auto const due = index.take_due(start + 9min);
+  REQUIRE(names(due) == std::vector<std::string>{"every-five"});
+  REQUIRE(due.front().time == start + 3min);
+  REQUIRE(index.earliest() == start + 13min);
+  REQUIRE(index.take_due(start + 9min).empty());
+}
+
+TEST_CASE("schedule_index fires on whole minutes when woken inside the fire minute", "[schedule_index]")
+{
+  schedule_index index{};
+  // Added at 10:02:17.250: the fire time does not carry those seconds.
+  REQUIRE(index.upsert("every-minute", "* * * * *", start + 17s + 250ms));
+  REQUIRE(index.earliest() == start + 1min);
+
+  // Woken a little after 10:03: it fires and moves on to 10:04 instead of being dropped.
+  auto const due = index.take_due(start + 1min + 3ms);
+  REQUIRE(names(due) == std::vector<std::string>{"every-minute"});
+  REQUIRE(due.front().time == start + 1min);
+  REQUIRE(index.earliest() == start + 2min);
+  REQUIRE(index.size() == 1);
+}
@@ -0,0 +1,236 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "interpreter_pool.hpp"
+#include "memory_file.hpp"
+#include "output_stream.hpp"
+#include "subprocess.hpp"
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using namespace cosmos; // uses inline v1
+
+TEST_CASE("run captures stdout and stderr separately", "[subprocess]")
+{
+  auto output = run({.arguments = {"/bin/sh", "-c", "echo out; echo err 1>&2"}});
+  REQUIRE(output.has_value());
+  REQUIRE(output->status.success());
+  REQUIRE(output->standard_output == "out\n");
+  REQUIRE(output->standard_error == "err\n");
+}
+
+TEST_CASE("run reports exit codes and signals precisely", "[subprocess]")
+{
+  auto exited = run({.arguments = {"/bin/sh", "-c", "exit 3"}});
+  REQUIRE(exited.has_value());
+  REQUIRE(exited->status.exited());
+  REQUIRE(exited->status.code == 3);
+
+  auto killed = run({.arguments = {"/bin/sh", "-c", "kill -TERM $$"}});
+  REQUIRE(killed.has_value());
+  REQUIRE_FALSE(killed->status.exited());
+  REQUIRE(killed->status.signal == SIGTERM);
+  REQUIRE(to_string(killed->status).find("SIGTERM") != std::string::npos);
+}
+
+TEST_CASE("run honours working directory and environment", "[subprocess]")
+{
+  auto const tmp = fs::temp_directory_path();
+  auto output = run({
+    .arguments = {"/bin/sh", "-c", "pwd; echo $SHYGUY_TEST_VALUE"},
+    .working_directory = tmp,
+    .environment = {{"SHYGUY_TEST_VALUE", "luigi"}},
+  });
+  REQUIRE(output.has_value());
+  REQUIRE(output->standard_output == fs::canonical(tmp).string() + "\nluigi\n");
+
+  auto clean = run({
+    .arguments = {"/usr/bin/env"},
+    .environment = {{"ONLY", "1"}},
+    .inherit_environment = false,
+  });
+  REQUIRE(clean.has_value());
+  REQUIRE(clean->standard_output == "ONLY=1\n");
+}
+
+TEST_CASE("spawn fails cleanly for a missing program", "[subprocess]")
+{
+  auto missing = run({.arguments = {"/definitely/not/here"}});
+  REQUIRE_FALSE(missing.has_value());
+  REQUIRE(missing.error() == spawn_error::spawn_failed);
+
+  auto empty = run({});
+  REQUIRE_FALSE(empty.has_value());
+  REQUIRE(empty.error() == spawn_error::no_arguments);
+}
+
+TEST_CASE("large output is not truncated", "[subprocess]")
+{
+  auto output = run({.arguments = {"/bin/sh", "-c", "head -c 1000000 /dev/zero"}});
+  REQUIRE(output.has_value());
+  REQUIRE(output->standard_output.size() == 1000000);
+}
+
+TEST_CASE("tail_buffer keeps only the most recent bytes", "[subprocess][stream]")
+{
+  tail_buffer tail{4};
+  tail.append(std::string_view{"ab"});
+  REQUIRE(tail.str() == "ab");
+  tail.append(std::string_view{"cdef"});
+  REQUIRE(tail.str() == "cdef");
+  tail.append(std::string_view{"gh"});
+  REQUIRE(tail.str() == "efgh");
+  REQUIRE(tail.bytes_seen() == 8);
+}
+
+TEST_CASE("run_streamed writes segmented logs and keeps a bounded tail", "[subprocess][stream]")
+{
+  auto const dir = fs::temp_directory_path() / ("shyguy_stream_" + std::to_string(::getpid()));
+  fs::remove_all(dir);
+
+  auto result = run_streamed(
+    {.arguments = {"/bin/sh", "-c", "head -c 3000000 /dev/zero; printf end; printf oops 1>&2"}},
+    {.directory = dir, .segment_bytes = 1000000, .tail_bytes = 16});
+  REQUIRE(result.has_value());
+  REQUIRE(result->status.success());
+  REQUIRE(result->stdout_bytes == 3000003);
+  REQUIRE(result->stdout_tail.size() == 16);
+  REQUIRE(result->stdout_tail.ends_with("end"));
+  REQUIRE(result->stderr_tail == "oops");
+
+  std::uintmax_t total = 0;
+  for (auto const* name : {"stdout.000.log", "stdout.001.log", "stdout.002.log", "stdout.003.log"})
+  {
+    REQUIRE(fs::exists(dir / name));
+    total += fs::file_size(dir / name);
+  }
+  REQUIRE(fs::file_size(dir / "stdout.000.log") == 1000000);
+  REQUIRE(total == 3000003);
+  REQUIRE(fs::file_size(dir / "stderr.000.log") == 4);
+
+  fs::remove_all(dir);
+}
+
+TEST_CASE("run_streamed without a directory only keeps the tail", "[subprocess][stream]")
+{
+  auto result = run_streamed({.arguments = {"/bin/sh", "-c", "seq 1 100000"}}, {.tail_bytes = 7});
+  REQUIRE(result.has_value());
+  REQUIRE(result->stdout_tail == "100000\n");
+  REQUIRE(result->stdout_bytes > 500000);
+}
+
+TEST_CASE("interpreter_pool runs python scripts on warm workers", "[subprocess][pool]")
+{
+  auto const dir = fs::temp_directory_path() / ("shyguy_pool_" + std::to_string(::getpid()));
+  fs::create_directories(dir);
+  auto write_script = [&](std::string const& name, std::string_view body)
+  {
+    auto const path = dir / name;
+    std::ofstream{path} << body;
+    return path;
+  };
+
+  auto const hello = write_script("hello.py", "import sys\nprint('hi', sys.argv[0].endswith('hello.py'))\n");
+  auto const failing = write_script("fail.py", "import sys\nsys.exit('boom')\n");
+  auto const parent = write_script("parent.py", "import os\nprint(os.getppid(), end='')\n");
+
+  interpreter_pool pool{{.workers = 1, .recycle_after = 2}};
+
+  auto ok = pool.run_script(hello, {});
+  REQUIRE(ok.has_value());
+  REQUIRE(ok->status.success());
+  REQUIRE(ok->stdout_tail == "hi True\n");
+
+  auto failed = pool.run_script(failing, {});
+  REQUIRE(failed.has_value());
+  REQUIRE(failed->status.code == 1);
+  REQUIRE(failed->stderr_tail == "boom\n");
+
+  // the worker served two scripts and was recycled, so the next two share a fresh interpreter
+  auto first = pool.run_script(parent, {});
+  auto second = pool.run_script(parent, {});
+  auto third = pool.run_script(parent, {});
+  REQUIRE(first.has_value());
+  REQUIRE(second.has_value());
+  REQUIRE(third.has_value());
+  REQUIRE(first->stdout_tail == second->stdout_tail);
+  REQUIRE(second->stdout_tail != third->stdout_tail);
+  REQUIRE(third->usage.max_rss_bytes > 0);
+  REQUIRE(third->usage.wall.count() > 0);
+  REQUIRE(pool.idle_workers() == 1);
+
+  fs::remove_all(dir);
+}
+
+TEST_CASE("run reports resource usage from wait4", "[subprocess][usage]")
+{
+  auto output = run({.arguments = {"/bin/sh", "-c", "i=0; while [ $i -lt 200000 ]; do i=$((i+1)); done"}});
+  REQUIRE(output.has_value());
+  REQUIRE(output->status.success());
+  REQUIRE(output->usage.wall.count() > 0);
+  REQUIRE(output->usage.user_cpu + output->usage.system_cpu > std::chrono::microseconds{0});
+  REQUIRE(output->usage.max_rss_bytes > 0);
+  REQUIRE(output->usage.wall >= output->usage.user_cpu);
+}
+
+TEST_CASE("spawn runs without a cgroup when the hierarchy is not writable, unless limits were asked for", "[subprocess][usage]")
+{
+  REQUIRE_FALSE(task_cgroup::create({.parent = "/proc"}).has_value());
+
+  auto output = run({.arguments = {"/bin/true"}, .cgroup = cgroup_options{.parent = "/proc"}});
+  REQUIRE(output.has_value());
+  REQUIRE(output->status.success());
+  REQUIRE_FALSE(output->usage.from_cgroup);
+
+  auto limited = run({.arguments = {"/bin/true"}, .cgroup = cgroup_options{.parent = "/proc", .memory_max_bytes = 1 << 20}});
+  REQUIRE_FALSE(limited.has_value());
+  REQUIRE(limited.error() == spawn_error::cgroup_failed);
+
+  auto const script = fs::temp_directory_path() / ("shyguy_limited_" + std::to_string(::getpid()) + ".py");
+  std::ofstream{script} << "print('unreachable')\n";
+  interpreter_pool pool{{.workers = 1}};
+  auto pooled = pool.run_script(script, {}, cgroup_options{.parent = "/proc", .cpu_max_cores = 0.5});
+  REQUIRE_FALSE(pooled.has_value());
+  REQUIRE(pooled.error() == spawn_error::cgroup_failed);
+  fs::remove(script);
+}
+
+TEST_CASE("memory_file scripts run from a sealed memfd", "[subprocess][memfd]")
+{
+  auto const text = std::string_view{"#!/bin/sh\necho \"in memory $1\"\n"};
+  auto script = memory_file::from_bytes("task", std::as_bytes(std::span{text.data(), text.size()}));
+  REQUIRE(script.has_value());
+  REQUIRE(script->size() == text.size());
+  REQUIRE(::write(script->fd(), "x", 1) < 0);
+
+  // executed directly (shebang) and through an interpreter
+  auto direct = run({.arguments = {memory_file::child_path(), "one"}, .inherited_fds = {script->inherit()}});
+  REQUIRE(direct.has_value());
+  REQUIRE(direct->standard_output == "in memory one\n");
+
+  auto interpreted = run({.arguments = {"/bin/sh", memory_file::child_path(), "two"}, .inherited_fds = {script->inherit()}});
+  REQUIRE(interpreted.has_value());
+  REQUIRE(interpreted->standard_output == "in memory two\n");
+
+  auto const source = fs::temp_directory_path() / ("shyguy_memfd_" + std::to_string(::getpid()) + ".py");
+  std::ofstream{source} << "print('from memfd')\n";
+  auto copied = memory_file::from_file("task.py", source);
+  REQUIRE(copied.has_value());
+  fs::remove(source);
+
+  interpreter_pool pool{{.workers = 1}};
+  auto pooled = pool.run_script(copied.value(), {});
+  REQUIRE(pooled.has_value());
+  REQUIRE(pooled->status.success());
+  REQUIRE(pooled->stdout_tail == "from memfd\n");
+
+  REQUIRE_FALSE(memory_file::from_file("missing", "/definitely/not/here").has_value());
+}
@@ -0,0 +1,111 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "small_function.hpp"
+#include "task_system/task_system.hpp"
+
+using namespace cosmos; // uses inline v1
+
+TEST_CASE("small_function stores small callables inline and big ones out of line", "[task_system][small_function]")
+{
+  auto counter = std::make_shared<int>(0);
+
+  small_function<int(int), 32> small{[counter](int x) { return *counter + x; }};
+  REQUIRE(small);
+  REQUIRE(small.is_inline());
+  REQUIRE(small(2) == 2);
+
+  std::array<char, 100> big_capture{};
+  big_capture[0] = 5;
+  small_function<int(int), 32> big{[big_capture](int x) { return big_capture[0] + x; }};
+  REQUIRE_FALSE(big.is_inline());
+  REQUIRE(big(1) == 6);
+
+  // Moving transfers the callable and leaves the source empty, for both storages.
+  auto moved_small = std::move(small);
+  auto moved_big = std::move(big);
+  REQUIRE_FALSE(small);
+  REQUIRE_FALSE(big);
+  REQUIRE(moved_small(3) == 3);
+  REQUIRE(moved_big(3) == 8);
+
+  REQUIRE(counter.use_count() == 2);
+  moved_small = nullptr;
+  REQUIRE(counter.use_count() == 1);
+}
+
+TEST_CASE("small_function accepts move-only callables", "[task_system][small_function]")
+{
+  auto owned = std::make_unique<std::string>("owned");
+  small_function<std::string()> f{[value = std::move(owned)] { return *value; }};
+  REQUIRE(f() == "owned");
+
+  small_function<std::string()> g{};
+  REQUIRE_FALSE(g);
+  g = std::move(f);
+  REQUIRE(g() == "owned");
+
+  small_function<void()> from_null_pointer{static_cast<void (*)()>(nullptr)};
+  REQUIRE_FALSE(from_null_pointer);
+}
+
+TEST_CASE("task_system runs every submitted job", "[task_system]")
+{
+  constexpr int jobs = 10'000;
+  std::atomic_int done{0};
+  {
+    jx::task_system system{48};
+    for (int i = 0; i < jobs; ++i)
+      system.async([&done, payload = std::make_unique<int>(1)] { done.fetch_add(*payload); });
+  }
+  // The destructor drains the queues before joining.
+  REQUIRE(done.load() == jobs);
+}
+
+TEST_CASE("task_system parked workers never miss a job", "[task_system]")
+{
+  // No spinning: every idle worker parks, so each submission has to wake one.
+  jx::task_system system{jx::task_system_options{.threads = 4, .spin_rounds = 0}};
+  std::atomic_int done{0};
+  for (int i = 1; i <= 2'000; ++i)
+  {
+    system.async([&done] { done.fetch_add(1); });
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (done.load() < i and std::chrono::steady_clock::now() < deadline)
+      std::this_thread::yield();
+    REQUIRE(done.load() == i);
+  }
+}
+
+TEST_CASE("cpu topology parsing and worker placement", "[task_system][affinity]")
+{
+  REQUIRE(jx::parse_cpu_list("0-3,8,10-11\n") == std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11});
+  REQUIRE(jx::parse_cpu_list("5") == std::vector<unsigned>{5});
+  REQUIRE(jx::parse_cpu_list("x-1").empty());
+
+  jx::cpu_topology const topology{.cpus = {0, 1, 2, 3}, .nodes = {{0, 1}, {2, 3}}};
+  REQUIRE(jx::worker_cpus(topology, jx::worker_affinity::cores, 5) == std::vector<unsigned>{1});
+  REQUIRE(jx::worker_cpus(topology, jx::worker_affinity::numa_nodes, 1) == std::vector<unsigned>{2, 3});
+  REQUIRE(jx::worker_cpus(topology, jx::worker_affinity::none, 1).empty());
+
+  auto const local = jx::read_cpu_topology();
+  REQUIRE_FALSE(local.cpus.empty());
+
+  // Pinning is best effort (cpusets may refuse it), but jobs must run either way.
+  std::atomic_int done{0};
+  {
+    jx::task_system system{jx::task_system_options{.threads = 2, .affinity = jx::worker_affinity::cores}};
+    REQUIRE(system.pinned_workers() <= system.worker_count());
+    for (int i = 0; i < 100; ++i)
+      system.async([&done] { done.fetch_add(1); });
+  }
+  REQUIRE(done.load() == 100);
+}
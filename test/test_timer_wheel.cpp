@@ -0,0 +1,164 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include "blocking_priority_queue.hpp"
+#include "concurrent_shyguy.hpp"
+#include "schedule_timer.hpp"
+#include "task_request.hpp"
+#include "timer_service.hpp"
+#include "timer_wheel.hpp"
+
+using namespace cosmos; // uses inline v1
+using namespace std::chrono_literals;
+
+TEST_CASE("timer_wheel expires every timer at its deadline, never early", "[timer_wheel]")
+{
+  timer_wheel<std::uint64_t> wheel{1'000};
+  std::mt19937_64 random{7};
+  std::vector<std::uint64_t> deadlines{};
+  std::vector<timer_handle> handles{};
+  for (int i = 0; i < 20'000; ++i) {
+    // Spread over every level, a few past the top level's reach.
+    auto const reach = std::uint64_t{1} << (random() % 40);
+    auto const deadline = 1'000 + random() % reach;
+    deadlines.push_back(deadline);
+    handles.push_back(wheel.insert(deadline, deadline));
+  }
+
+  // Every third one is cancelled, exactly once.
+  std::vector<std::uint64_t> expected{};
+  for (std::size_t i = 0; i < handles.size(); ++i) {
+    if (i % 3 == 0) {
+      REQUIRE(wheel.cancel(handles[i]) == deadlines[i]);
+      REQUIRE_FALSE(wheel.cancel(handles[i]).has_value());
+    } else {
+      expected.push_back(deadlines[i]);
+    }
+  }
+  std::ranges::sort(expected);
+  REQUIRE(wheel.size() == expected.size());
+
+  // Jumping from one next_deadline() to the next visits every deadline in order.
+  std::vector<std::uint64_t> fired{};
+  while (auto const next = wheel.next_deadline()) {
+    REQUIRE(*next >= wheel.now());
+    (void) wheel.advance(*next);
+    while (auto expired = wheel.pop_expired()) {
+      REQUIRE(expired->second <= wheel.now());
+      REQUIRE((fired.empty() or fired.back() <= expired->second));
+      fired.push_back(expired->second);
+    }
+    // Nothing pending was due yet.
+    if (auto const after = wheel.next_deadline())
+      REQUIRE(*after > wheel.now());
+  }
+  REQUIRE(fired == expected);
+  REQUIRE(wheel.empty());
+}
+
+TEST_CASE("timer_wheel advanced in one jump expires everything due", "[timer_wheel]")
+{
+  timer_wheel<int> wheel{};
+  auto const soon = wheel.insert(5, 1);
+  (void) wheel.insert(64 * 64 + 3, 2);
+  (void) wheel.insert(std::uint64_t{1} << 37, 3);
+  auto const stale = wheel.insert(0, 4); // already due
+
+  REQUIRE(wheel.has_expired());
+  REQUIRE(wheel.pop_expired()->first == stale);
+  REQUIRE_FALSE(wheel.contains(stale));
+
+  REQUIRE(wheel.advance(100'000) == 2);
+  REQUIRE(wheel.pop_expired()->second == 1);
+  REQUIRE(wheel.pop_expired()->second == 2);
+  REQUIRE_FALSE(wheel.contains(soon));
+  REQUIRE(wheel.next_deadline() > std::optional<std::uint64_t>{100'000});
+
+  REQUIRE(wheel.advance(std::uint64_t{1} << 37) == 1);
+  REQUIRE(wheel.pop_expired()->second == 3);
+  REQUIRE_FALSE(wheel.next_deadline().has_value());
+}
+
+TEST_CASE("timer_service runs callbacks in deadline order and drops cancelled ones", "[timer_service]")
+{
+  timer_service timers{};
+  std::mutex mutex{};
+  std::vector<int> order{};
+  std::promise<void> last{};
+  auto const record = [&](int id) {
+    std::lock_guard lock(mutex);
+    order.push_back(id);
+  };
+
+  auto const start = timer_service::clock_type::now();
+  (void) timers.schedule_at(start + 30ms, [&] { record(3); last.set_value(); });
+  (void) timers.schedule_at(start + 10ms, [&] { record(1); });
+  auto const cancelled = timers.schedule_at(start + 15ms, [&] { record(99); });
+  // Scheduled from a callback, earlier than what the thread sleeps towards.
+  (void) timers.schedule_at(start + 5ms, [&] { (void) timers.schedule_after(15ms, [&] { record(2); }); });
+  REQUIRE(timers.cancel(cancelled));
+  REQUIRE_FALSE(timers.cancel(cancelled));
+
+  REQUIRE(last.get_future().wait_for(5s) == std::future_status::ready);
+  REQUIRE(timer_service::clock_type::now() - start >= 30ms);
+  std::lock_guard lock(mutex);
+  REQUIRE(order == std::vector<int>{1, 2, 3});
+  REQUIRE(timers.fired() == 4);
+  REQUIRE(timers.pending() == 0);
+
+  timers.stop();
+  REQUIRE_FALSE(timers.schedule_after(1ms, [] {}).valid());
+}
+
+TEST_CASE("schedule_timer stays armed at the earliest cron fire time", "[timer_service][schedule_timer]")
+{
+  if (not spdlog::get("shyguy_logger"))
+    spdlog::null_logger_mt("shyguy_logger");
+  auto queue = std::make_shared<blocking_priority_queue<task_request_ptr, task_request_ptr_compare>>();
+  concurrent_shyguy shyguy{queue, std::make_shared<std::atomic_bool>(true), nullptr};
+  timer_service timers{};
+  schedule_timer cron{timers, shyguy};
+  REQUIRE_FALSE(cron.armed_for().has_value());
+
+  auto create = [&](std::string name, std::string schedule) {
+    shyguy_request request{};
+    request.command = command_enum::create;
+    request.emplace(shyguy_dag{.name = std::move(name), .schedule = std::move(schedule)});
+    return shyguy.process(request).has_value();
+  };
+  REQUIRE(create("yearly", "0 0 1 1 *"));
+  cron.rearm();
+  REQUIRE(cron.armed_for() == shyguy.next_fire_time());
+  REQUIRE(timers.pending() == 1);
+
+  REQUIRE(create("hourly", "0 * * * *"));
+  cron.rearm();
+  REQUIRE(cron.armed_for() == shyguy.next_fire_time());
+  REQUIRE(timers.pending() == 1);
+
+  // Nothing moved: the armed timer is kept as it is.
+  cron.rearm();
+  REQUIRE(timers.pending() == 1);
+
+  shyguy_request remove{};
+  remove.command = command_enum::remove;
+  remove.emplace(shyguy_dag{.name = "hourly"});
+  REQUIRE(shyguy.process(remove).has_value());
+  remove.emplace(shyguy_dag{.name = "yearly"});
+  REQUIRE(shyguy.process(remove).has_value());
+  cron.rearm();
+  REQUIRE_FALSE(cron.armed_for().has_value());
+  REQUIRE(timers.pending() == 0);
+}